@@ -388,6 +388,78 @@ bool Adafruit_BMP3XX::performReading(void) {
   return true;
 }
 
+/**************************************************************************/
+/*!
+    @brief Switches to normal mode: the sensor converts on its own at the
+   rate set by setOutputDataRate(), and readLatest() fetches each result.
+
+    With dataReadyInterrupt the INT pin pulses high (push-pull, not latched)
+   every time a new conversion is ready.
+
+    @param dataReadyInterrupt True to route data ready to the INT pin
+    @return True on success, False on failure
+*/
+/**************************************************************************/
+bool Adafruit_BMP3XX::startContinuous(bool dataReadyInterrupt) {
+  g_i2c_dev = i2c_dev;
+  g_spi_dev = spi_dev;
+  uint16_t settings_sel = BMP3_SEL_TEMP_EN | BMP3_SEL_PRESS_EN |
+                          BMP3_SEL_DRDY_EN | BMP3_SEL_OUTPUT_MODE |
+                          BMP3_SEL_LEVEL | BMP3_SEL_LATCH;
+
+  the_sensor.settings.temp_en = BMP3_ENABLE;
+  the_sensor.settings.press_en = BMP3_ENABLE;
+  if (_tempOSEnabled) {
+    settings_sel |= BMP3_SEL_TEMP_OS;
+  }
+  if (_presOSEnabled) {
+    settings_sel |= BMP3_SEL_PRESS_OS;
+  }
+  if (_filterEnabled) {
+    settings_sel |= BMP3_SEL_IIR_FILTER;
+  }
+  if (_ODREnabled) {
+    settings_sel |= BMP3_SEL_ODR;
+  }
+
+  the_sensor.settings.int_settings.drdy_en =
+      dataReadyInterrupt ? BMP3_ENABLE : BMP3_DISABLE;
+  the_sensor.settings.int_settings.output_mode = BMP3_INT_PIN_PUSH_PULL;
+  the_sensor.settings.int_settings.level = BMP3_INT_PIN_ACTIVE_HIGH;
+  the_sensor.settings.int_settings.latch = BMP3_INT_PIN_NON_LATCH;
+
+  if (bmp3_set_sensor_settings(settings_sel, &the_sensor) != BMP3_OK)
+    return false;
+
+  the_sensor.settings.op_mode = BMP3_MODE_NORMAL;
+  return bmp3_set_op_mode(&the_sensor) == BMP3_OK;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the most recent conversion after startContinuous(), one
+   burst read instead of the configure/convert/wait of performReading().
+
+    Assigns the internal Adafruit_BMP3XX#temperature & Adafruit_BMP3XX#pressure
+   member variables
+
+    @return True on success, False on failure
+*/
+/**************************************************************************/
+bool Adafruit_BMP3XX::readLatest(void) {
+  g_i2c_dev = i2c_dev;
+  g_spi_dev = spi_dev;
+  struct bmp3_data data;
+
+  if (bmp3_get_sensor_data(BMP3_PRESS | BMP3_TEMP, &data, &the_sensor) !=
+      BMP3_OK)
+    return false;
+
+  temperature = data.temperature;
+  pressure = data.pressure;
+  return true;
+}
+
 /**************************************************************************/
 /*!
     @brief  Setter for Temperature oversampling
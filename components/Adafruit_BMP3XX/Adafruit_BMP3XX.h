@@ -60,6 +60,10 @@ public:
 
   /// Perform a reading in blocking mode
   bool performReading(void);
+  /// Convert continuously at the output data rate, optionally pulsing INT
+  bool startContinuous(bool dataReadyInterrupt);
+  /// Read the latest continuous conversion without starting a new one
+  bool readLatest(void);
 
   /// Temperature (Celsius) assigned after calling performReading()
   double temperature;
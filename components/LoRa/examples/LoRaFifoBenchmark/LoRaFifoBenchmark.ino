@@ -0,0 +1,56 @@
+#include <SPI.h>
+#include <LoRa.h>
+
+// Times loading a full 255 byte packet into the radio FIFO, once a byte
+// at a time (one SPI transaction per byte, what write(buffer, length)
+// used to cost) and once with write(buffer, length), which now sends the
+// whole buffer in a single transaction. Nothing is transmitted.
+
+const int packetSize = 255;
+const int rounds = 100;
+
+uint8_t packet[packetSize];
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial);
+
+  Serial.println("LoRa FIFO Benchmark");
+
+  if (!LoRa.begin(915E6)) {
+    Serial.println("Starting LoRa failed!");
+    while (1);
+  }
+
+  for (int i = 0; i < packetSize; i++) {
+    packet[i] = i;
+  }
+}
+
+void loop() {
+  unsigned long perByte = 0;
+  unsigned long burst = 0;
+
+  for (int round = 0; round < rounds; round++) {
+    LoRa.beginPacket();
+    unsigned long start = micros();
+    for (int i = 0; i < packetSize; i++) {
+      LoRa.write(packet[i]);
+    }
+    perByte += micros() - start;
+
+    LoRa.beginPacket();
+    start = micros();
+    LoRa.write(packet, packetSize);
+    burst += micros() - start;
+  }
+  LoRa.idle();
+
+  Serial.print("per byte: ");
+  Serial.print(perByte / rounds);
+  Serial.print(" us, burst: ");
+  Serial.print(burst / rounds);
+  Serial.println(" us");
+
+  delay(5000);
+}
@@ -77,6 +77,8 @@ LoRaClass::LoRaClass() :
   _ss(LORA_DEFAULT_SS_PIN), _reset(LORA_DEFAULT_RESET_PIN), _dio0(LORA_DEFAULT_DIO0_PIN),
   _frequency(0),
   _packetIndex(0),
+  _packetLength(0),
+  _payloadLength(0),
   _implicitHeaderMode(0),
   _onReceive(NULL),
   _onCadDone(NULL),
@@ -181,14 +183,17 @@ int LoRaClass::beginPacket(int implicitHeader)
   // reset FIFO address and paload length
   writeRegister(REG_FIFO_ADDR_PTR, 0);
   writeRegister(REG_PAYLOAD_LENGTH, 0);
+  _payloadLength = 0;
 
   return 1;
 }
 
 int LoRaClass::endPacket(bool async)
 {
-  
-  if ((async) && (_onTxDone))
+  // the length write() has been keeping count of
+  writeRegister(REG_PAYLOAD_LENGTH, _payloadLength);
+
+  if (async)
       writeRegister(REG_DIO_MAPPING_1, 0x40); // DIO0 => TXDONE
 
   // put in TX mode
@@ -246,6 +251,7 @@ int LoRaClass::parsePacket(int size)
     } else {
       packetLength = readRegister(REG_RX_NB_BYTES);
     }
+    _packetLength = packetLength;
 
     // set FIFO address to current RX address
     writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
@@ -306,27 +312,21 @@ size_t LoRaClass::write(uint8_t byte)
 
 size_t LoRaClass::write(const uint8_t *buffer, size_t size)
 {
-  int currentLength = readRegister(REG_PAYLOAD_LENGTH);
-
   // check size
-  if ((currentLength + size) > MAX_PKT_LENGTH) {
-    size = MAX_PKT_LENGTH - currentLength;
-  }
-
-  // write data
-  for (size_t i = 0; i < size; i++) {
-    writeRegister(REG_FIFO, buffer[i]);
+  if ((_payloadLength + size) > MAX_PKT_LENGTH) {
+    size = MAX_PKT_LENGTH - _payloadLength;
   }
 
-  // update length
-  writeRegister(REG_PAYLOAD_LENGTH, currentLength + size);
+  // write data, endPacket() sets the length register
+  writeFifo(buffer, size);
+  _payloadLength += size;
 
   return size;
 }
 
 int LoRaClass::available()
 {
-  return (readRegister(REG_RX_NB_BYTES) - _packetIndex);
+  return (_packetLength - _packetIndex);
 }
 
 int LoRaClass::read()
@@ -340,6 +340,29 @@ int LoRaClass::read()
   return readRegister(REG_FIFO);
 }
 
+size_t LoRaClass::readBytes(char *buffer, size_t length)
+{
+  return readBytes((uint8_t*)buffer, length);
+}
+
+size_t LoRaClass::readBytes(uint8_t *buffer, size_t length)
+{
+  int remaining = available();
+
+  if (remaining <= 0) {
+    return 0;
+  }
+
+  if (length > (size_t)remaining) {
+    length = remaining;
+  }
+
+  readFifo(buffer, length);
+  _packetIndex += length;
+
+  return length;
+}
+
 int LoRaClass::peek()
 {
   if (!available()) {
@@ -753,6 +776,7 @@ void LoRaClass::handleDio0Rise()
 
       // read packet length
       int packetLength = _implicitHeaderMode ? readRegister(REG_PAYLOAD_LENGTH) : readRegister(REG_RX_NB_BYTES);
+      _packetLength = packetLength;
 
       // set FIFO address to current RX address
       writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
@@ -792,6 +816,43 @@ uint8_t LoRaClass::singleTransfer(uint8_t address, uint8_t value)
   return response;
 }
 
+void LoRaClass::writeFifo(const uint8_t *buffer, size_t size)
+{
+  if (size == 0) {
+    return;
+  }
+
+  // the FIFO address pointer advances on every byte, so the whole
+  // buffer goes in one transaction behind a single address byte
+  _spi->beginTransaction(_spiSettings);
+  digitalWrite(_ss, LOW);
+  _spi->transfer(REG_FIFO | 0x80);
+#if defined(ESP32)
+  _spi->writeBytes(buffer, size);
+#else
+  for (size_t i = 0; i < size; i++) {
+    _spi->transfer(buffer[i]);
+  }
+#endif
+  digitalWrite(_ss, HIGH);
+  _spi->endTransaction();
+}
+
+void LoRaClass::readFifo(uint8_t *buffer, size_t size)
+{
+  if (size == 0) {
+    return;
+  }
+
+  _spi->beginTransaction(_spiSettings);
+  digitalWrite(_ss, LOW);
+  _spi->transfer(REG_FIFO & 0x7f);
+  // what goes out while reading is ignored by the radio
+  _spi->transfer(buffer, size);
+  digitalWrite(_ss, HIGH);
+  _spi->endTransaction();
+}
+
 ISR_PREFIX void LoRaClass::onDio0Rise()
 {
   LoRa.handleDio0Rise();
@@ -39,6 +39,7 @@ public:
 
   int beginPacket(int implicitHeader = false);
   int endPacket(bool async = false);
+  bool isTransmitting();
 
   int parsePacket(int size = 0);
   int packetRssi();
@@ -54,6 +55,8 @@ public:
   // from Stream
   virtual int available();
   virtual int read();
+  virtual size_t readBytes(char *buffer, size_t length);
+  virtual size_t readBytes(uint8_t *buffer, size_t length);
   virtual int peek();
   virtual void flush();
 
@@ -103,7 +106,6 @@ private:
   void implicitHeaderMode();
 
   void handleDio0Rise();
-  bool isTransmitting();
 
   int getSpreadingFactor();
   long getSignalBandwidth();
@@ -114,6 +116,8 @@ private:
   uint8_t readRegister(uint8_t address);
   void writeRegister(uint8_t address, uint8_t value);
   uint8_t singleTransfer(uint8_t address, uint8_t value);
+  void writeFifo(const uint8_t *buffer, size_t size);
+  void readFifo(uint8_t *buffer, size_t size);
 
   static void onDio0Rise();
 
@@ -125,6 +129,8 @@ private:
   int _dio0;
   long _frequency;
   int _packetIndex;
+  int _packetLength;
+  int _payloadLength;
   int _implicitHeaderMode;
   void (*_onReceive)(int);
   void (*_onCadDone)(boolean);
@@ -1,14 +1,17 @@
 #ifndef SRAD_PHX_H
 #define SRAD_PHX_H
 
-#include <Arduino.h>
-#include <SD.h>
-#include <Adafruit_Sensor.h>
-#include <Adafruit_GPS.h>
-#include <Adafruit_ADXL375.h>
-#include <Adafruit_BNO055.h>
-#include <Adafruit_BMP3XX.h>
-#include <Adafruit_LSM6DSO32.h>
+#include "SRAD_PHX_HAL.h"
+#include "SRAD_PHX_Time.h"
+#include "SRAD_PHX_Apogee.h"
+#include "SRAD_PHX_Delta.h"
+#include "SRAD_PHX_Fusion.h"
+#include "SRAD_PHX_Histogram.h"
+#include "SRAD_PHX_Log.h"
+#include "SRAD_PHX_Profiler.h"
+#include "SRAD_PHX_Resume.h"
+#include "SRAD_PHX_Ring.h"
+#include "SRAD_PHX_Seqlock.h"
 
 struct TelemetryData { // Easy transfer can only work with basic data types 
                       //(int, float, etc.. but not vector3 stuff due to unpredictability)
@@ -21,10 +24,45 @@ struct TelemetryData { // Easy transfer can only work with basic data types
     float bno_ori_w, bno_ori_x, bno_ori_y, bno_ori_z;
     float lsm_temp, adxl_temp, bno_temp, bmp_temp;
     float bmp_press, bmp_alt;
+    float gps_lat, gps_lon, gps_speed, gps_angle, gps_alt;
+    uint8_t gps_fix, gps_sats;
+    float ekf_ori_w, ekf_ori_x, ekf_ori_y, ekf_ori_z;  // fused attitude, body to earth
+    float ekf_vel, ekf_alt;         // fused vertical velocity and altitude above the pad
+
+    // register counts behind the floats above, what LOG_FORMAT_RAW logs
+    int16_t raw_bno_ori[4], raw_bno_gyro[3], raw_bno_acc[3];
+    int16_t raw_adxl_acc[3];
+    int16_t raw_lsm_temp;
+    int8_t raw_bno_temp;
 
     uint8_t sensor_status[5];
+    uint64_t sample_time_us[5];     // read start of the latest sample, indexed like sensor_status
+};
+
+// index of each sensor in sensor_status and sample_time_us
+enum SENSORS {
+    SENSOR_LSM = 0,
+    SENSOR_BMP = 1,
+    SENSOR_ADXL = 2,
+    SENSOR_BNO = 3,
+    SENSOR_GPS = 4,
+    SENSOR_COUNT = 5,
+};
+
+// one timestamped copy of the flight data, as queued for the writers
+struct SampleRecord {
+    uint64_t time_us;
+    uint8_t state;
+    TelemetryData data;
 };
 
+#ifndef SRAD_PHX_RING_SIZE
+#define SRAD_PHX_RING_SIZE 256
+#endif
+#define FLIGHT_MAX_RINGS 2      // one per consumer task, e.g. SD and LoRa
+
+typedef SAMPLE_RING<SampleRecord, SRAD_PHX_RING_SIZE> FlightRing;
+
 enum STATES {
     PRE_NO_CAL = 0,
     PRE_CAL = 1,
@@ -33,57 +71,64 @@ enum STATES {
     POST_LANDED = 4,
 };
 
+// what writeSD() puts in the file, see README "Binary log"
+enum LOG_FORMATS {
+    LOG_FORMAT_CSV = 0,
+    LOG_FORMAT_BINARY = 1,
+    LOG_FORMAT_RAW = 2,         // binary, with register counts in place of converted floats
+};
+
 class FLIGHT {
     public:
         // three stack initial constructor
-        FLIGHT(int a1, int a2, int l1, int l2, String h, Adafruit_GPS& g, TelemetryData& o) 
+        FLIGHT(int a1, int a2, int l1, int l2, String h, GPS_DEVICE& g, TelemetryData& o) 
         : accel_liftoff_threshold(a1), accel_liftoff_time_threshold(a2), 
-        land_time_threshold(l1), land_altitude_threshold(l2), data_header(h), last_gps(&g), data(o) {
+        land_time_threshold(l1), land_altitude_threshold(l2), data_header(h), last_gps(&g), data(o), live(o) {
             STATE = STATES::PRE_NO_CAL;
-            runningTime_ms = 0;
-
-            // initialize arrays!
-            altReadings_ind = 0;
-            for(int i = 0; i < 10; i++) {
-                altReadings[i] = 0;
-            }
+            runningTime_us = 0;
+            deltaTime_us = 0;
         }
 
         // UART Constructor
-        FLIGHT(String h, Adafruit_GPS& g, TelemetryData& o) 
-        : data_header(h), last_gps(&g), data(o) {
+        FLIGHT(String h, GPS_DEVICE& g, TelemetryData& o) 
+        : data_header(h), last_gps(&g), data(o), live(o) {
             STATE = STATES::PRE_NO_CAL;
-            runningTime_ms = 0;
+            runningTime_us = 0;
+            deltaTime_us = 0;
         }
 
         // SPI Constructor
         FLIGHT(int a1, int a2, int l1, int l2, String h, TelemetryData& o) 
         : accel_liftoff_threshold(a1), accel_liftoff_time_threshold(a2), 
-        land_time_threshold(l1), land_altitude_threshold(l2), data_header(h), data(o) {
+        land_time_threshold(l1), land_altitude_threshold(l2), data_header(h), data(o), live(o) {
             STATE = STATES::PRE_NO_CAL;
-            runningTime_ms = 0;
+            runningTime_us = 0;
+            deltaTime_us = 0;
             last_gps = nullptr;
-
-            // initialize arrays!
-            altReadings_ind = 0;
-            for(int i = 0; i < 10; i++) {
-                altReadings[i] = 0;
-            }
         }
 
         // high level functions
         void calculateState();
-        uint8_t read_LSM(Adafruit_LSM6DSO32 &);
-        uint8_t read_BMP(Adafruit_BMP3XX &);
-        uint8_t read_ADXL(Adafruit_ADXL375 &);
-        uint8_t read_BNO(Adafruit_BNO055 &);
-        uint8_t read_GPS(Adafruit_GPS &);
+        uint8_t read_LSM(IMU_DEVICE &);
+        uint8_t read_BMP(BARO_DEVICE &);
+        uint8_t read_ADXL(ACCEL_DEVICE &);
+        uint8_t read_BNO(AHRS_DEVICE &);
+        uint8_t read_GPS(GPS_DEVICE &);
         void incrementTime();
-        void writeSD(bool, File &);
-        void writeSERIAL(bool, Stream &);  // Stream allows Teensy USB as well
+        void incrementTime(uint64_t);
+        void setLoopPeriod(uint32_t);
+        uint64_t getTime_us();
+        const HISTOGRAM& getLoopJitter();
+        void writeSD(bool, Print &);        // SD File, or any other Print
+        void writeSD(const SampleRecord &, Print &);
+        void setLogFormat(LOG_FORMATS);
+        LOG_FORMATS getLogFormat();
+        void setLogKeyframes(uint16_t);     // binary formats: delta code samples between keyframes, 0 = off
+        void writeSERIAL(bool, Print &);    // Print allows Teensy USB as well
+        void writeSERIAL(const SampleRecord &, Print &);
         void writeDataToTeensy(); //no stream parameter needed for EasyTransfer
         void readDataFromTeensy(); //no stream parameter needed for EasyTransfer
-        void writeDEBUG(bool, Stream &);
+        void writeDEBUG(bool, Print &);
 
 
         // helper functions
@@ -93,37 +138,78 @@ class FLIGHT {
         bool isLanded();
         bool calibrate();
 
+        TelemetryData getSnapshot();
+        STATES getState();
+        void setState(STATES);
+        void replaySample(uint64_t, const TelemetryData &);
+        bool resume();                      // at boot, before the tasks start: carry on after a warm reset
+        void setResumeInterval(uint32_t);
+        bool attachRing(FlightRing &);
+        uint8_t pushSample();
+
         void initTransferSerial(Stream &);
         void AltitudeCalibrate();
-        void printRate();
+        void printProfile(Print &, bool binary = false);
+        PROFILER& getProfiler();
+        APOGEE& getApogee();
+        FUSION& getFusion();
+        LOG_DELTA& getLogDelta();
 
     private:
+        SampleRecord makeSample(uint64_t);
+        void setStatus(SENSORS, uint8_t);
+        void updateFusion();
+        void saveResume();
+
         int accel_liftoff_threshold;        // METERS PER SECOND^2
         int accel_liftoff_time_threshold;   // MILLISECONDS
         int land_time_threshold;            // MILLISECONDS
         int land_altitude_threshold;        // METERS
 
         String data_header;
-        Adafruit_GPS* last_gps;             // used for data collection, for some reason the GPS stores it
-        uint16_t deltaTime_ms;
-        uint64_t runningTime_ms;
+        LOG_FORMATS logFormat = LOG_FORMAT_BINARY;
+        uint8_t lastGpsRecord[LOG_GPS_SIZE];    // last 'G' record written, repeated ones are skipped
+        bool gpsRecordWritten = false;
+        LOG_DELTA logDelta;                 // codes 'S'/'R' records once setLogKeyframes() enables it
+        GPS_DEVICE* last_gps;               // set when a GPS is present, adds the GPS columns to every output
+        GpsReading lastGpsReading = {};     // only touched by read_GPS()
+        uint32_t deltaTime_us;
+        uint64_t runningTime_us;
+        uint32_t loopPeriod_us = 0;         // nominal loop period, 0 = measure cycle-to-cycle jitter
+        HISTOGRAM loopJitter;               // microseconds of loop timing error
+        PROFILER profiler;                  // cycles spent in each read/state/write stage
 
         // data processing variables
-        float alt_offset;                   // DO NOT MODIFY
+        float alt_offset = 0;               // DO NOT MODIFY
         float prev_alt, v_vel, offset_alt_fixed_temp;
         bool offset_calibrated;             // flag to tell us if we've configured this
 
-        float altReadings[10];
-        uint8_t altReadings_ind;
+        uint32_t liftoffTimer_us = 0;       // time spent above the liftoff acceleration
+        uint64_t liftoff_us = 0;            // flight time isAscent() fired
+        APOGEE apogee;                      // fed every new BMP sample after liftoff
+        uint64_t lastBaroSample_us = 0;     // sample_time_us of the last BMP sample fed to `apogee`
+        FUSION fusion;                      // attitude/velocity/altitude estimate, see updateFusion()
+        uint64_t lastImuSample_us = 0;      // last LSM or ADXL sample fed to `fusion`
+        uint64_t lastFusedBaro_us = 0;      // last BMP sample fed to `fusion`
 
 
         bool calibrated = false;
         STATES STATE;
 
+        uint32_t resumeInterval_us = 20000; // longest a warm restart can set flight time back
+        uint64_t lastResumeSave_us = 0;
+        STATES resumeSavedState = STATES::PRE_NO_CAL;
+        uint64_t resumeSavedBaro_us = 0;    // lastBaroSample_us of the last save
+        bool resumedInFlight = false;       // FUSION restarted mid-flight, its velocity can't judge apogee
+
+        FlightRing* rings[FLIGHT_MAX_RINGS] = {};
+        uint8_t ring_count = 0;
+
         // EasyTransfer ET;
         TelemetryData* txData;
         TelemetryData* rxData;
-        TelemetryData data;
+        TelemetryData data;                 // state machine's copy, refreshed by calculateState()
+        SEQLOCK<TelemetryData> live;        // written by read_*, read through getSnapshot()
 };
 
 #endif
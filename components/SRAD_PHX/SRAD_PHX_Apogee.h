@@ -0,0 +1,155 @@
+#ifndef SRAD_PHX_APOGEE_H
+#define SRAD_PHX_APOGEE_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define APOGEE_MAX_WINDOW 64
+
+/**
+ * @brief least-squares altitude trend over a sliding window of samples
+ *
+ * `update()` is O(1): altitudes are kept in centimeters and the sums for
+ * the slope are exact integers, updated by adding the new sample and
+ * removing the oldest, so nothing drifts however long it runs. The fit
+ * is per sample and scaled by the window's mean sample period, so the
+ * samples should be roughly evenly spaced. Apogee is
+ * declared once the fitted vertical velocity stays below `-descentRate`
+ * for `confirm` consecutive samples. Never prints, never allocates.
+ */
+class APOGEE {
+    public:
+        APOGEE(uint8_t window = 10, float descentRate = 1.0f, uint8_t confirm = 3) {
+            configure(window, descentRate, confirm);
+        }
+
+        /**
+         * @brief sets the detector up and clears it
+         * @param window Samples in the fit, 3 to APOGEE_MAX_WINDOW
+         * @param descentRate Fitted descent speed that counts as falling, m/s
+         * @param confirm Consecutive falling fits needed
+         */
+        void configure(uint8_t window, float descentRate, uint8_t confirm) {
+            window_len = window < 3 ? 3 : (window > APOGEE_MAX_WINDOW ? APOGEE_MAX_WINDOW : window);
+            descent_rate = descentRate;
+            confirm_len = confirm ? confirm : 1;
+            reset();
+        }
+
+        void reset() {
+            head = 0;
+            count = 0;
+            sumY = 0;
+            sumXY = 0;
+            fitVelocity = 0;
+            falling = 0;
+            found = false;
+            found_us = 0;
+            peak_cm = INT32_MIN;
+            peak_us = 0;
+        }
+
+        /**
+         * @brief adds one altitude sample
+         * @param time_us Sample timestamp, strictly increasing
+         * @param altitude Meters, any fixed reference
+         * @return Returns `true` once apogee has been detected, and from then on
+         */
+        bool update(uint64_t time_us, float altitude) {
+            push(time_us, altitude);
+            if(count == window_len) {
+                fit();
+                confirmFalling(time_us);
+            }
+            return found;
+        }
+
+        /**
+         * @brief adds one altitude sample judged on an estimated velocity
+         * @param time_us Sample timestamp, strictly increasing
+         * @param altitude Meters, any fixed reference
+         * @param estimatedVelocity Vertical velocity from elsewhere (e.g. `FUSION`), m/s
+         * @return Returns `true` once apogee has been detected, and from then on
+         *
+         * The window keeps filling, so the fit can take over again mid-flight.
+         */
+        bool update(uint64_t time_us, float altitude, float estimatedVelocity) {
+            push(time_us, altitude);
+            fitVelocity = estimatedVelocity;
+            confirmFalling(time_us);
+            return found;
+        }
+
+        bool detected() const { return found; }
+        uint64_t detectedTime_us() const { return found_us; }
+        float velocity() const { return fitVelocity; }      // m/s, last fitted or estimated velocity
+        uint8_t window() const { return window_len; }
+        float peakAltitude() const { return peak_cm / 100.0f; }
+        uint64_t peakTime_us() const { return peak_us; }
+
+    private:
+        void push(uint64_t time_us, float altitude) {
+            int32_t y = lroundf(altitude * 100.0f);
+            if(y > peak_cm) {
+                peak_cm = y;
+                peak_us = time_us;
+            }
+
+            if(count < window_len) {
+                // window filling: the new sample gets index `count`
+                uint8_t slot = head + count < window_len ? head + count : head + count - window_len;
+                alt_cm[slot] = y;
+                times_us[slot] = time_us;
+                sumY += y;
+                sumXY += int64_t(count) * y;
+                count++;
+            } else {
+                // drop index 0, shift every index down by one, append at n - 1
+                int32_t oldest = alt_cm[head];
+                sumXY += -(sumY - oldest) + int64_t(window_len - 1) * y;
+                sumY += y - oldest;
+                alt_cm[head] = y;
+                times_us[head] = time_us;
+                head = head + 1 < window_len ? head + 1 : 0;
+            }
+        }
+
+        void confirmFalling(uint64_t time_us) {
+            if(!found) {
+                falling = fitVelocity < -descent_rate ? falling + 1 : 0;
+                if(falling >= confirm_len) {
+                    found = true;
+                    found_us = time_us;
+                }
+            }
+        }
+
+        // slope = (n*Sxy - Sx*Sy) / (n*Sxx - Sx^2) with x = 0..n-1, in cm per sample
+        void fit() {
+            int64_t n = window_len;
+            int64_t sumX = n * (n - 1) / 2;
+            int64_t denominator = n * n * (n * n - 1) / 12;
+            float slope_cm = float(n * sumXY - sumX * sumY) / float(denominator);
+
+            uint8_t newest = head == 0 ? window_len - 1 : head - 1;
+            uint64_t span_us = times_us[newest] - times_us[head];
+            fitVelocity = span_us ? slope_cm * 0.01f * float(n - 1) * 1e6f / float(span_us) : 0.0f;
+        }
+
+        int32_t alt_cm[APOGEE_MAX_WINDOW];
+        uint64_t times_us[APOGEE_MAX_WINDOW];
+        uint8_t window_len, confirm_len;
+        float descent_rate;
+
+        uint8_t head;                       // slot of the oldest sample
+        uint8_t count;
+        int64_t sumY, sumXY;                // over the window, x = 0 at the oldest sample
+        float fitVelocity;
+        uint8_t falling;
+        bool found;
+        uint64_t found_us;
+        int32_t peak_cm;
+        uint64_t peak_us;
+};
+
+#endif
@@ -0,0 +1,465 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SRAD_PHX_BlackBox.h"
+#include "SRAD_PHX_Time.h"
+
+#define BLACKBOX_USABLE_PERCENT 75      // rest of the partition is slack for metadata and copy-on-write
+
+static void segmentName(uint32_t sequence, char* name) {
+    snprintf(name, 16, "%08lu.bb", (unsigned long)sequence);
+}
+
+/**
+ * @brief sets the logging policy, nothing touches flash until `begin()`
+ * @param keepEvery Log every `keepEvery`-th sample (1 logs them all)
+ * @param bytesPerSecond Write budget for record bytes
+ * @param syncInterval_ms Longest stretch of sample time between file syncs
+ * @param segments Files in the ring, 2 to 64
+ */
+BLACK_BOX::BLACK_BOX(uint16_t keepEvery, uint32_t bytesPerSecond, uint32_t syncInterval_ms, uint8_t segments)
+: divider(keepEvery ? keepEvery : 1), maxBytesPerSecond(bytesPerSecond), syncInterval_us(syncInterval_ms * 1000),
+  segmentCount(segments < 2 ? 2 : (segments > 64 ? 64 : segments)) {
+    resetStats();
+}
+
+/**
+ * @brief mounts the black box, formatting blank or corrupt flash, and opens a new segment
+ * @param flash Partition to log to
+ * @param csvHeader Header line `writeSD` prints, kept in every segment for the decoder
+ * @param gpsColumns Whether the flight logs GPS columns, as `FLIGHT::writeSD` decides it
+ * @return Returns `false` if the flash is too large or LittleFS failed
+ *
+ * Call on the pad. Earlier flights keep at most half the ring, the oldest
+ * segments go, and every free block is erased ahead of the flight. Only a
+ * flight longer than the other half deletes segments, and erases, in the air.
+ */
+bool BLACK_BOX::begin(FLASH_DEVICE& flash, const char* csvHeader, bool gpsColumns) {
+    end();
+    if(!mount(flash, true)) {
+        return false;
+    }
+    headerLength = logPackHeader(csvHeader, header);
+    gps = gpsColumns;
+    segmentLimit = uint32_t(uint64_t(config.block_count) * config.block_size * BLACKBOX_USABLE_PERCENT / 100 / segmentCount);
+
+    uint32_t oldest, newest, count;
+    if(!listSegments(oldest, newest, count)) {
+        end();
+        return false;
+    }
+    while(count > segmentCount / 2u) {
+        char name[16];
+        segmentName(oldest, name);
+        if(lfs_remove(&lfs, name) < 0 || !listSegments(oldest, newest, count)) {
+            stats.errors++;
+            end();
+            return false;
+        }
+    }
+    preErase();
+
+    sinceLogged = 0;
+    lastState = 0xFF;
+    lastSample_us = 0;
+    budget = uint64_t(maxBytesPerSecond) * 1000000;
+    if(!openSegment(newest + 1)) {
+        end();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief syncs and closes the open segment and unmounts
+ * @return Returns `false` if the last sync failed
+ */
+bool BLACK_BOX::end() {
+    bool ok = true;
+    if(opened) {
+        ok = lfs_file_close(&lfs, &file) >= 0;
+        stats.errors += !ok;
+        opened = false;
+    }
+    if(mounted) {
+        lfs_unmount(&lfs);
+        mounted = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief logs the sample if it is due and the byte budget allows
+ * @param sample Record popped from a `FlightRing`, in time order
+ *
+ * A kept sample goes out as `writeSD` would pack it: a 'G' record first
+ * if the GPS fields changed since the last logged one, then the 'S'
+ * record. Most calls only count; a logged sample is a copy into the
+ * LittleFS cache, plus a flash program each time 512 bytes fill.
+ */
+void BLACK_BOX::log(const SampleRecord& sample) {
+    uint32_t start = nowCycles();
+    stats.samplesSeen++;
+    if(!opened) {
+        return;
+    }
+
+    if(lastSample_us && sample.time_us > lastSample_us) {
+        uint64_t full = uint64_t(maxBytesPerSecond) * 1000000;
+        budget += (sample.time_us - lastSample_us) * maxBytesPerSecond;
+        budget = budget < full ? budget : full;
+    }
+    lastSample_us = sample.time_us;
+
+    bool wrote = false;
+    sinceLogged++;
+    if(sinceLogged >= divider || sample.state != lastState) {
+        uint8_t buffer[LOG_GPS_SIZE + LOG_SAMPLE_SIZE];
+        uint32_t length = 0;
+        if(gps) {
+            logPackGps(sample.data, buffer);
+            if(!gpsWritten || memcmp(buffer, lastGps, LOG_GPS_SIZE)) {
+                length = LOG_GPS_SIZE;
+            }
+        }
+        logPackSample(sample, gps, buffer + length);
+        length += LOG_SAMPLE_SIZE;
+
+        // over budget: the sample stays due and the next one tries again
+        if(budget < uint64_t(length) * 1000000) {
+            stats.samplesThrottled++;
+        } else {
+            budget -= uint64_t(length) * 1000000;
+            if(length > LOG_SAMPLE_SIZE) {
+                memcpy(lastGps, buffer, LOG_GPS_SIZE);
+                gpsWritten = true;
+            }
+            wrote = true;
+            if(append(buffer, length)) {
+                stats.samplesLogged++;
+                stats.bytesLogged += length;
+            }
+            sinceLogged = 0;
+            lastState = sample.state;
+        }
+    }
+    if(unsynced && sample.time_us - lastSync_us >= syncInterval_us) {
+        sync();
+        lastSync_us = sample.time_us;
+        wrote = true;
+    }
+
+    uint32_t cycles = nowCycles() - start;
+    stats.logCycles += cycles;
+    if(wrote) {
+        logLatency.record(cycles / cyclesPerMicro());
+    }
+}
+
+/**
+ * @brief copies every segment, oldest first, as one binary log
+ * @param flash Partition to read, e.g. a `SIM_FLASH` over a flash dump
+ * @param out Destination for the log; `log_decode` reads it
+ * @return Returns segments copied; ones written under a different header are skipped
+ *
+ * Mounts read only in effect: nothing is written, blank flash is not formatted.
+ */
+uint32_t BLACK_BOX::extract(FLASH_DEVICE& flash, Print& out) {
+    end();
+    uint32_t oldest, newest, count;
+    if(!mount(flash, false) || !listSegments(oldest, newest, count)) {
+        end();
+        return 0;
+    }
+
+    uint32_t copied = 0;
+    uint8_t first[LOG_HEADER_MAX_SIZE];
+    size_t firstLength = 0;
+    for(uint32_t segment = oldest; count && segment <= newest; segment++) {
+        char name[16];
+        segmentName(segment, name);
+        memset(&fileConfig, 0, sizeof(fileConfig));
+        fileConfig.buffer = fileBuffer;
+        if(lfs_file_opencfg(&lfs, &file, name, LFS_O_RDONLY, &fileConfig) < 0) {
+            continue;                   // numbering gap, or not ours
+        }
+        lfs_ssize_t got = lfs_file_read(&lfs, &file, header, LOG_HEADER_MAX_SIZE);
+        size_t length = got > 0 ? logHeaderSize(header, size_t(got)) : 0;
+        if(length && !firstLength) {
+            memcpy(first, header, length);
+            firstLength = length;
+            out.write(first, firstLength);
+        }
+        if(length && length == firstLength && !memcmp(first, header, length)) {
+            out.write(header + length, size_t(got) - length);
+            while((got = lfs_file_read(&lfs, &file, scratch, sizeof(scratch))) > 0) {
+                out.write(scratch, size_t(got));
+            }
+            copied++;
+        }
+        lfs_file_close(&lfs, &file);
+    }
+    end();
+    return copied;
+}
+
+void BLACK_BOX::resetStats() {
+    stats = {};
+    logLatency.reset();
+}
+
+/**
+ * @brief prints what was kept and what the flash was asked to do
+ * @param output Print to write to
+ */
+void BLACK_BOX::printStats(Print& output) {
+    output.print("black box: "); output.print(stats.samplesLogged);
+    output.print(" of "); output.print(stats.samplesSeen);
+    output.print(" samples, "); output.print(stats.samplesThrottled);
+    output.print(" throttled, "); output.print(stats.bytesLogged);
+    output.print(" B, "); output.print(stats.syncs);
+    output.print(" syncs, "); output.print(stats.segments);
+    output.print(" segments of "); output.print(segmentLimit); output.println(" B");
+    output.print("black box: erases "); output.print(stats.erases);
+    output.print(" ("); output.print(stats.erasesSkipped);
+    output.print(" already blank), "); output.print(stats.blocksPreErased);
+    output.print(" pre-erased, errors "); output.print(stats.errors);
+    output.print(", log() mean/p99/max "); output.print(logLatency.mean(), 1);
+    output.print("/"); output.print(logLatency.percentile(99));
+    output.print("/"); output.print(logLatency.max()); output.println(" us");
+}
+
+bool BLACK_BOX::mount(FLASH_DEVICE& flash, bool format) {
+    device = &flash;
+    uint32_t blocks = flash.size() / flash.blockSize();
+    if(blocks < 8 || blocks > BLACKBOX_MAX_BLOCKS) {
+        return false;
+    }
+    memset(&config, 0, sizeof(config));
+    config.context = this;
+    config.read = blockRead;
+    config.prog = blockProgram;
+    config.erase = blockErase;
+    config.sync = blockSync;
+    config.read_size = BLACKBOX_PROG_SIZE;
+    config.prog_size = BLACKBOX_PROG_SIZE;
+    config.block_size = flash.blockSize();
+    config.block_count = blocks;
+    config.block_cycles = BLACKBOX_BLOCK_CYCLES;
+    config.cache_size = BLACKBOX_CACHE_SIZE;
+    config.lookahead_size = sizeof(lookahead);
+    config.read_buffer = readBuffer;
+    config.prog_buffer = programBuffer;
+    config.lookahead_buffer = lookahead;
+    config.name_max = BLACKBOX_NAME_MAX;
+
+    int result = lfs_mount(&lfs, &config);
+    if(result < 0 && format) {
+        result = lfs_format(&lfs, &config);
+        result = result < 0 ? result : lfs_mount(&lfs, &config);
+    }
+    mounted = result >= 0;
+    return mounted;
+}
+
+// segment files are the only ones looked at, anything else on the partition is left alone
+bool BLACK_BOX::listSegments(uint32_t& oldest, uint32_t& newest, uint32_t& count) {
+    oldest = UINT32_MAX;
+    newest = 0;
+    count = 0;
+    lfs_dir_t dir;
+    if(lfs_dir_open(&lfs, &dir, "/") < 0) {
+        stats.errors++;
+        return false;
+    }
+    struct lfs_info info;
+    while(lfs_dir_read(&lfs, &dir, &info) > 0) {
+        char* end;
+        unsigned long number = strtoul(info.name, &end, 10);
+        if(info.type != LFS_TYPE_REG || end != info.name + 8 || strcmp(end, ".bb")) {
+            continue;
+        }
+        oldest = number < oldest ? number : oldest;
+        newest = number > newest ? number : newest;
+        count++;
+    }
+    lfs_dir_close(&lfs, &dir);
+    return true;
+}
+
+// creates the segment and syncs its header, so it exists even if power is lost right after
+bool BLACK_BOX::openSegment(uint32_t number) {
+    char name[16];
+    segmentName(number, name);
+    memset(&fileConfig, 0, sizeof(fileConfig));
+    fileConfig.buffer = fileBuffer;
+    if(lfs_file_opencfg(&lfs, &file, name, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC, &fileConfig) < 0) {
+        stats.errors++;
+        return false;
+    }
+    opened = true;
+    sequence = number;
+    segmentLength = 0;
+    gpsWritten = false;
+    stats.segments++;
+    if(lfs_file_write(&lfs, &file, header, headerLength) != lfs_ssize_t(headerLength) || lfs_file_sync(&lfs, &file) < 0) {
+        stats.errors++;
+        lfs_file_close(&lfs, &file);
+        opened = false;
+        return false;
+    }
+    segmentLength = headerLength;
+    unsynced = false;
+    return true;
+}
+
+// closes the full segment and opens the next, deleting the oldest to keep the ring at
+// `segmentCount`, or regardless when LittleFS ran out of space; the freed blocks were
+// written, so reusing them costs real erases in flight
+bool BLACK_BOX::rotate(bool dropOldest) {
+    if(lfs_file_close(&lfs, &file) < 0) {
+        stats.errors++;
+    }
+    opened = false;
+    uint32_t oldest, newest, count;
+    if(!listSegments(oldest, newest, count)) {
+        return false;
+    }
+    while(count && (count >= segmentCount || dropOldest) && oldest != sequence) {
+        char name[16];
+        segmentName(oldest, name);
+        if(lfs_remove(&lfs, name) < 0 || !listSegments(oldest, newest, count)) {
+            stats.errors++;
+            return false;
+        }
+        dropOldest = false;
+    }
+    return openSegment(sequence + 1);
+}
+
+// erases every block LittleFS isn't holding, so the flight's allocations find them blank
+void BLACK_BOX::preErase() {
+    memset(used, 0, sizeof(used));
+    lfs_fs_traverse(&lfs, [](void* data, lfs_block_t block) -> int {
+        uint8_t* map = (uint8_t*)data;
+        map[block / 8] |= 1 << (block % 8);
+        return 0;
+    }, used);
+    for(uint32_t block = 0; block < config.block_count; block++) {
+        uint32_t offset = block * config.block_size;
+        if(used[block / 8] & (1 << (block % 8)) || blank(offset)) {
+            continue;
+        }
+        if(device->erase(offset, config.block_size)) {
+            stats.blocksPreErased++;
+        } else {
+            stats.errors++;
+        }
+    }
+}
+
+// commits the file: its cached tail and a metadata entry with the new size
+void BLACK_BOX::sync() {
+    if(lfs_file_sync(&lfs, &file) < 0) {
+        stats.errors++;
+    }
+    stats.syncs++;
+    unsynced = false;
+}
+
+bool BLACK_BOX::append(const uint8_t* buffer, uint32_t size) {
+    if(segmentLength + size > segmentLimit && !rotate(false)) {
+        return false;
+    }
+    lfs_ssize_t result = lfs_file_write(&lfs, &file, buffer, size);
+    if(result == LFS_ERR_NOSPC && rotate(true)) {
+        result = lfs_file_write(&lfs, &file, buffer, size);
+    }
+    if(result != lfs_ssize_t(size)) {
+        stats.errors++;
+        return false;
+    }
+    segmentLength += size;
+    unsynced = true;
+    return true;
+}
+
+bool BLACK_BOX::blank(uint32_t offset) {
+    for(uint32_t at = 0; at < config.block_size; at += sizeof(scratch)) {
+        if(!device->read(offset + at, scratch, sizeof(scratch))) {
+            return false;
+        }
+        for(uint32_t ind = 0; ind < sizeof(scratch); ind++) {
+            if(scratch[ind] != 0xFF) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int BLACK_BOX::blockRead(const struct lfs_config* c, lfs_block_t block, lfs_off_t offset, void* buffer, lfs_size_t size) {
+    BLACK_BOX* box = (BLACK_BOX*)c->context;
+    return box->device->read(block * c->block_size + offset, buffer, size) ? 0 : LFS_ERR_IO;
+}
+
+int BLACK_BOX::blockProgram(const struct lfs_config* c, lfs_block_t block, lfs_off_t offset, const void* buffer, lfs_size_t size) {
+    BLACK_BOX* box = (BLACK_BOX*)c->context;
+    return box->device->program(block * c->block_size + offset, buffer, size) ? 0 : LFS_ERR_IO;
+}
+
+// LittleFS erases every block before reusing it; for one begin() pre-erased that is a read, not a stall
+int BLACK_BOX::blockErase(const struct lfs_config* c, lfs_block_t block) {
+    BLACK_BOX* box = (BLACK_BOX*)c->context;
+    uint32_t offset = block * c->block_size;
+    box->stats.erases++;
+    if(box->blank(offset)) {
+        box->stats.erasesSkipped++;
+        return 0;
+    }
+    return box->device->erase(offset, c->block_size) ? 0 : LFS_ERR_IO;
+}
+
+int BLACK_BOX::blockSync(const struct lfs_config*) {
+    return 0;
+}
+
+#if defined(ESP_PLATFORM)
+/**
+ * @brief finds the partition
+ * @param label Name in partitions.csv
+ * @return Returns `false` if there is no data partition by that name
+ */
+bool PARTITION_FLASH::begin(const char* label) {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    return partition != nullptr;
+}
+
+bool PARTITION_FLASH::read(uint32_t offset, void* buffer, uint32_t size) {
+    return partition && esp_partition_read(partition, offset, buffer, size) == ESP_OK;
+}
+
+bool PARTITION_FLASH::program(uint32_t offset, const void* buffer, uint32_t size) {
+    uint64_t start_us = nowMicros();
+    bool ok = partition && esp_partition_write(partition, offset, buffer, size) == ESP_OK;
+    programLatency.record(uint32_t(nowMicros() - start_us));
+    return ok;
+}
+
+bool PARTITION_FLASH::erase(uint32_t offset, uint32_t size) {
+    uint64_t start_us = nowMicros();
+    bool ok = partition && esp_partition_erase_range(partition, offset, size) == ESP_OK;
+    eraseLatency.record(uint32_t(nowMicros() - start_us));
+    return ok;
+}
+#endif
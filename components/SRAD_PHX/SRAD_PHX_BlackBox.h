@@ -0,0 +1,161 @@
+#ifndef SRAD_PHX_BLACK_BOX_H
+#define SRAD_PHX_BLACK_BOX_H
+
+#include <stdint.h>
+#include "lfs.h"
+
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_HAL.h"
+#include "SRAD_PHX_Histogram.h"
+
+#if defined(ESP_PLATFORM)
+#include "esp_partition.h"
+#endif
+
+#define BLACKBOX_CACHE_SIZE 512         // LittleFS read/program cache, one per buffer below
+#define BLACKBOX_PROG_SIZE 16
+#define BLACKBOX_MAX_BLOCKS 1024        // 4 MB of 4 KB blocks
+#define BLACKBOX_BLOCK_CYCLES 512       // erases before LittleFS moves a metadata pair, as in sdkconfig
+#define BLACKBOX_NAME_MAX 32            // stays mountable by esp_littlefs (CONFIG_LITTLEFS_OBJ_NAME_LEN)
+
+struct BlackBoxStats {
+    uint32_t samplesSeen;           // handed to log()
+    uint32_t samplesLogged;
+    uint32_t samplesThrottled;      // due by the divider but over the byte budget
+    uint32_t bytesLogged;           // record bytes given to LittleFS
+    uint32_t syncs;                 // file syncs, each a metadata commit
+    uint32_t segments;              // segment files started, including the one begin() opens
+    uint32_t erases;                // block erases LittleFS asked for
+    uint32_t erasesSkipped;         // of those, blocks already blank
+    uint32_t blocksPreErased;       // erased ahead by begin()
+    uint32_t errors;                // LittleFS calls that failed
+    uint64_t logCycles;             // CPU spent in log(), flash time included
+};
+
+/**
+ * @brief decimated copy of the binary log on internal flash, for when the SD card is lost
+ *
+ * Keeps its own LittleFS on a `FLASH_DEVICE` (the "blackbox" partition
+ * on target). The log is a ring of `segments` files named by a rising
+ * sequence number. Each file is a complete binary log: schema header,
+ * then 'G'/'S' records exactly as `FLIGHT::writeSD` packs them, so
+ * `log_decode` reads any one of them. When the ring is full the oldest
+ * file is deleted. LittleFS allocates blocks by walking forward through
+ * the whole partition, so freed blocks go to the back of the line and
+ * erases spread evenly.
+ *
+ * `log()` keeps every `divider`-th sample, plus any sample whose state
+ * changed, as long as a token bucket of `maxBytesPerSecond` (one second
+ * deep) allows. The file is synced every `syncInterval_ms` of sample time;
+ * power loss costs at most that much.
+ *
+ * Erasing internal flash stalls the CPU for tens of ms, since the cache is
+ * off while the chip is busy. `begin()` runs on the pad. It erases every
+ * block LittleFS is not using, and the erase hook skips blocks that are
+ * already blank, so until the ring wraps the flight only programs.
+ *
+ * Not thread safe: one task calls `begin()`, `log()` and `end()`. Don't
+ * mount the partition through esp_littlefs/`LittleFS` at the same time.
+ */
+class BLACK_BOX {
+    public:
+        BLACK_BOX(uint16_t divider = 25, uint32_t maxBytesPerSecond = 3072, uint32_t syncInterval_ms = 2000,
+                  uint8_t segments = 8);
+        BLACK_BOX(const BLACK_BOX&) = delete;
+        BLACK_BOX& operator=(const BLACK_BOX&) = delete;
+
+        bool begin(FLASH_DEVICE& flash, const char* csvHeader, bool gpsColumns);
+        void log(const SampleRecord& sample);
+        bool end();
+        bool isOpen() const { return opened; }
+
+        uint32_t extract(FLASH_DEVICE& flash, Print& out);
+
+        uint32_t segmentBytes() const { return segmentLimit; }
+        BlackBoxStats getStats() const { return stats; }
+        const HISTOGRAM& getLogLatency() const { return logLatency; }
+        void resetStats();
+        void printStats(Print &);
+
+    private:
+        static int blockRead(const struct lfs_config*, lfs_block_t, lfs_off_t, void*, lfs_size_t);
+        static int blockProgram(const struct lfs_config*, lfs_block_t, lfs_off_t, const void*, lfs_size_t);
+        static int blockErase(const struct lfs_config*, lfs_block_t);
+        static int blockSync(const struct lfs_config*);
+
+        bool mount(FLASH_DEVICE& flash, bool format);
+        bool listSegments(uint32_t& oldest, uint32_t& newest, uint32_t& count);
+        bool openSegment(uint32_t sequence);
+        bool rotate(bool dropOldest);
+        void preErase();
+        void sync();
+        bool append(const uint8_t* buffer, uint32_t size);
+        bool blank(uint32_t offset);
+
+        uint16_t divider;
+        uint32_t maxBytesPerSecond;
+        uint32_t syncInterval_us;
+        uint8_t segmentCount;
+        uint32_t segmentLimit = 0;
+
+        FLASH_DEVICE* device = nullptr;
+        lfs_t lfs;
+        lfs_file_t file;
+        struct lfs_config config;
+        struct lfs_file_config fileConfig;
+        bool mounted = false;
+        bool opened = false;
+
+        uint8_t header[LOG_HEADER_MAX_SIZE];
+        uint16_t headerLength = 0;
+        bool gps = false;
+        uint8_t lastGps[LOG_GPS_SIZE];
+        bool gpsWritten = false;
+        uint32_t sequence = 0;              // of the open segment
+        uint32_t segmentLength = 0;
+        uint32_t sinceLogged = 0;           // samples since the last one kept
+        uint8_t lastState = 0xFF;
+        uint64_t lastSample_us = 0;
+        uint64_t lastSync_us = 0;
+        bool unsynced = false;
+        uint64_t budget = 0;                // token bucket in byte-microseconds, exact at any sample rate
+
+        BlackBoxStats stats;
+        HISTOGRAM logLatency;               // microseconds per log() that wrote something
+
+        alignas(4) uint8_t readBuffer[BLACKBOX_CACHE_SIZE];
+        alignas(4) uint8_t programBuffer[BLACKBOX_CACHE_SIZE];
+        alignas(4) uint8_t fileBuffer[BLACKBOX_CACHE_SIZE];
+        alignas(4) uint8_t lookahead[BLACKBOX_MAX_BLOCKS / 8];
+        uint8_t used[BLACKBOX_MAX_BLOCKS / 8];  // preErase()'s map of blocks LittleFS holds
+        alignas(4) uint8_t scratch[256];
+};
+
+#if defined(ESP_PLATFORM)
+/**
+ * @brief `FLASH_DEVICE` on a data partition of the internal flash
+ *
+ * Reads and writes go through `esp_partition_*`. Program and erase times
+ * are kept, since both stall the CPU.
+ */
+class PARTITION_FLASH : public FLASH_DEVICE {
+    public:
+        bool begin(const char* label = "blackbox");
+
+        uint32_t size() const override { return partition ? partition->size : 0; }
+        uint32_t blockSize() const override { return partition ? partition->erase_size : 4096; }
+        bool read(uint32_t offset, void* buffer, uint32_t size) override;
+        bool program(uint32_t offset, const void* buffer, uint32_t size) override;
+        bool erase(uint32_t offset, uint32_t size) override;
+
+        const HISTOGRAM& getProgramLatency() const { return programLatency; }
+        const HISTOGRAM& getEraseLatency() const { return eraseLatency; }
+
+    private:
+        const esp_partition_t* partition = nullptr;
+        HISTOGRAM programLatency;           // microseconds per program()
+        HISTOGRAM eraseLatency;             // microseconds per erase()
+};
+#endif
+
+#endif
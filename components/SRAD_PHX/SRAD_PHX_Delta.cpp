@@ -0,0 +1,124 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include "SRAD_PHX_Delta.h"
+
+static inline uint64_t getLE(const uint8_t* in, uint8_t bytes) {
+    uint64_t value = 0;
+    for(uint8_t ind = 0; ind < bytes; ind++) {
+        value |= uint64_t(in[ind]) << (8 * ind);
+    }
+    return value;
+}
+
+static inline void putLE(uint8_t* out, uint64_t value, uint8_t bytes) {
+    for(uint8_t ind = 0; ind < bytes; ind++) {
+        out[ind] = uint8_t(value >> (8 * ind));
+    }
+}
+
+LOG_DELTA::LOG_DELTA(uint16_t interval) : keyframeInterval(interval) {
+    resetStats();
+}
+
+void LOG_DELTA::setKeyframeInterval(uint16_t interval) {
+    keyframeInterval = interval;
+    reset();
+}
+
+void LOG_DELTA::resetStats() {
+    stats = {};
+}
+
+/**
+ * @brief codes one packed 'S' or 'R' record
+ * @param record The record, type byte included
+ * @param out LOG_DELTA_MAX_SIZE bytes
+ * @return Returns bytes written: a 'D' record, or `record` unchanged as a keyframe
+ */
+size_t LOG_DELTA::encode(const uint8_t* record, uint8_t* out) {
+    if(record[0] != previousType) {
+        layout = logFindType(record[0]);
+        for(uint8_t field = 0; field < layout->fieldCount; field++) {
+            fieldBytes[field] = LOG_ENCODING_BYTES[layout->fields[field].encoding];
+        }
+    }
+    size_t size = layout->size;
+    stats.records++;
+    stats.bytesIn += size;
+
+    if(record[0] == previousType && sinceKeyframe < keyframeInterval) {
+        size_t length = 2;
+        const uint8_t* current = record + 1;
+        const uint8_t* before = previous + 1;
+        for(uint8_t field = 0; field < layout->fieldCount && length < size; field++) {
+            uint8_t bytes = fieldBytes[field];
+            uint8_t shift = 64 - 8 * bytes;
+            // difference wrapped to the field's width, then sign extended from it
+            int64_t delta = int64_t((getLE(current, bytes) - getLE(before, bytes)) << shift) >> shift;
+            uint64_t zigzag = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+            while(zigzag >= 0x80) {
+                out[length++] = uint8_t(zigzag) | 0x80;
+                zigzag >>= 7;
+            }
+            out[length++] = uint8_t(zigzag);
+            current += bytes;
+            before += bytes;
+        }
+        if(length < size) {
+            out[0] = LOG_RECORD_DELTA;
+            out[1] = uint8_t(length - 2);
+            memcpy(previous, record, size);
+            sinceKeyframe++;
+            stats.bytesOut += length;
+            return length;
+        }
+    }
+
+    memcpy(out, record, size);
+    memcpy(previous, record, size);
+    previousType = record[0];
+    sinceKeyframe = 1;
+    stats.keyframes++;
+    stats.bytesOut += size;
+    return size;
+}
+
+void LOG_DELTA::printStats(Print& output) {
+    output.print("log delta: "); output.print(stats.records);
+    output.print(" records, "); output.print(stats.keyframes);
+    output.print(" keyframes, "); output.print(uint32_t(stats.bytesOut));
+    output.print(" of "); output.print(uint32_t(stats.bytesIn));
+    output.print(" B, ratio "); output.println(stats.bytesOut ? double(stats.bytesIn) / stats.bytesOut : 0.0, 2);
+}
+
+bool logDeltaDecode(uint8_t* previous, const uint8_t* fieldBytes, uint8_t fieldCount,
+                    const uint8_t* payload, size_t length) {
+    const uint8_t* end = payload + length;
+    uint8_t* field = previous + 1;
+    for(uint8_t ind = 0; ind < fieldCount; ind++) {
+        uint64_t zigzag = 0;
+        uint8_t shift = 0;
+        uint8_t next;
+        do {
+            if(payload == end || shift > 63) {
+                return false;
+            }
+            next = *payload++;
+            zigzag |= uint64_t(next & 0x7F) << shift;
+            shift += 7;
+        } while(next & 0x80);
+        uint64_t delta = (zigzag >> 1) ^ (0 - (zigzag & 1));
+        putLE(field, getLE(field, fieldBytes[ind]) + delta, fieldBytes[ind]);
+        field += fieldBytes[ind];
+    }
+    return payload == end;
+}
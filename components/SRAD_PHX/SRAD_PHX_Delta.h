@@ -0,0 +1,76 @@
+#ifndef SRAD_PHX_DELTA_H
+#define SRAD_PHX_DELTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Print.h>
+
+#include "SRAD_PHX_Log.h"
+
+// room `LOG_DELTA::encode` needs: a 'D' record is abandoned for a keyframe
+// once it reaches the record's size, which one varint can overshoot
+#define LOG_DELTA_MAX_SIZE (LOG_SAMPLE_SIZE + 10)
+
+struct DeltaStats {
+    uint32_t records;               // handed to encode()
+    uint32_t keyframes;             // of those, written whole
+    uint64_t bytesIn;               // 'S'/'R' bytes handed in
+    uint64_t bytesOut;              // bytes written in their place
+};
+
+/**
+ * @brief delta + zig-zag varint coder for the 'S' and 'R' sample records
+ *
+ * Every field of a packed record is taken as an integer of its stored
+ * width (F32 fields by their bit pattern) and replaced by its difference
+ * from the same field of the previous record, wrapped to that width. The
+ * differences are zig-zag mapped, so small negative ones stay small, and
+ * written as LEB128 varints into a 'D' record: u8 'D', u8 length, the
+ * varints in field order. A field that didn't change costs one byte.
+ *
+ * Every `keyframeInterval`-th record goes out whole, as do the first after
+ * `reset()` or a change of record type, and any record whose deltas would
+ * take as much room as the record. A decoder can start at any keyframe;
+ * 'D' records before the first one it sees are skipped. Records are
+ * chained, so call `reset()` whenever one may not have reached the file.
+ *
+ * Not thread safe: one task encodes.
+ */
+class LOG_DELTA {
+    public:
+        LOG_DELTA(uint16_t keyframeInterval = 0);
+
+        void setKeyframeInterval(uint16_t interval);
+        uint16_t getKeyframeInterval() const { return keyframeInterval; }
+        bool enabled() const { return keyframeInterval != 0; }
+        void reset() { previousType = 0; }
+
+        size_t encode(const uint8_t* record, uint8_t* out);
+
+        DeltaStats getStats() const { return stats; }
+        void resetStats();
+        void printStats(Print &);
+
+    private:
+        uint16_t keyframeInterval;      // 0: off, 1: every record is a keyframe
+        uint16_t sinceKeyframe = 0;
+        uint8_t previousType = 0;       // 0 until a keyframe is written
+        const LogRecordType* layout = nullptr;     // of `previousType`
+        uint8_t fieldBytes[32];                     // its field widths
+        uint8_t previous[LOG_SAMPLE_SIZE];
+        DeltaStats stats;
+};
+
+/**
+ * @brief rebuilds the record a 'D' record stands for
+ * @param previous Last 'S'/'R' record, type byte included; becomes the rebuilt record
+ * @param fieldBytes Stored width of each of its fields, as LOG_ENCODING_BYTES gives them
+ * @param fieldCount Fields in the record
+ * @param payload The 'D' record after its length byte
+ * @param length Payload bytes
+ * @return Returns `false`, leaving `previous` partly updated, if the payload doesn't fit the layout
+ */
+bool logDeltaDecode(uint8_t* previous, const uint8_t* fieldBytes, uint8_t fieldCount,
+                    const uint8_t* payload, size_t length);
+
+#endif
@@ -0,0 +1,100 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include <utility>
+#include "SRAD_PHX_Fields.h"
+
+// what the GPS group prints as while there is no fix
+#define FIELD_NO_FIX "-1,No fix,-1,No fix,0,-1,-1,-1,"
+#define FIELD_NO_FIX_DEBUG FIELD_NO_FIX "\n\r\n"
+
+// index of the first field of `format` with all of `mask`, FIELD_COUNT if none
+static constexpr size_t firstField(uint8_t format, uint8_t mask) {
+    for(size_t field = 0; field < FIELD_COUNT; field++) {
+        if((TELEMETRY_FIELDS[field].formats & format) && (TELEMETRY_FIELDS[field].formats & mask) == mask) {
+            return field;
+        }
+    }
+    return FIELD_COUNT;
+}
+
+static constexpr size_t lastField(uint8_t format) {
+    size_t last = FIELD_COUNT;
+    for(size_t field = 0; field < FIELD_COUNT; field++) {
+        if(TELEMETRY_FIELDS[field].formats & format) {
+            last = field;
+        }
+    }
+    return last;
+}
+
+// one field's text; everything but the value is settled at compile time
+template <uint8_t FORMAT, size_t FIELD>
+static inline void textField(const SampleRecord& sample, bool gpsColumns, TEXT_ROW& row) {
+    constexpr TelemetryField field = TELEMETRY_FIELDS[FIELD];
+    if constexpr(field.formats & FORMAT) {
+        if constexpr(field.formats & FIELD_GPS) {
+            if(!gpsColumns) {
+                return;
+            }
+            if(!sample.data.gps_fix) {
+                if constexpr(FIELD == firstField(FORMAT, FIELD_GPS)) {
+                    row.print(FORMAT == FIELD_DEBUG ? FIELD_NO_FIX_DEBUG : FIELD_NO_FIX);
+                }
+                return;
+            }
+        }
+        if constexpr(FORMAT == FIELD_DEBUG) {
+            if constexpr(field.label[0] != '\0') {
+                row.print(field.label);
+            }
+        }
+
+        const uint8_t* value = (const uint8_t*)&sample + field.offset;
+        if constexpr(field.type == FIELD_F32) {
+            float number;
+            memcpy(&number, value, sizeof(number));
+            row.print(number, field.decimals);
+        } else if constexpr(field.type == FIELD_U64) {
+            uint64_t number;
+            memcpy(&number, value, sizeof(number));
+            row.print((unsigned long long)number);
+        } else {
+            row.print(int(*value));
+        }
+
+        if constexpr(FORMAT == FIELD_DEBUG) {
+            row.print(field.debugEnd);
+        } else if constexpr(FIELD == lastField(FORMAT)) {
+            row.println();
+        } else if constexpr(FORMAT == FIELD_SD && (field.formats & FIELD_CSV_SPACE)) {
+            row.print(", ");
+        } else {
+            row.print(',');
+        }
+    }
+}
+
+template <uint8_t FORMAT, size_t... FIELDS>
+static inline void textFields(const SampleRecord& sample, bool gpsColumns, TEXT_ROW& row,
+                              std::index_sequence<FIELDS...>) {
+    (textField<FORMAT, FIELDS>(sample, gpsColumns, row), ...);
+}
+
+template <uint8_t FORMAT>
+void fieldsText(const SampleRecord& sample, bool gpsColumns, TEXT_ROW& row) {
+    static_assert(lastField(FORMAT) < FIELD_COUNT, "a format without fields");
+    textFields<FORMAT>(sample, gpsColumns, row, std::make_index_sequence<FIELD_COUNT>());
+}
+
+template void fieldsText<FIELD_SD>(const SampleRecord&, bool, TEXT_ROW&);
+template void fieldsText<FIELD_SERIAL>(const SampleRecord&, bool, TEXT_ROW&);
+template void fieldsText<FIELD_DEBUG>(const SampleRecord&, bool, TEXT_ROW&);
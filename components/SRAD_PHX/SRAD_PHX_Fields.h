@@ -0,0 +1,140 @@
+#ifndef SRAD_PHX_FIELDS_H
+#define SRAD_PHX_FIELDS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_Text.h"
+
+// The one list of what the FLIGHT writers put out, see README "Field table".
+// Every writer walks it in order and prints the fields its bit is set for:
+// writeSD's CSV rows and its 'S'/'R' records, writeSERIAL and writeDEBUG.
+// The serializers are generated per format at compile time. To add a
+// field, add a row here; if it's FIELD_SD, bump LOG_SAMPLE_SIZE and
+// LOG_RAW_SIZE as the static_asserts in SRAD_PHX_Log.cpp say.
+
+enum FIELD_FORMATS {
+    FIELD_SD = 0x01,                // writeSD: a CSV column, and an 'S'/'R' field if it has an encoding
+    FIELD_SERIAL = 0x02,            // writeSERIAL
+    FIELD_DEBUG = 0x04,             // writeDEBUG, with its label
+    FIELD_GPS = 0x10,               // only with a GPS; "No fix" text in place of the group without a fix
+    FIELD_STATUS = 0x20,            // a sensor_status bit, in the flags word of 'S'/'R'
+    FIELD_CSV_SPACE = 0x40,         // writeSD's CSV puts ", " after it, not ","
+};
+
+enum FIELD_TYPES {
+    FIELD_F32 = 0,
+    FIELD_U8 = 1,
+    FIELD_U64 = 2,
+};
+
+#define FIELD_NOT_LOGGED 0xFF           // encoding of a field without a place in 'S'/'R'
+
+struct TelemetryField {
+    const char* name;               // schema name, the member's
+    uint16_t offset;                // in SampleRecord
+    uint8_t type;                   // FIELD_TYPES
+    uint8_t decimals;               // what every text format prints with
+    uint8_t formats;                // FIELD_FORMATS
+    uint8_t encoding;               // LOG_ENCODINGS in 'S', FIELD_NOT_LOGGED
+    uint16_t rawOffset;             // 'R' logs the int16_t/int8_t count here instead, 0: as 'S' does
+    uint8_t rawEncoding;            // LOG_I16 or LOG_I8 for a count
+    uint8_t conversion;             // RAW_CONVERSIONS for the count
+    const char* label;              // writeDEBUG prints this before the value
+    const char* debugEnd;           // and this after it
+};
+
+#define FIELD_AT(member) uint16_t(offsetof(SampleRecord, member))
+
+// text writers only
+#define FIELD_TEXT(member, type, decimals, formats, label, end) \
+    {#member, FIELD_AT(data.member), type, decimals, formats, FIELD_NOT_LOGGED, 0, 0, RAW_NONE, label, end}
+// in every writeSD format; `count` is the int16_t/int8_t LOG_FORMAT_RAW logs in its place
+#define FIELD_LOGGED(member, decimals, formats, encoding, label, end) \
+    {#member, FIELD_AT(data.member), FIELD_F32, decimals, formats, encoding, 0, 0, RAW_NONE, label, end}
+#define FIELD_COUNTED(member, decimals, formats, encoding, count, rawEncoding, conversion, label, end) \
+    {#member, FIELD_AT(data.member), FIELD_F32, decimals, formats, encoding, FIELD_AT(data.count), \
+     rawEncoding, conversion, label, end}
+#define FIELD_SENSOR(name, index, label, end) \
+    {name, FIELD_AT(data.sensor_status[index]), FIELD_U8, 0, \
+     FIELD_SD | FIELD_SERIAL | FIELD_DEBUG | FIELD_STATUS, FIELD_NOT_LOGGED, 0, 0, RAW_NONE, label, end}
+
+#define FIELD_ALL (FIELD_SD | FIELD_SERIAL | FIELD_DEBUG)
+#define FIELD_ALL_GPS (FIELD_ALL | FIELD_GPS)
+
+// order is the column order of every format; time_us must stay first, 'S'/'R' put their flags after it
+inline constexpr TelemetryField TELEMETRY_FIELDS[] = {
+    {"time_us", FIELD_AT(time_us), FIELD_U64, 0, FIELD_ALL | FIELD_CSV_SPACE, LOG_U64, 0, 0, RAW_NONE,
+     "Uptime (us): ", ", \n"},
+    {"state", FIELD_AT(state), FIELD_U8, 0, FIELD_DEBUG, FIELD_NOT_LOGGED, 0, 0, RAW_NONE,
+     "State: ", "\r\n\n\r\n"},
+
+    // 'G' carries these in binary, see logPackGps()
+    FIELD_TEXT(gps_lat, FIELD_F32, 6, FIELD_ALL_GPS | FIELD_CSV_SPACE, "GPS Latitude Degrees: ", ", \r\n"),
+    FIELD_TEXT(gps_lon, FIELD_F32, 6, FIELD_ALL_GPS, "GPS Longitude Degrees: ", ",\r\n"),
+    FIELD_TEXT(gps_sats, FIELD_U8, 0, FIELD_ALL_GPS, "GPS satellites: ", ","),
+    FIELD_TEXT(gps_speed, FIELD_F32, 3, FIELD_ALL_GPS, "GPS speed: ", ","),
+    FIELD_TEXT(gps_angle, FIELD_F32, 3, FIELD_ALL_GPS, "GPS angle: ", ","),
+    FIELD_TEXT(gps_alt, FIELD_F32, 3, FIELD_ALL_GPS, "GPS altitude: ", "\r\n\r\n"),
+
+    FIELD_TEXT(lsm_gyro_x, FIELD_F32, 5, FIELD_SERIAL | FIELD_DEBUG, "LSM Gyro X: ", ","),
+    FIELD_TEXT(lsm_gyro_y, FIELD_F32, 5, FIELD_SERIAL | FIELD_DEBUG, "LSM Gyro Y: ", ","),
+    FIELD_TEXT(lsm_gyro_z, FIELD_F32, 5, FIELD_SERIAL | FIELD_DEBUG, "LSM Gyro Z: ", ",\r\n"),
+    FIELD_TEXT(lsm_acc_x, FIELD_F32, 5, FIELD_DEBUG, "LSM Acc X: ", ","),
+    FIELD_TEXT(lsm_acc_y, FIELD_F32, 5, FIELD_DEBUG, "LSM Acc Y: ", ","),
+    FIELD_TEXT(lsm_acc_z, FIELD_F32, 5, FIELD_DEBUG, "LSM Acc Z: ", ",\r\n"),
+
+    FIELD_COUNTED(bno_ori_w, 5, FIELD_ALL, LOG_FIXED24, raw_bno_ori[0], LOG_I16, RAW_BNO_QUAT, "BNO W-Orientation: ", ","),
+    FIELD_COUNTED(bno_ori_x, 5, FIELD_ALL, LOG_FIXED24, raw_bno_ori[1], LOG_I16, RAW_BNO_QUAT, "BNO X-Orientation: ", ","),
+    FIELD_COUNTED(bno_ori_y, 5, FIELD_ALL, LOG_FIXED24, raw_bno_ori[2], LOG_I16, RAW_BNO_QUAT, "BNO Y-Orientation: ", ","),
+    FIELD_COUNTED(bno_ori_z, 5, FIELD_ALL, LOG_FIXED24, raw_bno_ori[3], LOG_I16, RAW_BNO_QUAT, "BNO Z-Orientation: ", ",\r\n"),
+    FIELD_COUNTED(bno_gyro_x, 5, FIELD_ALL, LOG_FIXED24, raw_bno_gyro[0], LOG_I16, RAW_BNO_GYRO, "BNO X-Gyro: ", ","),
+    FIELD_COUNTED(bno_gyro_y, 5, FIELD_ALL, LOG_FIXED24, raw_bno_gyro[1], LOG_I16, RAW_BNO_GYRO, "BNO Y-Gyro: ", ","),
+    FIELD_COUNTED(bno_gyro_z, 5, FIELD_ALL, LOG_FIXED24, raw_bno_gyro[2], LOG_I16, RAW_BNO_GYRO, "BNO Z-Gyro: ", ",\r\n"),
+    FIELD_COUNTED(bno_acc_x, 4, FIELD_ALL, LOG_FIXED24, raw_bno_acc[0], LOG_I16, RAW_BNO_ACC, "BNO X-Accel: ", ","),
+    FIELD_COUNTED(bno_acc_y, 4, FIELD_ALL, LOG_FIXED24, raw_bno_acc[1], LOG_I16, RAW_BNO_ACC, "BNO Y-Accel: ", ","),
+    FIELD_COUNTED(bno_acc_z, 4, FIELD_ALL, LOG_FIXED24, raw_bno_acc[2], LOG_I16, RAW_BNO_ACC, "BNO Z-Accel: ", ",\r\n"),
+    FIELD_COUNTED(adxl_acc_x, 2, FIELD_ALL, LOG_FIXED24, raw_adxl_acc[0], LOG_I16, RAW_ADXL_ACC, "ADXL X_Accel: ", ","),
+    FIELD_COUNTED(adxl_acc_y, 2, FIELD_ALL, LOG_FIXED24, raw_adxl_acc[1], LOG_I16, RAW_ADXL_ACC, "ADXL Y_Accel: ", ","),
+    FIELD_COUNTED(adxl_acc_z, 2, FIELD_ALL, LOG_FIXED24, raw_adxl_acc[2], LOG_I16, RAW_ADXL_ACC, "ADXL Z_Accel: ", ",\r\n"),
+    // the BMP390 compensates in floating point, there are no counts to log
+    FIELD_LOGGED(bmp_press, 6, FIELD_ALL, LOG_F32, "BMP Pressure: ", ","),
+    FIELD_LOGGED(bmp_alt, 4, FIELD_ALL, LOG_F32, "BMP Altitude: ", ",\r\n"),
+
+    FIELD_TEXT(ekf_ori_w, FIELD_F32, 5, FIELD_DEBUG, "EKF W-Orientation: ", ","),
+    FIELD_TEXT(ekf_ori_x, FIELD_F32, 5, FIELD_DEBUG, "EKF X-Orientation: ", ","),
+    FIELD_TEXT(ekf_ori_y, FIELD_F32, 5, FIELD_DEBUG, "EKF Y-Orientation: ", ","),
+    FIELD_TEXT(ekf_ori_z, FIELD_F32, 5, FIELD_DEBUG, "EKF Z-Orientation: ", ",\r\n"),
+    FIELD_TEXT(ekf_vel, FIELD_F32, 3, FIELD_DEBUG, "EKF Velocity: ", ","),
+    FIELD_TEXT(ekf_alt, FIELD_F32, 3, FIELD_DEBUG, "EKF Altitude: ", ",\r\n"),
+
+    FIELD_COUNTED(lsm_temp, 2, FIELD_ALL, LOG_FIXED16, raw_lsm_temp, LOG_I16, RAW_LSM_TEMP, "LSM Temp: ", ","),
+    FIELD_LOGGED(adxl_temp, 2, FIELD_ALL, LOG_FIXED16, "ADXL Temp: ", ","),
+    FIELD_COUNTED(bno_temp, 2, FIELD_ALL, LOG_FIXED16, raw_bno_temp, LOG_I8, RAW_BNO_TEMP, "BNO Temp: ", ","),
+    FIELD_LOGGED(bmp_temp, 2, FIELD_ALL, LOG_FIXED16, "BMP Temp: ", "\n\r\n"),
+
+    FIELD_SENSOR("lsm", SENSOR_LSM, "Sensor Status:\r\n", ", "),
+    FIELD_SENSOR("bmp", SENSOR_BMP, "", ", "),
+    FIELD_SENSOR("adxl", SENSOR_ADXL, "", ", "),
+    FIELD_SENSOR("bno", SENSOR_BNO, "", ", "),
+    FIELD_SENSOR("gps", SENSOR_GPS, "", "\n\r\n"),
+};
+
+#define FIELD_COUNT (sizeof(TELEMETRY_FIELDS) / sizeof(TELEMETRY_FIELDS[0]))
+
+static_assert(TELEMETRY_FIELDS[0].offset == offsetof(SampleRecord, time_us), "time_us leads every format");
+
+/**
+ * @brief writes one record's fields as text
+ * @tparam FORMAT FIELD_SD for the CSV row, FIELD_SERIAL or FIELD_DEBUG
+ * @param sample The record
+ * @param gpsColumns Whether the GPS group is printed, i.e. the FLIGHT has a GPS
+ * @param row Where the text goes; the caller sends it
+ *
+ * Instantiated for the three formats in SRAD_PHX_Fields.cpp, each a
+ * straight run of the calls its fields need.
+ */
+template <uint8_t FORMAT>
+void fieldsText(const SampleRecord& sample, bool gpsColumns, TEXT_ROW& row);
+
+#endif
@@ -0,0 +1,206 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include "SRAD_PHX_FlightFile.h"
+#include "SRAD_PHX_Time.h"
+
+extern "C" {
+#include "diskio.h"
+}
+
+#define FLIGHT_FILE_FILL_SECTORS 16         // sectors per disk_write() while zero filling
+
+FLIGHT_FILE::~FLIGHT_FILE() {
+    close();
+}
+
+/**
+ * @brief creates the log file and reserves one contiguous extent for it
+ * @param path FatFs path, e.g. "0:/flight.bin"; an existing file is replaced
+ * @param bytes Extent to reserve, rounded up to whole sectors
+ * @param zeroFill Also zero the extent, so a log cut short by power loss
+ *        ends in zeros instead of whatever an older file left there
+ * @return Returns `false` if the file can't be created or no contiguous free space is that large
+ *
+ * Call on the pad: `f_expand` scans the FAT for free space, and zero
+ * filling writes the whole extent (tens of seconds for a large one). The
+ * directory entry and FAT are synced right away, so a log cut off by a
+ * reset is still a file of the full extent's size.
+ */
+bool FLIGHT_FILE::preallocate(const char* path, uint64_t bytes, bool zeroFill) {
+    close();
+    if(f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE | FA_READ) != FR_OK) {
+        return false;
+    }
+    uint64_t rounded = (bytes + FLIGHT_FILE_SECTOR - 1) / FLIGHT_FILE_SECTOR * FLIGHT_FILE_SECTOR;
+    if(rounded == 0 || f_expand(&file, rounded, 1) != FR_OK || f_sync(&file) != FR_OK) {
+        f_close(&file);
+        f_unlink(path);
+        return false;
+    }
+
+    // clst2sect() is private to ff.c, this is the same arithmetic
+    FATFS* fs = file.obj.fs;
+    pdrv = fs->pdrv;
+    firstSector = fs->database + LBA_t(fs->csize) * (file.obj.sclust - 2);
+    sectorCount = uint32_t(rounded / FLIGHT_FILE_SECTOR);
+    written = 0;
+    durable = 0;
+    tailLength = 0;
+    failures = 0;
+    writeLatency.reset();
+    opened = true;
+
+    if(zeroFill) {
+        static const uint8_t zeros[FLIGHT_FILE_FILL_SECTORS * FLIGHT_FILE_SECTOR] = {};
+        for(uint32_t sector = 0; sector < sectorCount; sector += FLIGHT_FILE_FILL_SECTORS) {
+            uint32_t count = sectorCount - sector < FLIGHT_FILE_FILL_SECTORS ? sectorCount - sector : FLIGHT_FILE_FILL_SECTORS;
+            if(disk_write(pdrv, zeros, firstSector + sector, count) != RES_OK) {
+                close();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief reopens a log after a warm reset, to append where it left off
+ * @param path The path `preallocate()` was given
+ * @param position What `position()` returned before the reset, see `resumeLoadLog()`
+ * @return Returns `false` if the file can't be opened or isn't the extent `position` describes
+ *
+ * One directory lookup and at most one sector read, the extent was
+ * reserved and synced by `preallocate()`. The log goes on from the last
+ * byte that reached the card; whatever was still buffered is lost, so a
+ * framed log (`LOG_FRAMER`) is the one that decodes cleanly across it.
+ */
+bool FLIGHT_FILE::resume(const char* path, const LogResume& position) {
+    close();
+    if(f_open(&file, path, FA_WRITE | FA_READ) != FR_OK) {
+        return false;
+    }
+    FATFS* fs = file.obj.fs;
+    LBA_t start = fs->database + LBA_t(fs->csize) * (file.obj.sclust - 2);
+    if(file.obj.sclust < 2 || fs->pdrv != position.pdrv || start != position.firstSector
+       || position.durable > uint64_t(position.sectorCount) * FLIGHT_FILE_SECTOR
+       || f_size(&file) < uint64_t(position.sectorCount) * FLIGHT_FILE_SECTOR) {
+        f_close(&file);
+        return false;
+    }
+    pdrv = fs->pdrv;
+    firstSector = start;
+    sectorCount = position.sectorCount;
+    written = position.durable;
+    durable = written;
+    tailLength = uint16_t(written % FLIGHT_FILE_SECTOR);
+    failures = 0;
+    writeLatency.reset();
+
+    // the partial sector as flush() last left it on the card
+    if(tailLength && disk_read(pdrv, tail, firstSector + LBA_t(written / FLIGHT_FILE_SECTOR), 1) != RES_OK) {
+        f_close(&file);
+        return false;
+    }
+    opened = true;
+    return true;
+}
+
+// where the log stands on the card, for `resumeSaveLog()`; the frame fields are left 0
+LogResume FLIGHT_FILE::position() const {
+    LogResume result = {};
+    result.firstSector = firstSector;
+    result.durable = durable;
+    result.sectorCount = sectorCount;
+    result.pdrv = pdrv;
+    return result;
+}
+
+/**
+ * @brief writes the partial sector, trims the file to its real size and closes it
+ * @return Returns `false` if FatFs reported an error, the data written so far is still on the card
+ */
+bool FLIGHT_FILE::close() {
+    if(!opened) {
+        return true;
+    }
+    flush();
+    opened = false;
+    bool ok = f_lseek(&file, written) == FR_OK;
+    ok = f_truncate(&file) == FR_OK && ok;
+    return f_close(&file) == FR_OK && ok;
+}
+
+/**
+ * @brief appends to the extent, whole sectors go out immediately
+ * @param buffer Bytes to log
+ * @param size Length of `buffer`
+ * @return Returns `size`, or 0 if the file isn't open, the write would run past the extent or the card failed
+ */
+size_t FLIGHT_FILE::write(const uint8_t* buffer, size_t size) {
+    if(!opened || written + size > capacity()) {
+        failures++;
+        return 0;
+    }
+
+    // a failed disk write loses its sectors but keeps the file position, so later records still land where expected
+    uint32_t sector = uint32_t(written / FLIGHT_FILE_SECTOR);
+    size_t left = size;
+    bool ok = true;
+    if(tailLength) {
+        size_t chunk = left < size_t(FLIGHT_FILE_SECTOR - tailLength) ? left : FLIGHT_FILE_SECTOR - tailLength;
+        memcpy(tail + tailLength, buffer, chunk);
+        tailLength += chunk;
+        buffer += chunk;
+        left -= chunk;
+        if(tailLength == FLIGHT_FILE_SECTOR) {
+            ok = writeSectors(tail, sector, 1);
+            tailLength = 0;
+            sector++;
+        }
+    }
+
+    uint32_t whole = left / FLIGHT_FILE_SECTOR;
+    if(whole) {
+        ok = writeSectors(buffer, sector, whole) && ok;
+        buffer += whole * FLIGHT_FILE_SECTOR;
+        left -= whole * FLIGHT_FILE_SECTOR;
+    }
+    if(left) {
+        memcpy(tail, buffer, left);
+        tailLength = left;
+    }
+    written += size;
+    durable = written - tailLength;
+    return ok ? size : 0;
+}
+
+// puts the partial sector on the card, zero padded; it is rewritten as it fills
+void FLIGHT_FILE::flush() {
+    if(!opened || !tailLength) {
+        return;
+    }
+    memset(tail + tailLength, 0, FLIGHT_FILE_SECTOR - tailLength);
+    if(writeSectors(tail, uint32_t(written / FLIGHT_FILE_SECTOR), 1)) {
+        durable = written;
+    }
+}
+
+bool FLIGHT_FILE::writeSectors(const uint8_t* buffer, uint32_t first, uint32_t count) {
+    uint64_t start_us = nowMicros();
+    DRESULT result = disk_write(pdrv, buffer, firstSector + first, count);
+    writeLatency.record(uint32_t(nowMicros() - start_us));
+    if(result != RES_OK) {
+        failures++;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef SRAD_PHX_FLIGHT_FILE_H
+#define SRAD_PHX_FLIGHT_FILE_H
+
+#include <stdint.h>
+#include "ff.h"
+
+#include "SRAD_PHX_HAL.h"
+#include "SRAD_PHX_Histogram.h"
+#include "SRAD_PHX_Resume.h"
+
+#define FLIGHT_FILE_SECTOR 512
+
+/**
+ * @brief flight log file written sector by sector into a preallocated extent
+ *
+ * `preallocate()` runs on the pad. It creates the file through FatFs, has
+ * FatFs reserve one contiguous run of clusters for the whole flight
+ * (`f_expand`) and notes the extent's first physical sector. During
+ * flight, `write()` goes straight to the card with `disk_write()`: whole
+ * sectors, several at once, which the SD driver sends as one CMD25
+ * multi-block write. Nothing touches the FAT or the directory until
+ * `close()` trims the file to what was written.
+ *
+ * Meant to sit under a `LOG_WRITER`, whose buffers always end on a sector
+ * boundary. Any other split is handled by holding the partial sector back
+ * until it fills; `flush()` writes it out zero padded and rewrites it once
+ * more arrives.
+ *
+ * Paths are FatFs paths: the Arduino SD library mounts its first card as
+ * drive 0, so "/sd/flight.bin" is "0:/flight.bin". Don't open the same file
+ * through `SD` at the same time.
+ */
+class FLIGHT_FILE : public Print {
+    public:
+        FLIGHT_FILE() {}
+        ~FLIGHT_FILE();
+        FLIGHT_FILE(const FLIGHT_FILE&) = delete;
+        FLIGHT_FILE& operator=(const FLIGHT_FILE&) = delete;
+
+        bool preallocate(const char* path, uint64_t bytes, bool zeroFill = false);
+        bool resume(const char* path, const LogResume& position);
+        bool close();
+        bool isOpen() const { return opened; }
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+        void flush() override;
+
+        uint64_t size() const { return written; }
+        LogResume position() const;
+        uint64_t capacity() const { return uint64_t(sectorCount) * FLIGHT_FILE_SECTOR; }
+        uint32_t errors() const { return failures; }        // failed disk writes and writes past capacity
+        const HISTOGRAM& getWriteLatency() const { return writeLatency; }
+
+    private:
+        bool writeSectors(const uint8_t* buffer, uint32_t first, uint32_t count);
+
+        FIL file;
+        bool opened = false;
+        BYTE pdrv = 0;
+        LBA_t firstSector = 0;              // physical sector of the extent's start
+        uint32_t sectorCount = 0;
+        uint64_t written = 0;               // bytes accepted, the size close() trims to
+        uint64_t durable = 0;               // of those, bytes sent to the card
+        uint16_t tailLength = 0;            // bytes of the partial sector at written / 512
+        uint32_t failures = 0;
+        HISTOGRAM writeLatency;             // microseconds per disk_write()
+        alignas(4) uint8_t tail[FLIGHT_FILE_SECTOR];
+};
+
+#endif
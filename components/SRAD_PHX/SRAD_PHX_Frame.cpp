@@ -0,0 +1,207 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include <esp_random.h>
+#include <esp_rom_crc.h>
+
+#include "SRAD_PHX_Frame.h"
+#include "SRAD_PHX_Time.h"
+
+#if defined(ESP_PLATFORM)
+#include "ff.h"
+#endif
+
+static inline void putLE(uint8_t* out, uint32_t value, uint8_t bytes) {
+    for(uint8_t ind = 0; ind < bytes; ind++) {
+        out[ind] = uint8_t(value >> (8 * ind));
+    }
+}
+
+static inline uint32_t getLE(const uint8_t* in, uint8_t bytes) {
+    uint32_t value = 0;
+    for(uint8_t ind = 0; ind < bytes; ind++) {
+        value |= uint32_t(in[ind]) << (8 * ind);
+    }
+    return value;
+}
+
+// CRC32 of a block with its CRC field taken as zero
+static uint32_t blockCrc(const uint8_t* block) {
+    static const uint8_t ZERO[4] = {};
+    uint32_t crc = esp_rom_crc32_le(0, block, LOG_FRAME_HEADER_SIZE - 4);
+    crc = esp_rom_crc32_le(crc, ZERO, 4);
+    return esp_rom_crc32_le(crc, block + LOG_FRAME_HEADER_SIZE, LOG_FRAME_PAYLOAD);
+}
+
+LOG_FRAMER::LOG_FRAMER(Print& output, uint32_t id, uint32_t next)
+    : out(output), stream(id ? id : esp_random()), sequence(next) {
+    resetStats();
+}
+
+void LOG_FRAMER::resetStats() {
+    stats = {};
+}
+
+/**
+ * @brief adds one record to the stream
+ * @param buffer The record, e.g. what one `writeSD` call packs
+ * @param size Length of `buffer`
+ * @return Returns `size`, or 0 if a block this write completed was refused
+ */
+size_t LOG_FRAMER::write(const uint8_t* buffer, size_t size) {
+    if(!size) {
+        return 0;
+    }
+    if(firstRecord == LOG_FRAME_NO_RECORD) {
+        firstRecord = length;
+    }
+    bool refused = false;
+    size_t left = size;
+    while(left) {
+        size_t chunk = left < size_t(LOG_FRAME_PAYLOAD - length) ? left : LOG_FRAME_PAYLOAD - length;
+        memcpy(block + LOG_FRAME_HEADER_SIZE + length, buffer, chunk);
+        length += chunk;
+        buffer += chunk;
+        left -= chunk;
+        if(length == LOG_FRAME_PAYLOAD) {
+            refused |= !emit();
+        }
+    }
+    stats.payloadBytes += size;
+    return refused ? 0 : size;
+}
+
+/**
+ * @brief writes the partial block and flushes the output
+ *
+ * The block goes out zero padded and the next write starts a new one, so
+ * each sync costs up to one block of padding.
+ */
+void LOG_FRAMER::sync() {
+    if(length) {
+        stats.syncedBlocks++;
+        emit();
+    }
+    out.flush();
+}
+
+// seals `block` and hands it on
+bool LOG_FRAMER::emit() {
+    memset(block + LOG_FRAME_HEADER_SIZE + length, 0, LOG_FRAME_PAYLOAD - length);
+    putLE(block, LOG_FRAME_MAGIC, 4);
+    putLE(block + 4, stream, 4);
+    putLE(block + 8, sequence++, 4);
+    putLE(block + 12, length, 2);
+    putLE(block + 14, firstRecord, 2);
+    uint32_t start = nowCycles();
+    putLE(block + 16, blockCrc(block), 4);
+    stats.crcCycles += nowCycles() - start;
+
+    length = 0;
+    firstRecord = LOG_FRAME_NO_RECORD;
+    if(out.write(block, LOG_FRAME_SIZE) != LOG_FRAME_SIZE) {
+        stats.dropped++;
+        return false;
+    }
+    stats.blocks++;
+    return true;
+}
+
+void LOG_FRAMER::printStats(Print& output) {
+    output.print("log framer: "); output.print(stats.blocks);
+    output.print(" blocks ("); output.print(stats.syncedBlocks);
+    output.print(" synced part full), "); output.print(stats.dropped);
+    output.print(" dropped, stream "); output.print(stream, HEX);
+    output.print(", CRC "); output.print(stats.blocks ? double(stats.crcCycles) / stats.blocks : 0.0, 0);
+    output.println(" cycles per block");
+}
+
+bool logFrameCheck(const uint8_t* block, FrameHeader* header) {
+    if(getLE(block, 4) != LOG_FRAME_MAGIC) {
+        return false;
+    }
+    uint16_t length = getLE(block + 12, 2);
+    uint16_t firstRecord = getLE(block + 14, 2);
+    if(length > LOG_FRAME_PAYLOAD || (firstRecord != LOG_FRAME_NO_RECORD && firstRecord >= length)) {
+        return false;
+    }
+    if(getLE(block + 16, 4) != blockCrc(block)) {
+        return false;
+    }
+    if(header) {
+        *header = {getLE(block + 4, 4), getLE(block + 8, 4), length, firstRecord};
+    }
+    return true;
+}
+
+FrameRecovery logFrameRecover(FRAME_SOURCE& source) {
+    FrameRecovery result = {};
+    uint8_t block[LOG_FRAME_SIZE];
+    FrameHeader header;
+    uint32_t count = source.blockCount();
+    result.reads++;
+    if(!count || !source.readBlock(0, block) || !logFrameCheck(block, &header)) {
+        return result;
+    }
+    result.stream = header.stream;
+    result.lastSequence = header.sequence;
+
+    // good(low) and !good(high) hold throughout; blocks past the end count as bad
+    uint32_t low = 0, high = count;
+    while(high - low > 1) {
+        uint32_t middle = low + (high - low) / 2;
+        result.reads++;
+        if(source.readBlock(middle, block) && logFrameCheck(block, &header)
+           && header.stream == result.stream && header.sequence >= middle) {
+            low = middle;
+            result.lastSequence = header.sequence;     // every good probe moves `low`
+        } else {
+            high = middle;
+        }
+    }
+    result.blocks = low + 1;
+    return result;
+}
+
+#if defined(ESP_PLATFORM)
+class FATFS_FRAME_SOURCE : public FRAME_SOURCE {
+    public:
+        FATFS_FRAME_SOURCE(FIL& f) : file(f) {}
+        uint32_t blockCount() override { return uint32_t(f_size(&file) / LOG_FRAME_SIZE); }
+        bool readBlock(uint32_t index, uint8_t* block) override {
+            UINT got = 0;
+            return f_lseek(&file, FSIZE_t(index) * LOG_FRAME_SIZE) == FR_OK
+                && f_read(&file, block, LOG_FRAME_SIZE, &got) == FR_OK && got == LOG_FRAME_SIZE;
+        }
+
+    private:
+        FIL& file;
+};
+
+bool logFrameRepair(const char* path, FrameRecovery* result) {
+    FIL file;
+    if(f_open(&file, path, FA_READ | FA_WRITE) != FR_OK) {
+        return false;
+    }
+    FATFS_FRAME_SOURCE source(file);
+    FrameRecovery recovery = logFrameRecover(source);
+    bool ok = true;
+    FSIZE_t end = FSIZE_t(recovery.blocks) * LOG_FRAME_SIZE;
+    if(recovery.blocks && end < f_size(&file)) {
+        ok = f_lseek(&file, end) == FR_OK && f_truncate(&file) == FR_OK;
+    }
+    ok = f_close(&file) == FR_OK && ok;
+    if(result) {
+        *result = recovery;
+    }
+    return ok;
+}
+#endif
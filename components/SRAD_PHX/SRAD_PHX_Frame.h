@@ -0,0 +1,143 @@
+#ifndef SRAD_PHX_FRAME_H
+#define SRAD_PHX_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Print.h>
+
+// Framed log, see README "Framed log". Everything little-endian.
+//
+// block:   u32 LOG_FRAME_MAGIC, u32 stream id, u32 sequence, u16 payload
+//          length, u16 offset in the payload of the first write() that
+//          starts in this block (LOG_FRAME_NO_RECORD if none), u32 CRC32
+//          of the whole block with this field zero; then the payload, zero
+//          padded to LOG_FRAME_SIZE
+// file:    blocks back to back from offset 0, sequence counting up from 0
+
+#define LOG_FRAME_MAGIC 0x42505253      // "SRPB"
+#define LOG_FRAME_SIZE 512              // one SD sector, a torn write spoils whole blocks only
+#define LOG_FRAME_HEADER_SIZE 20
+#define LOG_FRAME_PAYLOAD (LOG_FRAME_SIZE - LOG_FRAME_HEADER_SIZE)
+#define LOG_FRAME_NO_RECORD 0xFFFF
+
+struct FrameHeader {
+    uint32_t stream;
+    uint32_t sequence;
+    uint16_t length;
+    uint16_t firstRecord;
+};
+
+struct FrameStats {
+    uint32_t blocks;                // handed to the output
+    uint32_t syncedBlocks;          // of those, written part full by sync()
+    uint32_t dropped;               // refused by the output
+    uint64_t payloadBytes;
+    uint64_t crcCycles;             // spent in esp_rom_crc32_le
+};
+
+/**
+ * @brief cuts the log into fixed-size, checksummed, numbered blocks
+ *
+ * A `Print` to put in front of the log's real output (`LOG_WRITER`, a
+ * `FLIGHT_FILE` or a `File`). Bytes collect in one block; each full block
+ * gets its header and CRC32 (the ROM's `esp_rom_crc32_le`) and goes to the
+ * output in one `write()`. Every `write()` is taken as the start of a
+ * record, which is how `FLIGHT::writeSD` writes the binary formats, so a
+ * decoder that lost a block picks the stream up again at the next block's
+ * `firstRecord`. A CSV row is many writes; its decoder resyncs on newlines.
+ *
+ * A block the output refuses is counted and its sequence number skipped.
+ * The `write()` that completed it returns 0, so `writeSD` starts its
+ * next record fresh (a delta keyframe and the GPS record).
+ *
+ * `flush()` does nothing, a block per `writeSD` flush would waste most of
+ * the card. `sync()` writes the partial block zero padded, then flushes
+ * the output; call it before closing the file.
+ *
+ * After a warm reset, a framer made with the saved `streamId()` and
+ * `nextSequence()` + 1 goes on with the same file (see `LogResume`). The
+ * skipped number is the block the reset cut short, so decoders see the
+ * gap and resync at the new block's `firstRecord`.
+ *
+ * Not thread safe: one task writes.
+ */
+class LOG_FRAMER : public Print {
+    public:
+        LOG_FRAMER(Print& out, uint32_t stream = 0, uint32_t sequence = 0);
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+        void flush() override {}
+        void sync();
+
+        uint32_t streamId() const { return stream; }
+        uint32_t nextSequence() const { return sequence; }
+        FrameStats getStats() const { return stats; }
+        void resetStats();
+        void printStats(Print &);
+
+    private:
+        bool emit();
+
+        Print& out;
+        uint32_t stream;                // tells this file's blocks from an older file's
+        uint32_t sequence;
+        uint16_t length = 0;            // payload bytes in `block`
+        uint16_t firstRecord = LOG_FRAME_NO_RECORD;
+        FrameStats stats;
+        alignas(4) uint8_t block[LOG_FRAME_SIZE];
+};
+
+/**
+ * @brief checks one block
+ * @param block LOG_FRAME_SIZE bytes
+ * @param header Filled in when the block is good, may be `nullptr`
+ * @return Returns `true` if the magic, lengths and CRC32 are right
+ */
+bool logFrameCheck(const uint8_t* block, FrameHeader* header);
+
+// where the recovery scan reads blocks from: a file on the card, a host buffer
+class FRAME_SOURCE {
+    public:
+        virtual ~FRAME_SOURCE() {}
+        virtual uint32_t blockCount() = 0;
+        virtual bool readBlock(uint32_t index, uint8_t* block) = 0;
+};
+
+struct FrameRecovery {
+    uint32_t stream;                // block 0's stream id
+    uint32_t blocks;                // blocks up to and including the last valid one, 0 if block 0 is bad
+    uint32_t lastSequence;          // of that block
+    uint32_t reads;                 // blocks the scan read
+};
+
+/**
+ * @brief finds the last valid block without reading the whole log
+ * @param source The log, from its first block
+ * @return Returns where the log ends
+ *
+ * Blocks are appended in order, so past block 0 the file is valid blocks
+ * of block 0's stream, with sequence numbers at least their index, then
+ * whatever a torn write, a zero filled extent or an older file left. The
+ * scan binary searches that boundary, reading about log2(blocks) blocks.
+ * A bad block in the middle, which appending can't cause, may end the log
+ * there; `log_decode` reads linearly up to the end found.
+ */
+FrameRecovery logFrameRecover(FRAME_SOURCE& source);
+
+#if defined(ESP_PLATFORM)
+/**
+ * @brief recovery scan of a log file on the card, cutting off the damaged tail
+ * @param path FatFs path, e.g. "0:/flight.bin"
+ * @param result Where the log ends, may be `nullptr`
+ * @return Returns `false` if the file couldn't be opened, read or truncated
+ *
+ * For boot, before the next log is opened: a flight that lost power keeps
+ * its last good block and drops the rest, e.g. the unwritten part of a
+ * `FLIGHT_FILE` extent. A file without a valid first block is left alone.
+ */
+bool logFrameRepair(const char* path, FrameRecovery* result = nullptr);
+#endif
+
+#endif
@@ -0,0 +1,200 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "SRAD_PHX_Fusion.h"
+#include "ekf_imu13states.h"
+
+#define FUSION_GRAVITY 9.80665f
+#define FUSION_MAX_GAP 0.1f             // seconds between IMU samples before the filter stops integrating
+#define FUSION_SETTLE_SAMPLES 10        // barometer samples before isValid()
+
+FUSION::FUSION() : ekf(new ekf_imu13states()) {
+    reset();
+}
+
+FUSION::~FUSION() {
+    delete ekf;
+}
+
+void FUSION::reset() {
+    ekf->X *= 0;
+    ekf->P *= 0;
+    ekf->Init();
+    aligned = false;
+    initialized = false;
+    pending = 0;
+    gyroSum[0] = gyroSum[1] = gyroSum[2] = 0;
+    dtSum = 0;
+    h = v = bias = 0;
+    for(uint8_t row = 0; row < 3; row++) {
+        for(uint8_t col = 0; col < 3; col++) {
+            P[row][col] = 0;
+        }
+    }
+    lastImu_us = 0;
+    stats = {};
+}
+
+void FUSION::predict(uint64_t sample_us, const float* gyro, const float* accel, bool highG) {
+    float dt = lastImu_us ? (sample_us - lastImu_us) * 1e-6f : 0.0f;
+    lastImu_us = sample_us;
+    stats.updates++;
+    stats.highG += highG;
+    if(!(dt > 0.0f) || dt > FUSION_MAX_GAP) {
+        return;
+    }
+
+    // attitude: gyro rates averaged over `attitudeDivider` samples drive the EKF
+    if(gyro && aligned) {
+        for(uint8_t axis = 0; axis < 3; axis++) {
+            gyroSum[axis] += gyro[axis] * dt;
+        }
+        dtSum += dt;
+        if(++pending >= attitudeDivider) {
+            float rate[3] = {gyroSum[0] / dtSum, gyroSum[1] / dtSum, gyroSum[2] / dtSum};
+            ekf->Process(rate, dtSum);
+            dspm::Mat quat(ekf->X.data, 4, 1);
+            quat /= quat.norm();
+            pending = 0;
+            gyroSum[0] = gyroSum[1] = gyroSum[2] = 0;
+            dtSum = 0;
+        }
+    }
+    if(!initialized) {
+        return;
+    }
+
+    // earth frame vertical specific force: last row of the body to earth rotation
+    float q[4];
+    attitude(q);
+    float up = 2.0f * (q[1] * q[3] - q[0] * q[2]) * accel[0]
+             + 2.0f * (q[2] * q[3] + q[0] * q[1]) * accel[1]
+             + (q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]) * accel[2];
+    float a = up - FUSION_GRAVITY - bias;
+    h += v * dt + 0.5f * a * dt * dt;
+    v += a * dt;
+
+    // P = F P F' + Q with F = [1 dt -dt^2/2; 0 1 -dt; 0 0 1]
+    float F[3][3] = {{1, dt, -0.5f * dt * dt}, {0, 1, -dt}, {0, 0, 1}};
+    float FP[3][3];
+    for(uint8_t row = 0; row < 3; row++) {
+        for(uint8_t col = 0; col < 3; col++) {
+            FP[row][col] = F[row][0] * P[0][col] + F[row][1] * P[1][col] + F[row][2] * P[2][col];
+        }
+    }
+    float G[3] = {0.5f * dt * dt, dt, 0};
+    float accelVar = accelNoise * accelNoise;
+    for(uint8_t row = 0; row < 3; row++) {
+        for(uint8_t col = 0; col < 3; col++) {
+            P[row][col] = FP[row][0] * F[col][0] + FP[row][1] * F[col][1] + FP[row][2] * F[col][2]
+                        + accelVar * G[row] * G[col];
+        }
+    }
+    P[2][2] += biasDrift * biasDrift * dt;
+}
+
+bool FUSION::correctAttitude(const float* accel) {
+    float norm = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+    if(fabsf(norm / FUSION_GRAVITY - 1.0f) > accelGate) {
+        return false;
+    }
+    if(!aligned) {
+        alignAttitude(accel);
+    }
+
+    float gravity[3] = {accel[0] / norm, accel[1] / norm, accel[2] / norm};
+    float mag[3] = {0, 0, 0};
+    // magnetometer rows weighted out, heading stays free-running
+    float R[6] = {1e9f, 1e9f, 1e9f, 0.01f, 0.01f, 0.01f};
+    ekf->UpdateRefMeasurement(gravity, mag, R);
+    stats.attitudeUpdates++;
+    return true;
+}
+
+void FUSION::correctAltitude(float altitude) {
+    stats.baroUpdates++;
+    float baroVar = baroNoise * baroNoise;
+    if(!initialized) {
+        h = altitude;
+        v = 0;
+        bias = 0;
+        for(uint8_t row = 0; row < 3; row++) {
+            for(uint8_t col = 0; col < 3; col++) {
+                P[row][col] = 0;
+            }
+        }
+        P[0][0] = baroVar;
+        P[1][1] = 1.0f;
+        P[2][2] = 0.25f;
+        initialized = true;
+        return;
+    }
+
+    // H = [1 0 0]
+    float S = P[0][0] + baroVar;
+    float K[3] = {P[0][0] / S, P[1][0] / S, P[2][0] / S};
+    float innovation = altitude - h;
+    h += K[0] * innovation;
+    v += K[1] * innovation;
+    bias += K[2] * innovation;
+
+    float top[3] = {P[0][0], P[0][1], P[0][2]};
+    for(uint8_t row = 0; row < 3; row++) {
+        for(uint8_t col = 0; col < 3; col++) {
+            P[row][col] -= K[row] * top[col];
+        }
+    }
+}
+
+/**
+ * @brief books the cost of one fusion update against `budget_us`
+ * @param cycles CCOUNT cycles the update took
+ * @param cyclesPerUs CPU clock, from `cyclesPerMicro()`
+ */
+void FUSION::recordCycles(uint32_t cycles, uint32_t cyclesPerUs) {
+    stats.lastCycles = cycles;
+    if(cycles > stats.maxCycles) {
+        stats.maxCycles = cycles;
+    }
+    if(cycles > budget_us * cyclesPerUs) {
+        stats.overBudget++;
+    }
+}
+
+bool FUSION::isValid(uint64_t time_us) const {
+    int64_t sinceImu_us = int64_t(time_us - lastImu_us);
+    return initialized && stats.baroUpdates >= FUSION_SETTLE_SAMPLES && lastImu_us != 0
+        && sinceImu_us < int64_t(FUSION_MAX_GAP * 1e6f);
+}
+
+void FUSION::attitude(float q[4]) const {
+    for(uint8_t ind = 0; ind < 4; ind++) {
+        q[ind] = ekf->X.data[ind];
+    }
+}
+
+// starts the EKF at the rotation that takes the measured gravity to earth +z
+void FUSION::alignAttitude(const float* accel) {
+    float norm = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+    float x = accel[0] / norm, y = accel[1] / norm, z = accel[2] / norm;
+    float q[4] = {1.0f + z, y, -x, 0.0f};       // half-way quaternion between body gravity and +z
+    if(q[0] < 1e-6f) {
+        q[0] = 0; q[1] = 1; q[2] = 0;           // upside down, any horizontal axis works
+    }
+    float qNorm = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for(uint8_t ind = 0; ind < 4; ind++) {
+        ekf->X.data[ind] = q[ind] / qNorm;
+        ekf->P(ind, ind) = 1e-3f;
+    }
+    for(uint8_t ind = 4; ind < 7; ind++) {
+        ekf->P(ind, ind) = 1e-5f;               // gyro bias
+    }
+    aligned = true;
+}
@@ -0,0 +1,106 @@
+#ifndef SRAD_PHX_FUSION_H
+#define SRAD_PHX_FUSION_H
+
+#include <stdint.h>
+#include <math.h>
+
+class ekf_imu13states;      // esp-dsp, only SRAD_PHX_Fusion.cpp needs its headers
+
+struct FusionStats {
+    uint32_t updates;               // IMU samples fused
+    uint32_t attitudeUpdates;       // accelerometer corrections of the attitude EKF
+    uint32_t baroUpdates;
+    uint32_t highG;                 // IMU samples taken from the ADXL375
+    uint32_t overBudget;            // updates that took longer than `budget_us`
+    uint32_t lastCycles, maxCycles;
+};
+
+/**
+ * @brief attitude, vertical velocity and altitude from the flight sensors
+ *
+ * Attitude comes from esp-dsp's `ekf_imu13states`: LSM6DSO32 gyro as the
+ * control input, accelerometer corrections only while the measured
+ * specific force is within `accelGate` of 1 g (pad, parachute), because
+ * thrust and drag point it anywhere else. Heading is unobserved and left
+ * free-running; the vertical channel doesn't depend on it.
+ *
+ * Vertical motion is a 3 state Kalman filter (altitude, velocity,
+ * accelerometer bias) predicted from the earth frame vertical specific
+ * force and corrected by every barometric altitude. The LSM6DSO32 is the
+ * accelerometer until any axis nears `imuRange`, then the ADXL375 takes
+ * over. Altitudes are whatever reference the caller feeds to
+ * `correctAltitude()`. Units are m, m/s, m/s^2 and rad/s.
+ */
+class FUSION {
+    public:
+        FUSION();
+        ~FUSION();
+        FUSION(const FUSION&) = delete;
+        FUSION& operator=(const FUSION&) = delete;
+
+        // tuning, set before the first update
+        float imuRange = 32 * 9.80665f;     // LSM6DSO32 full scale, m/s^2
+        float accelGate = 0.1f;             // attitude correction window around 1 g, fraction of g
+        float accelNoise = 2.0f;            // vertical acceleration process noise, m/s^2
+        float biasDrift = 0.05f;            // accelerometer bias random walk, m/s^2 per sqrt(s)
+        float baroNoise = 0.5f;             // barometric altitude noise, m
+        uint8_t attitudeDivider = 1;        // run the attitude EKF every N IMU samples
+        uint32_t budget_us = 250;           // per-update time counted in `overBudget`
+        bool driveApogee = true;            // let isDescent() act on the fused velocity
+
+        void reset();
+
+        /**
+         * @brief propagates attitude and vertical motion to a new IMU sample
+         * @param sample_us Sample time; the first sample and gaps over 100 ms only set the clock
+         * @param gyro LSM6DSO32 rad/s, or nullptr to hold the attitude
+         * @param accel Specific force in the body frame, m/s^2
+         * @param highG `accel` came from the ADXL375
+         */
+        void predict(uint64_t sample_us, const float* gyro, const float* accel, bool highG);
+
+        /**
+         * @brief corrects attitude from a low-g accelerometer sample
+         * @param accel LSM6DSO32 m/s^2, skipped outside `accelGate`
+         * @return Returns `true` if the correction was applied
+         */
+        bool correctAttitude(const float* accel);
+
+        /**
+         * @brief corrects altitude and velocity from one barometer sample
+         * @param altitude Pressure altitude, meters; the first one initializes the filter
+         */
+        void correctAltitude(float altitude);
+
+        void recordCycles(uint32_t cycles, uint32_t cyclesPerUs);
+
+        /**
+         * @brief whether the vertical estimate can be acted on
+         * @param time_us Current sample time
+         * @return Returns `true` once the barometer has settled the filter and an IMU sample arrived in the last 50 ms
+         */
+        bool isValid(uint64_t time_us) const;
+
+        float altitude() const { return h; }
+        float velocity() const { return v; }
+        float accelBias() const { return bias; }
+        void attitude(float q[4]) const;    // w, x, y, z; body to earth
+        const FusionStats& getStats() const { return stats; }
+
+    private:
+        void alignAttitude(const float* accel);
+
+        ekf_imu13states* ekf;
+        bool aligned;                       // attitude initialized from gravity
+        bool initialized;                   // vertical state initialized from the barometer
+        uint8_t pending;                    // IMU samples accumulated for the next EKF step
+        float gyroSum[3];
+        float dtSum;
+
+        float h, v, bias;
+        float P[3][3];
+        uint64_t lastImu_us;                // sample time of the last predict()
+        FusionStats stats;
+};
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef SRAD_PHX_HAL_H
+#define SRAD_PHX_HAL_H
+
+#include <stdint.h>
+#include <math.h>
+#include <Stream.h>     // Print/Stream/String: the Arduino core on target, host/stubs on Linux
+
+// One reading from each kind of device FLIGHT samples. Units match what
+// lands in TelemetryData: m/s^2, rad/s, uT, degrees C, Pa, meters. The
+// raw_* counts are the register values behind the floats that
+// LOG_FORMAT_RAW logs, see SRAD_PHX_Raw.h.
+struct ImuReading {
+    float acc_x, acc_y, acc_z;
+    float gyro_x, gyro_y, gyro_z;
+    float temp;
+    int16_t raw_temp;
+};
+
+struct AccelReading {
+    float acc_x, acc_y, acc_z;
+    float temp;
+    int16_t raw_acc[3];
+};
+
+struct BaroReading {
+    float pressure;                 // Pa
+    float temp;
+};
+
+struct AhrsReading {
+    float ori_w, ori_x, ori_y, ori_z;
+    float gyro_x, gyro_y, gyro_z;
+    float acc_x, acc_y, acc_z;
+    float mag_x, mag_y, mag_z;
+    float temp;
+    int16_t raw_ori[4];             // w, x, y, z
+    int16_t raw_gyro[3], raw_acc[3];
+    int8_t raw_temp;
+};
+
+struct GpsReading {
+    bool fix;
+    uint8_t satellites;
+    float latitudeDegrees, longitudeDegrees;
+    float speed, angle, altitude;   // knots, degrees, meters
+};
+
+/**
+ * @brief sensor interfaces the `read_*` functions sample through
+ *
+ * Each `read()` does one complete bus transaction and returns `false` if
+ * the device didn't answer, leaving the reading untouched.
+ * `enableDataReady()` routes the device's data ready signal to its
+ * interrupt pin (see `SCHEDULER::addDataReady()`), `false` if the device
+ * or backend can't. Backends:
+ * SRAD_PHX_HAL_Adafruit.h wraps the flight drivers, SRAD_PHX_HAL_Sim.h
+ * synthesizes a flight on any platform. Storage and serial outputs are
+ * plain Arduino `Print`s (SD `File`, `HardwareSerial`, `SIM_STORAGE`).
+ */
+class IMU_DEVICE {
+    public:
+        virtual ~IMU_DEVICE() {}
+        virtual bool read(ImuReading &) = 0;
+        virtual bool enableDataReady() { return false; }
+};
+
+class ACCEL_DEVICE {
+    public:
+        virtual ~ACCEL_DEVICE() {}
+        virtual bool read(AccelReading &) = 0;
+        virtual bool enableDataReady() { return false; }
+};
+
+class BARO_DEVICE {
+    public:
+        virtual ~BARO_DEVICE() {}
+        virtual bool read(BaroReading &) = 0;
+        virtual bool enableDataReady() { return false; }
+};
+
+class AHRS_DEVICE {
+    public:
+        virtual ~AHRS_DEVICE() {}
+        virtual bool read(AhrsReading &) = 0;
+};
+
+class GPS_DEVICE {
+    public:
+        virtual ~GPS_DEVICE() {}
+        // true once a fix with satellites is parsed, `GpsReading` always holds the latest sentence
+        virtual bool read(GpsReading &) = 0;
+};
+
+/**
+ * @brief raw NOR flash region, e.g. a partition, that `BLACK_BOX` keeps a file system on
+ *
+ * Offsets are relative to the region. `erase()` covers whole blocks and
+ * leaves them 0xFF; `program()` can only clear bits of erased bytes. Each
+ * call returns `false` on a driver error. Backends: `PARTITION_FLASH` in
+ * SRAD_PHX_BlackBox.h, `SIM_FLASH` in SRAD_PHX_HAL_Sim.h.
+ */
+class FLASH_DEVICE {
+    public:
+        virtual ~FLASH_DEVICE() {}
+        virtual uint32_t size() const = 0;
+        virtual uint32_t blockSize() const = 0;
+        virtual bool read(uint32_t offset, void* buffer, uint32_t size) = 0;
+        virtual bool program(uint32_t offset, const void* buffer, uint32_t size) = 0;
+        virtual bool erase(uint32_t offset, uint32_t size) = 0;
+};
+
+// LoRa modem settings, what a packet's time on air depends on
+struct LoRaSettings {
+    uint8_t spreadingFactor;        // 6 to 12
+    uint32_t bandwidth_Hz;          // 7800 to 500000
+    uint8_t codingRate4;            // denominator of the 4/x coding rate, 5 to 8
+    uint16_t preambleLength;        // symbols, 8 by default
+    bool crc;
+    bool implicitHeader;
+};
+
+// how a received packet was heard, as the SX127x reports it
+struct LinkQuality {
+    float rssi_dBm;                 // packet RSSI, signal plus noise
+    float snr_dB;                   // quarter dB steps, below 0 under the noise floor
+};
+
+/**
+ * @brief downlink radio that `RADIO_LINK` sends telemetry frames through
+ *
+ * `transmit()` loads one frame and starts sending it without waiting,
+ * `false` if the previous frame is still on air or the radio didn't
+ * answer. When the transmission ends the radio raises its TX done line
+ * (DIO0 on an SX127x) if one is wired, `transmitting()` polls for the
+ * same thing over the bus. Backends: `LORA_RADIO` in
+ * SRAD_PHX_HAL_Adafruit.h, `SIM_RADIO` in SRAD_PHX_HAL_Sim.h.
+ *
+ * Link adaptation (SRAD_PHX_Link.h) also needs `setModem()`, between
+ * packets, and `receive()`, which listens for the ground's replies; a
+ * transmit-only radio keeps the defaults.
+ */
+class RADIO_DEVICE {
+    public:
+        virtual ~RADIO_DEVICE() {}
+        virtual bool transmit(const uint8_t* frame, size_t size) = 0;
+        virtual bool transmitting() = 0;
+        virtual uint32_t airtime_us(size_t size) const = 0;    // time on air of a `size` byte frame
+
+        virtual bool setModem(const LoRaSettings&) { return false; }
+        // a packet heard since listening started, 0 if none yet; starts listening if it wasn't
+        virtual size_t receive(uint8_t* frame, size_t size, LinkQuality& quality) {
+            (void)frame;
+            (void)size;
+            (void)quality;
+            return 0;
+        }
+};
+
+/**
+ * @brief time on air of one LoRa packet
+ * @param settings Modem settings the packet is sent with
+ * @param size Payload bytes
+ * @return Returns microseconds from the first preamble symbol to the end of the payload CRC
+ *
+ * Semtech's formula (SX1276 datasheet 4.1.1.7), with the low data rate
+ * optimization on when a symbol is longer than 16 ms, as `LoRaClass` sets it.
+ */
+inline uint32_t loraAirtime_us(const LoRaSettings& settings, size_t size) {
+    int32_t sf = settings.spreadingFactor;
+    float symbol_us = float(1UL << sf) * 1e6f / settings.bandwidth_Hz;
+    int32_t lowRate = symbol_us > 16000 ? 1 : 0;
+    int32_t bits = 8 * int32_t(size) - 4 * sf + 28 + (settings.crc ? 16 : 0) - (settings.implicitHeader ? 20 : 0);
+    int32_t divisor = 4 * (sf - 2 * lowRate);
+    int32_t blocks = bits > 0 ? (bits + divisor - 1) / divisor : 0;
+    float symbols = settings.preambleLength + 4.25f + 8 + blocks * settings.codingRate4;
+    return uint32_t(symbols * symbol_us + 0.5f);
+}
+
+/**
+ * @brief barometric altitude from pressure
+ * @param pressure_Pa Static pressure
+ * @param seaLevel_hPa Sea level reference, 1013.25 for standard atmosphere
+ *
+ * Same formula as `Adafruit_BMP3XX::readAltitude()`, minus the second bus read.
+ */
+inline float pressureAltitude(float pressure_Pa, float seaLevel_hPa) {
+    return 44330.0 * (1.0 - pow(pressure_Pa / 100.0F / seaLevel_hPa, 0.1903));
+}
+
+#endif
@@ -0,0 +1,199 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <Arduino.h>
+#include "SRAD_PHX_HAL_Adafruit.h"
+#include "SRAD_PHX_Raw.h"
+
+bool LSM_IMU::read(ImuReading& out) {
+    sensors_event_t accel, gyro, temp;
+    if(!driver.getEvent(&accel, &gyro, &temp)) {
+        return false;
+    }
+
+    out.acc_x = accel.acceleration.x;
+    out.acc_y = accel.acceleration.y;
+    out.acc_z = accel.acceleration.z;
+    out.gyro_x = gyro.gyro.x;
+    out.gyro_y = gyro.gyro.y;
+    out.gyro_z = gyro.gyro.z;
+    out.temp = float(temp.temperature);
+    out.raw_temp = driver.rawTemp;
+    return true;
+}
+
+// INT1 stays high until the sample is read, so a missed edge stalls it (the scheduler recovers)
+bool LSM_IMU::enableDataReady() {
+    driver.configIntOutputs(false, false);  // active high, push-pull
+    driver.configInt1(false, false, true);
+    return true;
+}
+
+// one 6 byte burst, where getEvent() reads each axis in its own transfer
+bool ADXL_ACCEL::read(AccelReading& out) {
+    if(!driver.getXYZ(out.raw_acc[0], out.raw_acc[1], out.raw_acc[2])) {
+        return false;
+    }
+
+    out.acc_x = rawAdxlAcc(out.raw_acc[0], RAW_SCALES_ADAFRUIT.adxl_acc);
+    out.acc_y = rawAdxlAcc(out.raw_acc[1], RAW_SCALES_ADAFRUIT.adxl_acc);
+    out.acc_z = rawAdxlAcc(out.raw_acc[2], RAW_SCALES_ADAFRUIT.adxl_acc);
+    out.temp = 0.0f;                        // no sensor, getEvent() leaves it zero too
+    return true;
+}
+
+bool ADXL_ACCEL::enableDataReady() {
+    int_config map = {};                    // 0 routes to INT1
+    int_config enable = {};
+    enable.bits.data_ready = true;
+    return driver.mapInterrupts(map) && driver.enableInterrupts(enable);
+}
+
+// readAltitude() would start two more conversions, altitude comes from this pressure instead
+bool BMP_BARO::read(BaroReading& out) {
+    if(!(continuous ? driver.readLatest() : driver.performReading())) {
+        return false;
+    }
+
+    out.pressure = driver.pressure;
+    out.temp = driver.temperature;
+    return true;
+}
+
+// after this read() only fetches results, the sensor converts at its own output data rate
+bool BMP_BARO::enableDataReady() {
+    continuous = driver.startContinuous(true);
+    return continuous;
+}
+
+/**
+ * @brief one burst over ACC, MAG, GYR, EUL and QUA (0x08 to 0x27), then the temperature
+ *
+ * Two transfers instead of the driver's six, all vectors from the same
+ * output update, and float conversions instead of its double ones.
+ */
+bool BNO_AHRS::read(AhrsReading& out) {
+    const RawScales& scales = RAW_SCALES_ADAFRUIT;
+    uint8_t reg = Adafruit_BNO055::BNO055_ACCEL_DATA_X_LSB_ADDR;
+    uint8_t burst[32];
+    if(!bus.write_then_read(&reg, 1, burst, sizeof(burst))) {
+        return false;
+    }
+    reg = Adafruit_BNO055::BNO055_TEMP_ADDR;
+    uint8_t temp;
+    if(!bus.write_then_read(&reg, 1, &temp, 1)) {
+        return false;
+    }
+
+    int16_t counts[16];
+    for(uint8_t ind = 0; ind < 16; ind++) {
+        counts[ind] = int16_t(burst[2 * ind] | burst[2 * ind + 1] << 8);
+    }
+    const int16_t* acc = counts;            // 0x08
+    const int16_t* mag = counts + 3;        // 0x0E
+    const int16_t* gyro = counts + 6;       // 0x14, then 3 Euler angles
+    const int16_t* quat = counts + 12;      // 0x20
+    for(uint8_t axis = 0; axis < 3; axis++) {
+        out.raw_acc[axis] = acc[axis];
+        out.raw_gyro[axis] = gyro[axis];
+    }
+    for(uint8_t axis = 0; axis < 4; axis++) {
+        out.raw_ori[axis] = quat[axis];
+    }
+    out.raw_temp = int8_t(temp);
+
+    out.ori_w = rawBnoQuat(quat[0], scales.bno_quat);
+    out.ori_x = rawBnoQuat(quat[1], scales.bno_quat);
+    out.ori_y = rawBnoQuat(quat[2], scales.bno_quat);
+    out.ori_z = rawBnoQuat(quat[3], scales.bno_quat);
+    out.gyro_x = rawBnoGyro(gyro[0], scales.bno_gyro);
+    out.gyro_y = rawBnoGyro(gyro[1], scales.bno_gyro);
+    out.gyro_z = rawBnoGyro(gyro[2], scales.bno_gyro);
+    out.acc_x = rawBnoAcc(acc[0], scales.bno_acc);
+    out.acc_y = rawBnoAcc(acc[1], scales.bno_acc);
+    out.acc_z = rawBnoAcc(acc[2], scales.bno_acc);
+    out.mag_x = rawBnoMag(mag[0], scales.bno_mag);
+    out.mag_y = rawBnoMag(mag[1], scales.bno_mag);
+    out.mag_z = rawBnoMag(mag[2], scales.bno_mag);
+    out.temp = float(out.raw_temp);
+    return true;
+}
+
+/**
+ * @brief drains the GPS until a sentence with a fix is parsed
+ * @return Returns `false` if no fix arrived within `timeout_ms`
+ */
+bool NMEA_GPS::read(GpsReading& out) {
+    uint32_t startms = millis();
+
+    while(millis() - startms < timeout_ms) {
+        while(driver.available()) {
+            driver.read();
+            if(!driver.newNMEAreceived() || !driver.parse(driver.lastNMEA())) {
+                continue;
+            }
+
+            out.fix = driver.fix;
+            out.satellites = driver.satellites;
+            out.latitudeDegrees = driver.latitudeDegrees;
+            out.longitudeDegrees = driver.longitudeDegrees;
+            out.speed = driver.speed;
+            out.angle = driver.angle;
+            out.altitude = driver.altitude;
+            if(driver.fix && driver.satellites > 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void LORA_RADIO::configure() {
+    driver.setSpreadingFactor(settings.spreadingFactor);
+    driver.setSignalBandwidth(settings.bandwidth_Hz);
+    driver.setCodingRate4(settings.codingRate4);
+    driver.setPreambleLength(settings.preambleLength);
+    if(settings.crc) {
+        driver.enableCrc();
+    } else {
+        driver.disableCrc();
+    }
+}
+
+// one burst FIFO write, then TX starts and this returns without waiting for it
+bool LORA_RADIO::transmit(const uint8_t* frame, size_t size) {
+    if(!driver.beginPacket(settings.implicitHeader)) {
+        return false;
+    }
+    if(driver.write(frame, size) != size) {
+        return false;
+    }
+    return driver.endPacket(true);
+}
+
+// in standby, so the new settings apply from the next packet on
+bool LORA_RADIO::setModem(const LoRaSettings& modem) {
+    driver.idle();
+    settings = modem;
+    configure();
+    return true;
+}
+
+// parsePacket() drops into single RX when nothing has come in, the next transmit() ends it
+size_t LORA_RADIO::receive(uint8_t* frame, size_t size, LinkQuality& quality) {
+    int length = driver.parsePacket();
+    if(length <= 0) {
+        return 0;
+    }
+    size_t read = driver.readBytes(frame, size_t(length) < size ? size_t(length) : size);
+    quality.rssi_dBm = driver.packetRssi();
+    quality.snr_dB = driver.packetSnr();
+    return read;
+}
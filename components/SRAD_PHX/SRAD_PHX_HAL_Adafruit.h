@@ -0,0 +1,74 @@
+#ifndef SRAD_PHX_HAL_ADAFRUIT_H
+#define SRAD_PHX_HAL_ADAFRUIT_H
+
+#include <Adafruit_Sensor.h>
+#include <Adafruit_GPS.h>
+#include <Adafruit_ADXL375.h>
+#include <Adafruit_BNO055.h>
+#include <Adafruit_BMP3XX.h>
+#include <Adafruit_LSM6DSO32.h>
+#include <Adafruit_I2CDevice.h>
+#include <LoRa.h>
+
+#include "SRAD_PHX_HAL.h"
+
+// Flight backend: each adapter wraps an already initialized driver.
+
+class LSM_IMU : public IMU_DEVICE {
+    public:
+        LSM_IMU(Adafruit_LSM6DSO32& d) : driver(d) {}
+        bool read(ImuReading &) override;
+        bool enableDataReady() override;       // accel data ready on INT1
+        Adafruit_LSM6DSO32& driver;
+};
+
+class ADXL_ACCEL : public ACCEL_DEVICE {
+    public:
+        ADXL_ACCEL(Adafruit_ADXL375& d) : driver(d) {}
+        bool read(AccelReading &) override;
+        bool enableDataReady() override;       // DATA_READY on INT1
+        Adafruit_ADXL375& driver;
+};
+
+class BMP_BARO : public BARO_DEVICE {
+    public:
+        BMP_BARO(Adafruit_BMP3XX& d) : driver(d) {}
+        bool read(BaroReading &) override;
+        bool enableDataReady() override;       // normal mode, INT pulses per conversion
+        Adafruit_BMP3XX& driver;
+        bool continuous = false;
+};
+
+// reads the data registers itself, the driver handle only sets the BNO055 up
+class BNO_AHRS : public AHRS_DEVICE {
+    public:
+        BNO_AHRS(Adafruit_BNO055& d, uint8_t address = BNO055_ADDRESS_A, TwoWire* wire = &Wire)
+        : driver(d), bus(address, wire) {}
+        bool read(AhrsReading &) override;
+        Adafruit_BNO055& driver;
+        Adafruit_I2CDevice bus;     // same chip as the driver's, the driver keeps its own private
+};
+
+class NMEA_GPS : public GPS_DEVICE {
+    public:
+        NMEA_GPS(Adafruit_GPS& d, uint32_t timeout = 150) : driver(d), timeout_ms(timeout) {}
+        bool read(GpsReading &) override;
+        Adafruit_GPS& driver;
+        uint32_t timeout_ms;        // how long read() waits for a fix sentence
+};
+
+// packets start with endPacket(true), so DIO0 rises on TX done for RADIO_LINK
+class LORA_RADIO : public RADIO_DEVICE {
+    public:
+        LORA_RADIO(LoRaClass& d, const LoRaSettings& modem) : driver(d), settings(modem) {}
+        void configure();           // puts `settings` into the driver, after LoRa.begin()
+        bool transmit(const uint8_t* frame, size_t size) override;
+        bool transmitting() override { return driver.isTransmitting(); }
+        uint32_t airtime_us(size_t size) const override { return loraAirtime_us(settings, size); }
+        bool setModem(const LoRaSettings& modem) override;
+        size_t receive(uint8_t* frame, size_t size, LinkQuality& quality) override;
+        LoRaClass& driver;
+        LoRaSettings settings;
+};
+
+#endif
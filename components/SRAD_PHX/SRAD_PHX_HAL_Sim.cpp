@@ -0,0 +1,302 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include "SRAD_PHX_HAL_Sim.h"
+#include "SRAD_PHX_Raw.h"
+#include "SRAD_PHX_Time.h"
+
+static float clampRange(float value, float range) {
+    return value > range ? range : (value < -range ? -range : value);
+}
+
+// the register count a device at `perUnit` counts per unit reports for `value`
+static int16_t toCounts(float value, float perUnit) {
+    return int16_t(clampRange(roundf(value * perUnit), 32767.0f));
+}
+
+/**
+ * @brief advances the flight to a timestamp
+ * @param time_us Microsecond timestamp, earlier times are ignored
+ *
+ * State only changes on whole milliseconds, so results don't depend on
+ * how often this is called.
+ */
+void SIM_TRAJECTORY::update(uint64_t time_us) {
+    while(now_us / 1000 < time_us / 1000) {
+        step(0.001f);
+        now_us = (now_us / 1000 + 1) * 1000;
+    }
+    if(time_us > now_us) {
+        now_us = time_us;
+    }
+}
+
+void SIM_TRAJECTORY::reset() {
+    now_us = 0;
+    height = 0;
+    speed = 0;
+    force = SIM_GRAVITY;
+    landed = false;
+    apogee_us = 0;
+    apogee_m = 0;
+}
+
+void SIM_TRAJECTORY::step(float dt) {
+    if(landed || now_us < launchTime_us) {
+        force = SIM_GRAVITY;
+        return;
+    }
+
+    float accel;
+    bool burning = now_us < launchTime_us + burnTime_us;
+    if(burning || apogee_us == 0) {
+        float thrust = burning ? thrustAccel : 0.0f;
+        accel = thrust - SIM_GRAVITY - dragPerMass * speed * fabsf(speed);
+        speed += accel * dt;
+    } else if(speed - SIM_GRAVITY * dt > -descentRate) {
+        accel = -SIM_GRAVITY;
+        speed += accel * dt;
+    } else {
+        accel = 0;                          // hanging under the parachute
+        speed = -descentRate;
+    }
+    force = accel + SIM_GRAVITY;
+
+    if(apogee_us == 0 && !burning && speed <= 0) {
+        apogee_us = now_us;
+        apogee_m = height;
+    }
+
+    height += speed * dt;
+    if(height <= 0 && apogee_us != 0) {
+        height = 0;
+        speed = 0;
+        force = SIM_GRAVITY;
+        landed = true;
+    }
+}
+
+// xorshift32, the same sequence on every platform
+float SIM_TRAJECTORY::noise() {
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return int32_t(noiseState) / 2147483648.0f;
+}
+
+bool SIM_IMU::read(ImuReading& out) {
+    if(failed) {
+        return false;
+    }
+    const float range = 32 * SIM_GRAVITY;   // LSM6DSO32 at +/-32 g
+    out.acc_x = 0.05f * noiseScale * trajectory.noise();
+    out.acc_y = 0.05f * noiseScale * trajectory.noise();
+    out.acc_z = clampRange(trajectory.specificForce() + 0.05f * noiseScale * trajectory.noise(), range);
+    out.gyro_x = 0.005f * noiseScale * trajectory.noise();
+    out.gyro_y = 0.005f * noiseScale * trajectory.noise();
+    out.gyro_z = 0.005f * noiseScale * trajectory.noise();
+    out.temp = 25.0f;
+    out.raw_temp = 0;
+    return true;
+}
+
+// quantized to whole counts, converted back the way ADXL_ACCEL does
+bool SIM_ACCEL::read(AccelReading& out) {
+    if(failed) {
+        return false;
+    }
+    const float range = 200 * SIM_GRAVITY;  // ADXL375, 49 mg per count
+    const float perMs2 = 1000.0f / (RAW_SCALES_ADAFRUIT.adxl_acc * RAW_GRAVITY);
+    out.raw_acc[0] = toCounts(0.5f * noiseScale * trajectory.noise(), perMs2);
+    out.raw_acc[1] = toCounts(0.5f * noiseScale * trajectory.noise(), perMs2);
+    out.raw_acc[2] = toCounts(clampRange(trajectory.specificForce() + 0.5f * noiseScale * trajectory.noise(), range), perMs2);
+    out.acc_x = rawAdxlAcc(out.raw_acc[0], RAW_SCALES_ADAFRUIT.adxl_acc);
+    out.acc_y = rawAdxlAcc(out.raw_acc[1], RAW_SCALES_ADAFRUIT.adxl_acc);
+    out.acc_z = rawAdxlAcc(out.raw_acc[2], RAW_SCALES_ADAFRUIT.adxl_acc);
+    out.temp = 25.0f;
+    return true;
+}
+
+bool SIM_BARO::read(BaroReading& out) {
+    if(failed) {
+        return false;
+    }
+    float altitude = trajectory.padAltitude_m + trajectory.altitude() + 0.25f * noiseScale * trajectory.noise();
+    out.pressure = 101325.0f * powf(1.0f - altitude / 44330.0f, 1.0f / 0.1903f);
+    out.temp = 15.0f - 0.0065f * altitude;
+    return true;
+}
+
+// counts first, then the floats BNO_AHRS would make of them
+bool SIM_AHRS::read(AhrsReading& out) {
+    if(failed) {
+        return false;
+    }
+    const float range = 16 * SIM_GRAVITY;   // BNO055 at +/-16 g
+    const RawScales& scales = RAW_SCALES_ADAFRUIT;
+    const float perRads = scales.bno_gyro / RAW_DPS_TO_RADS;
+    out.raw_ori[0] = toCounts(1.0f, scales.bno_quat);
+    out.raw_ori[1] = out.raw_ori[2] = out.raw_ori[3] = 0;
+    out.raw_gyro[0] = toCounts(0.002f * noiseScale * trajectory.noise(), perRads);
+    out.raw_gyro[1] = toCounts(0.002f * noiseScale * trajectory.noise(), perRads);
+    out.raw_gyro[2] = toCounts(0.002f * noiseScale * trajectory.noise(), perRads);
+    out.raw_acc[0] = toCounts(0.1f * noiseScale * trajectory.noise(), scales.bno_acc);
+    out.raw_acc[1] = toCounts(0.1f * noiseScale * trajectory.noise(), scales.bno_acc);
+    out.raw_acc[2] = toCounts(clampRange(trajectory.specificForce() + 0.1f * noiseScale * trajectory.noise(), range),
+                              scales.bno_acc);
+    out.raw_temp = 25;
+
+    out.ori_w = rawBnoQuat(out.raw_ori[0], scales.bno_quat);
+    out.ori_x = rawBnoQuat(out.raw_ori[1], scales.bno_quat);
+    out.ori_y = rawBnoQuat(out.raw_ori[2], scales.bno_quat);
+    out.ori_z = rawBnoQuat(out.raw_ori[3], scales.bno_quat);
+    out.gyro_x = rawBnoGyro(out.raw_gyro[0], scales.bno_gyro);
+    out.gyro_y = rawBnoGyro(out.raw_gyro[1], scales.bno_gyro);
+    out.gyro_z = rawBnoGyro(out.raw_gyro[2], scales.bno_gyro);
+    out.acc_x = rawBnoAcc(out.raw_acc[0], scales.bno_acc);
+    out.acc_y = rawBnoAcc(out.raw_acc[1], scales.bno_acc);
+    out.acc_z = rawBnoAcc(out.raw_acc[2], scales.bno_acc);
+    out.mag_x = rawBnoMag(toCounts(24.0f, scales.bno_mag), scales.bno_mag);
+    out.mag_y = 0.0f;
+    out.mag_z = rawBnoMag(toCounts(-42.0f, scales.bno_mag), scales.bno_mag);
+    out.temp = out.raw_temp;
+    return true;
+}
+
+bool SIM_GPS::read(GpsReading& out) {
+    if(failed) {
+        return false;
+    }
+    out.fix = true;
+    out.satellites = 9;
+    out.latitudeDegrees = 32.990253f;
+    out.longitudeDegrees = -106.974983f;
+    out.speed = fabsf(trajectory.velocity()) * 1.943844f;
+    out.angle = 0.0f;
+    out.altitude = trajectory.padAltitude_m + trajectory.altitude();
+    return true;
+}
+
+size_t SIM_STORAGE::write(const uint8_t* buffer, size_t size) {
+    if(capture && written < capacity) {
+        size_t kept = size < capacity - written ? size : capacity - written;
+        memcpy(capture + written, buffer, kept);
+    }
+    written += size;
+    return size;
+}
+
+/**
+ * @brief wraps an image buffer, its contents are kept as they are
+ * @param buffer `size` bytes: fill with 0xFF for blank flash, or load a dump
+ * @param size Image size, whole blocks
+ * @param blockSize Erase block size
+ * @param eraseCounts Optional `size / blockSize` counters, zeroed here
+ */
+SIM_FLASH::SIM_FLASH(uint8_t* buffer, uint32_t size, uint32_t blockSize, uint32_t* eraseCounts)
+: image(buffer), length(size), block(blockSize), blockErases(eraseCounts) {
+    if(blockErases) {
+        memset(blockErases, 0, sizeof(uint32_t) * (length / block));
+    }
+}
+
+bool SIM_FLASH::read(uint32_t offset, void* buffer, uint32_t size) {
+    if(offset + uint64_t(size) > length) {
+        return false;
+    }
+    memcpy(buffer, image + offset, size);
+    readBytes += size;
+    return true;
+}
+
+bool SIM_FLASH::program(uint32_t offset, const void* buffer, uint32_t size) {
+    if(offset + uint64_t(size) > length) {
+        return false;
+    }
+    const uint8_t* bytes = (const uint8_t*)buffer;
+    bool overwrite = false;
+    for(uint32_t ind = 0; ind < size; ind++) {
+        overwrite |= (image[offset + ind] & bytes[ind]) != bytes[ind];
+        image[offset + ind] &= bytes[ind];
+    }
+    overwrites += overwrite;
+    programBytes += size;
+    programs++;
+    return true;
+}
+
+bool SIM_FLASH::erase(uint32_t offset, uint32_t size) {
+    if(offset % block || size % block || offset + uint64_t(size) > length) {
+        return false;
+    }
+    memset(image + offset, 0xFF, size);
+    for(uint32_t first = offset / block; first < (offset + size) / block; first++) {
+        if(blockErases) {
+            blockErases[first]++;
+        }
+        erases++;
+    }
+    return true;
+}
+
+// clears the byte and operation counters, not the per-block erase counts
+void SIM_FLASH::resetCounters() {
+    readBytes = programBytes = 0;
+    programs = erases = overwrites = 0;
+}
+
+bool SIM_RADIO::transmit(const uint8_t* frame, size_t size) {
+    if(down || size == 0 || size > 255 || transmitting()) {
+        return false;
+    }
+    uint32_t airtime = airtime_us(size);
+    inboxLength = 0;
+    txStart_us = nowMicros();
+    txAirtime_us = airtime;
+    if(receiver) {
+        receiver->write(uint8_t(size));
+        receiver->write(frame, size);
+    }
+    frames++;
+    bytes += size;
+    onAir_us += airtime;
+    return true;
+}
+
+bool SIM_RADIO::transmitting() {
+    // a clock that went back (a reset in host tools) ends it
+    return nowMicros() - txStart_us < txAirtime_us;
+}
+
+size_t SIM_RADIO::receive(uint8_t* frame, size_t size, LinkQuality& quality) {
+    if(!inboxLength || nowMicros() < inboxAt_us || transmitting()) {
+        return 0;
+    }
+    size_t length = inboxLength < size ? inboxLength : size;
+    memcpy(frame, inbox, length);
+    quality = inboxQuality;
+    inboxLength = 0;
+    return length;
+}
+
+/**
+ * @brief queues a packet for `receive()`, replacing any still waiting
+ * @param frame Payload as the ground sent it
+ * @param size Its length, at most 255
+ * @param quality How it is heard
+ * @param at_us `nowMicros()` its last byte arrives at
+ */
+void SIM_RADIO::deliver(const uint8_t* frame, size_t size, const LinkQuality& quality, uint64_t at_us) {
+    inboxLength = size < sizeof(inbox) ? size : sizeof(inbox);
+    memcpy(inbox, frame, inboxLength);
+    inboxQuality = quality;
+    inboxAt_us = at_us;
+}
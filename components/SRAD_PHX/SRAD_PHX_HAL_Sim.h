@@ -0,0 +1,193 @@
+#ifndef SRAD_PHX_HAL_SIM_H
+#define SRAD_PHX_HAL_SIM_H
+
+#include "SRAD_PHX_HAL.h"
+
+#define SIM_GRAVITY 9.80665f
+
+/**
+ * @brief deterministic vertical flight the simulated devices sample
+ *
+ * Pad, constant-thrust boost with quadratic drag, coast to apogee, then a
+ * parachute descent at constant rate until touchdown. `update()` steps the
+ * model to a timestamp in 1 ms increments, so the same timestamps always
+ * give the same flight on any platform.
+ */
+class SIM_TRAJECTORY {
+    public:
+        float padAltitude_m = 30.0f;        // above sea level
+        uint64_t launchTime_us = 5000000;   // time the motor lights
+        uint32_t burnTime_us = 2500000;
+        float thrustAccel = 120.0f;         // m/s^2 from the motor alone
+        float dragPerMass = 0.0004f;        // 1/m, drag acceleration = k * v^2
+        float descentRate = 20.0f;          // m/s under parachute
+
+        void update(uint64_t time_us);
+        void reset();
+
+        uint64_t time_us() const { return now_us; }
+        float altitude() const { return height; }           // above the pad
+        float velocity() const { return speed; }
+        float specificForce() const { return force; }       // what a vertical accelerometer reads
+        bool hasLanded() const { return landed; }
+        uint64_t apogeeTime_us() const { return apogee_us; }    // 0 until apogee
+        float apogeeAltitude() const { return apogee_m; }
+
+        float noise();                                      // uniform in [-1, 1], repeatable
+
+    private:
+        void step(float dt);
+
+        uint64_t now_us = 0;
+        float height = 0, speed = 0, force = SIM_GRAVITY;
+        bool landed = false;
+        uint64_t apogee_us = 0;
+        float apogee_m = 0;
+        uint32_t noiseState = 0x2545F491;
+};
+
+// every simulated device can be failed on demand to exercise the fallbacks
+class SIM_DEVICE {
+    public:
+        SIM_DEVICE(SIM_TRAJECTORY& t) : trajectory(t) {}
+        SIM_TRAJECTORY& trajectory;
+        bool failed = false;
+        float noiseScale = 1.0f;            // multiplies each device's datasheet-ish noise
+};
+
+class SIM_IMU : public IMU_DEVICE, public SIM_DEVICE {
+    public:
+        SIM_IMU(SIM_TRAJECTORY& t) : SIM_DEVICE(t) {}
+        bool read(ImuReading &) override;
+};
+
+class SIM_ACCEL : public ACCEL_DEVICE, public SIM_DEVICE {
+    public:
+        SIM_ACCEL(SIM_TRAJECTORY& t) : SIM_DEVICE(t) {}
+        bool read(AccelReading &) override;
+};
+
+class SIM_BARO : public BARO_DEVICE, public SIM_DEVICE {
+    public:
+        SIM_BARO(SIM_TRAJECTORY& t) : SIM_DEVICE(t) {}
+        bool read(BaroReading &) override;
+};
+
+class SIM_AHRS : public AHRS_DEVICE, public SIM_DEVICE {
+    public:
+        SIM_AHRS(SIM_TRAJECTORY& t) : SIM_DEVICE(t) {}
+        bool read(AhrsReading &) override;
+};
+
+class SIM_GPS : public GPS_DEVICE, public SIM_DEVICE {
+    public:
+        SIM_GPS(SIM_TRAJECTORY& t) : SIM_DEVICE(t) {}
+        bool read(GpsReading &) override;
+};
+
+/**
+ * @brief log sink that counts bytes, optionally keeping the first ones
+ *
+ * Stands in for an SD `File` or serial port when only the formatting cost
+ * or the output itself matters.
+ */
+class SIM_STORAGE : public Print {
+    public:
+        SIM_STORAGE(uint8_t* buffer = nullptr, size_t size = 0) : capture(buffer), capacity(size) {}
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+        void flush() override { flushes++; }
+
+        void reset() { written = 0; flushes = 0; }
+        size_t bytesWritten() const { return written; }
+        uint32_t flushCount() const { return flushes; }
+
+    private:
+        uint8_t* capture;
+        size_t capacity;
+        size_t written = 0;
+        uint32_t flushes = 0;
+};
+
+/**
+ * @brief NOR flash in a caller-provided buffer, counting what a file system does to it
+ *
+ * Holds `size` bytes of image, 0xFF when erased. Programming a bit back
+ * to 1 without an erase is what real flash silently ignores; it is ANDed
+ * in the same way and counted in `badPrograms()`. Pass `eraseCounts` (one
+ * per block) to see how evenly the erases spread.
+ */
+class SIM_FLASH : public FLASH_DEVICE {
+    public:
+        SIM_FLASH(uint8_t* image, uint32_t size, uint32_t blockSize = 4096, uint32_t* eraseCounts = nullptr);
+
+        uint32_t size() const override { return length; }
+        uint32_t blockSize() const override { return block; }
+        bool read(uint32_t offset, void* buffer, uint32_t size) override;
+        bool program(uint32_t offset, const void* buffer, uint32_t size) override;
+        bool erase(uint32_t offset, uint32_t size) override;
+
+        void resetCounters();
+        uint64_t bytesRead() const { return readBytes; }
+        uint64_t bytesProgrammed() const { return programBytes; }
+        uint32_t programCount() const { return programs; }
+        uint32_t eraseCount() const { return erases; }
+        uint32_t badPrograms() const { return overwrites; }
+
+    private:
+        uint8_t* image;
+        uint32_t length;
+        uint32_t block;
+        uint32_t* blockErases;
+        uint64_t readBytes = 0, programBytes = 0;
+        uint32_t programs = 0, erases = 0, overwrites = 0;
+};
+
+/**
+ * @brief LoRa radio that is on air for each frame's computed airtime
+ *
+ * `transmit()` refuses a frame until the previous one's
+ * `loraAirtime_us()` has passed on `nowMicros()`. Sent frames go to the
+ * optional `ground` sink, each behind a one byte length, the way a
+ * receiver that logs whole packets would store them.
+ *
+ * `deliver()` plays the ground's reply: `receive()` hands it over once its
+ * time has come. Like a real radio leaving RX, `transmit()` loses a reply
+ * nobody picked up.
+ */
+class SIM_RADIO : public RADIO_DEVICE {
+    public:
+        SIM_RADIO(const LoRaSettings& modem, Print* ground = nullptr) : settings(modem), receiver(ground) {}
+
+        bool transmit(const uint8_t* frame, size_t size) override;
+        bool transmitting() override;
+        uint32_t airtime_us(size_t size) const override { return loraAirtime_us(settings, size); }
+        bool setModem(const LoRaSettings& modem) override { settings = modem; return true; }
+        size_t receive(uint8_t* frame, size_t size, LinkQuality& quality) override;
+
+        void deliver(const uint8_t* frame, size_t size, const LinkQuality& quality, uint64_t at_us);
+        void fail(bool failed = true) { down = failed; }
+        void resetCounters() { frames = 0; bytes = 0; onAir_us = 0; }
+        uint32_t framesSent() const { return frames; }
+        uint64_t bytesSent() const { return bytes; }
+        uint64_t timeOnAir_us() const { return onAir_us; }
+
+        LoRaSettings settings;
+
+    private:
+        Print* receiver;
+        uint64_t txStart_us = 0;
+        uint32_t txAirtime_us = 0;
+        bool down = false;
+        uint32_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t onAir_us = 0;
+        uint8_t inbox[255];
+        size_t inboxLength = 0;             // 0: nothing waiting
+        LinkQuality inboxQuality;
+        uint64_t inboxAt_us = 0;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef SRAD_PHX_HISTOGRAM_H
+#define SRAD_PHX_HISTOGRAM_H
+
+#include <stdint.h>
+
+#define HISTOGRAM_BUCKETS 33    // 0, then one per power of two up to 2^32
+
+/**
+ * @brief fixed-bucket log2 histogram of unsigned durations
+ *
+ * Bucket 0 holds zeros, bucket n holds values in [2^(n-1), 2^n).
+ * `record()` is a few instructions and never allocates, so it can stay
+ * enabled in flight. Exact min, max and mean are kept alongside.
+ */
+class HISTOGRAM {
+    public:
+        HISTOGRAM() { reset(); }
+
+        void record(uint32_t value) {
+            uint8_t bucket = value == 0 ? 0 : 32 - __builtin_clz(value);
+            counts[bucket]++;
+            total++;
+            sum += value;
+            if(value < minimum) {
+                minimum = value;
+            }
+            if(value > maximum) {
+                maximum = value;
+            }
+        }
+
+        void reset() {
+            for(uint8_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+                counts[bucket] = 0;
+            }
+            total = 0;
+            sum = 0;
+            minimum = UINT32_MAX;
+            maximum = 0;
+        }
+
+        uint32_t count() const { return total; }
+        uint32_t min() const { return total ? minimum : 0; }
+        uint32_t max() const { return maximum; }
+        uint64_t sumOf() const { return sum; }
+        float mean() const { return total ? float(sum) / total : 0.0f; }
+        uint32_t bucketCount(uint8_t bucket) const { return counts[bucket]; }
+
+        // smallest value that lands in a bucket
+        static uint32_t bucketLow(uint8_t bucket) {
+            return bucket == 0 ? 0 : 1u << (bucket - 1);
+        }
+
+        /**
+         * @brief upper bound of the bucket holding the given percentile
+         * @param percent 0-100
+         * @return Returns a value no sample in that fraction exceeds, capped at max()
+         */
+        uint32_t percentile(float percent) const {
+            uint32_t target = uint32_t(total * percent / 100.0f + 0.5f);
+            uint32_t seen = 0;
+            for(uint8_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+                seen += counts[bucket];
+                if(seen >= target && seen > 0) {
+                    uint32_t high = bucket == 32 ? UINT32_MAX : (1u << bucket) - 1;
+                    return high < maximum ? high : maximum;
+                }
+            }
+            return maximum;
+        }
+
+    private:
+        uint32_t counts[HISTOGRAM_BUCKETS];
+        uint32_t total;
+        uint64_t sum;
+        uint32_t minimum;
+        uint32_t maximum;
+};
+
+#endif
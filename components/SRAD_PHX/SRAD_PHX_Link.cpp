@@ -0,0 +1,359 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+#include <esp_rom_crc.h>
+
+#include "SRAD_PHX_Link.h"
+
+float linkNoiseFloor(uint32_t bandwidth_Hz) {
+    return -174.0f + 10.0f * log10f(float(bandwidth_Hz)) + LINK_NOISE_FIGURE_DB;
+}
+
+float linkSignal(const LinkQuality& heard, uint8_t heardOn) {
+    float noise = linkNoiseFloor(LINK_PROFILES[heardOn].modem.bandwidth_Hz);
+    float snr = heard.snr_dB;
+    if(snr >= 0 && heard.rssi_dBm - noise > snr) {
+        snr = heard.rssi_dBm - noise;
+    }
+    return noise + snr;
+}
+
+float linkMargin(float signal_dBm, uint8_t profile) {
+    const LinkProfile& judged = LINK_PROFILES[profile];
+    return signal_dBm - linkNoiseFloor(judged.modem.bandwidth_Hz) - judged.snrFloor_dB;
+}
+
+static size_t sealFrame(uint8_t* out, size_t size) {
+    uint16_t crc = esp_rom_crc16_le(0, out, size - 2);
+    out[size - 2] = crc & 0xFF;
+    out[size - 1] = crc >> 8;
+    return size;
+}
+
+static bool frameIntact(const uint8_t* frame, size_t size, uint8_t type, size_t expected) {
+    if(size != expected || frame[0] != type) {
+        return false;
+    }
+    uint16_t crc = esp_rom_crc16_le(0, frame, size - 2);
+    return frame[size - 2] == (crc & 0xFF) && frame[size - 1] == (crc >> 8);
+}
+
+/**
+ * @brief packs a poll
+ * @param profile Profile it is sent on
+ * @param next Profile both ends use after the report, `profile` to stay
+ * @param out At least LINK_POLL_BYTES
+ * @return Returns LINK_POLL_BYTES
+ */
+size_t linkEncodePoll(uint8_t profile, uint8_t next, uint8_t* out) {
+    out[0] = LINK_FRAME_POLL;
+    out[1] = profile;
+    out[2] = next;
+    return sealFrame(out, LINK_POLL_BYTES);
+}
+
+bool linkDecodePoll(const uint8_t* frame, size_t size, uint8_t& profile, uint8_t& next) {
+    if(!frameIntact(frame, size, LINK_FRAME_POLL, LINK_POLL_BYTES)
+       || frame[1] >= LINK_PROFILE_COUNT || frame[2] >= LINK_PROFILE_COUNT) {
+        return false;
+    }
+    profile = frame[1];
+    next = frame[2];
+    return true;
+}
+
+/**
+ * @brief packs the answer to a poll
+ * @param heardOn Profile the poll came in on
+ * @param next The poll's `next`, what the ground moves to
+ * @param packets Packets heard on `heardOn` since the last report, the poll included
+ * @param heard Their mean; SNR in quarter dB, RSSI in whole dBm
+ * @param out At least LINK_REPORT_BYTES
+ * @return Returns LINK_REPORT_BYTES
+ */
+size_t linkEncodeReport(uint8_t heardOn, uint8_t next, uint8_t packets, const LinkQuality& heard, uint8_t* out) {
+    float snr = roundf(heard.snr_dB * 4);
+    int16_t rssi = int16_t(lroundf(heard.rssi_dBm));
+    out[0] = LINK_FRAME_REPORT;
+    out[1] = heardOn;
+    out[2] = next;
+    out[3] = packets;
+    out[4] = uint8_t(int8_t(snr < -128 ? -128 : (snr > 127 ? 127 : snr)));
+    out[5] = uint16_t(rssi) & 0xFF;
+    out[6] = uint16_t(rssi) >> 8;
+    return sealFrame(out, LINK_REPORT_BYTES);
+}
+
+bool linkDecodeReport(const uint8_t* frame, size_t size, uint8_t& heardOn, uint8_t& next, uint8_t& packets,
+                      LinkQuality& heard) {
+    if(!frameIntact(frame, size, LINK_FRAME_REPORT, LINK_REPORT_BYTES)
+       || frame[1] >= LINK_PROFILE_COUNT || frame[2] >= LINK_PROFILE_COUNT) {
+        return false;
+    }
+    heardOn = frame[1];
+    next = frame[2];
+    packets = frame[3];
+    heard.snr_dB = int8_t(frame[4]) / 4.0f;
+    heard.rssi_dBm = int16_t(frame[5] | (frame[6] << 8));
+    return true;
+}
+
+/**
+ * @brief starts on LINK_HOME
+ * @param pollInterval_ms Time from one answered poll to the next
+ * @param lostTimeout_ms Time without a report before going back to LINK_HOME
+ */
+LINK_ADAPTER::LINK_ADAPTER(uint32_t pollInterval_ms, uint32_t lostTimeout_ms)
+    : pollInterval_us(uint64_t(pollInterval_ms) * 1000), lostTimeout_us(uint64_t(lostTimeout_ms) * 1000) {
+    LinkStats& update = stats.beginWrite();
+    update = {};
+    update.profile = profile;
+    stats.endWrite();
+}
+
+/**
+ * @brief sets when to change profile
+ * @param down Margin under which to step down
+ * @param target Margin to step down to
+ * @param up Margin a faster profile needs before stepping up to it
+ * @param reports Reports in a row it needs it for
+ * @param delivered Share of the packets heard under which to step down
+ */
+void LINK_ADAPTER::setMargins(float down, float target, float up, uint8_t reports, float delivered) {
+    down_dB = down;
+    target_dB = target;
+    up_dB = up;
+    upReports = reports ? reports : 1;
+    minDelivered = delivered;
+}
+
+bool LINK_ADAPTER::pollDue(uint64_t now_us) const {
+    return !polledOnce || (!awaiting && (retry || now_us - exchangeEnd_us >= pollInterval_us));
+}
+
+/**
+ * @brief packs the next poll, which proposes the profile the last reports call for
+ * @param now_us Time it goes out
+ * @param out At least LINK_POLL_BYTES
+ * @return Returns LINK_POLL_BYTES
+ */
+size_t LINK_ADAPTER::poll(uint64_t now_us, uint8_t* out) {
+    if(!polledOnce) {
+        lastReport_us = now_us;             // the lost timeout counts from the first poll
+    }
+    polledOnce = true;
+    awaiting = true;
+    retry = false;
+    asked = next;
+    sentSince++;
+    LinkStats& update = stats.beginWrite();
+    update.polls++;
+    stats.endWrite();
+    return linkEncodePoll(profile, asked, out);
+}
+
+/**
+ * @brief takes the ground's answer to the last poll
+ * @param frame Packet heard while listening
+ * @param size Its length
+ * @param now_us Time it was heard
+ * @return Returns `false` if the packet is not the answer to the last poll; retune if `getProfile()` changed
+ */
+bool LINK_ADAPTER::report(const uint8_t* frame, size_t size, uint64_t now_us) {
+    uint8_t heardOn, agreed, packets;
+    LinkQuality heard;
+    if(!linkDecodeReport(frame, size, heardOn, agreed, packets, heard) || heardOn != profile || agreed != asked) {
+        return false;
+    }
+    awaiting = false;
+    exchangeEnd_us = lastReport_us = now_us;
+    missedInRow = 0;
+    float delivered = sentSince > packets ? float(packets) / sentSince : 1.0f;
+    sentSince = 0;
+    float heardSignal = linkSignal(heard, heardOn);
+    signal_dBm = heardOnce ? signal_dBm + LINK_SMOOTHING * (heardSignal - signal_dBm) : heardSignal;
+    heardOnce = true;
+
+    retry = agreed != profile;              // the ground looks for the next poll on both
+    moveTo(agreed, false);
+    LinkStats& update = stats.beginWrite();
+    update.reports++;
+    update.margin_dB = linkMargin(signal_dBm, profile);
+    update.delivered = delivered;
+    stats.endWrite();
+    if(!retry) {
+        choose(delivered);                  // a change is judged on its own packets
+    }
+    return true;
+}
+
+/**
+ * @brief the last poll went unanswered
+ * @param now_us Time the reply window closed
+ * @return Returns `true` if the ground counts as lost and the profile went back to LINK_HOME
+ */
+bool LINK_ADAPTER::missed(uint64_t now_us) {
+    awaiting = false;
+    exchangeEnd_us = now_us;
+    LinkStats& update = stats.beginWrite();
+    update.missed++;
+    stats.endWrite();
+
+    if(now_us - lastReport_us >= lostTimeout_us && profile != LINK_HOME) {
+        moveTo(LINK_HOME, true);
+        next = LINK_HOME;
+        upCount = 0;
+        missedInRow = 0;
+        heardOnce = false;
+        retry = false;
+        return true;
+    }
+    if(heardOnce) {
+        retry = true;                       // not with nobody heard yet, that would crowd out the telemetry
+        if(++missedInRow >= 2 && next < LINK_HOME && next <= profile) {
+            next = profile + 1;
+            upCount = 0;
+        }
+    }
+    return false;
+}
+
+void LINK_ADAPTER::choose(float delivered) {
+    uint8_t safe = LINK_HOME, fast = LINK_HOME;
+    for(uint8_t candidate = LINK_HOME + 1; candidate-- > 0;) {
+        float margin = linkMargin(signal_dBm, candidate);
+        if(margin >= target_dB) {
+            safe = candidate;
+        }
+        if(margin >= up_dB) {
+            fast = candidate;
+        }
+    }
+
+    next = profile;
+    if(delivered < minDelivered || linkMargin(signal_dBm, profile) < down_dB) {
+        next = safe > profile ? safe : (profile < LINK_HOME ? profile + 1 : profile);
+        upCount = 0;
+    } else if(fast < profile && delivered >= 0.9f) {
+        if(++upCount >= upReports) {
+            next = fast;
+            upCount = 0;
+        }
+    } else {
+        upCount = 0;
+    }
+}
+
+void LINK_ADAPTER::moveTo(uint8_t newProfile, bool fallback) {
+    if(newProfile == profile) {
+        return;
+    }
+    LinkStats& update = stats.beginWrite();
+    if(fallback) {
+        update.fallbacks++;
+    } else if(newProfile < profile) {
+        update.stepsUp++;
+    } else {
+        update.stepsDown++;
+    }
+    update.profile = newProfile;
+    stats.endWrite();
+    profile = newProfile;
+    sentSince = 0;
+}
+
+/**
+ * @brief prints the profile, polls answered and profile changes
+ * @param output Print to write to
+ */
+void LINK_ADAPTER::printStats(Print& output) {
+    LinkStats current = getStats();
+    const LoRaSettings& modem = LINK_PROFILES[current.profile].modem;
+    output.print("link: SF"); output.print(modem.spreadingFactor);
+    output.print("/"); output.print(modem.bandwidth_Hz / 1000);
+    output.print(" kHz, polls "); output.print(current.polls);
+    output.print(", answered "); output.print(current.reports);
+    output.print(", missed "); output.print(current.missed);
+    output.print(", margin "); output.print(current.margin_dB, 1);
+    output.print(" dB, delivered "); output.print(current.delivered * 100, 0);
+    output.println("%");
+    output.print("link: steps up "); output.print(current.stepsUp);
+    output.print(", down "); output.print(current.stepsDown);
+    output.print(", fallbacks "); output.println(current.fallbacks);
+}
+
+/**
+ * @brief takes one packet heard on the current profile
+ * @param frame As received
+ * @param size Its length
+ * @param heard Its RSSI and SNR
+ * @param now_us Time it was heard
+ * @param reply At least LINK_REPORT_BYTES
+ * @return Returns the length of the report to send back if it was a poll, otherwise 0
+ */
+size_t LINK_FOLLOWER::received(const uint8_t* frame, size_t size, const LinkQuality& heard, uint64_t now_us,
+                               uint8_t* reply) {
+    lastHeard_us = now_us;
+    searching = false;                      // the flight side is on this profile
+    heardSince++;
+    snrSum += heard.snr_dB;
+    rssiSum += heard.rssi_dBm;
+    uint8_t polledOn, next;
+    if(!linkDecodePoll(frame, size, polledOn, next) || polledOn != profile) {
+        return 0;
+    }
+    pending = next;
+    LinkQuality mean = {rssiSum / heardSince, snrSum / heardSince};
+    return linkEncodeReport(profile, next, uint8_t(heardSince < 255 ? heardSince : 255), mean, reply);
+}
+
+/**
+ * @brief the report is out: moves to the profile it agreed to
+ * @param now_us Time the report finished
+ * @return Returns `true` if that changed it
+ */
+bool LINK_FOLLOWER::replied(uint64_t now_us) {
+    heardSince = 0;
+    snrSum = rssiSum = 0;
+    if(pending == profile) {
+        return false;
+    }
+    // long enough for a poll on the new profile, or a retry on the old one after the report was missed
+    const LoRaSettings& before = LINK_PROFILES[profile].modem;
+    dwell_us = loraAirtime_us(before, LINK_POLL_BYTES) + loraAirtime_us(before, LINK_REPORT_BYTES)
+             + LINK_TURNAROUND_US + loraAirtime_us(LINK_PROFILES[pending].modem, LINK_POLL_BYTES);
+    previous = profile;
+    profile = pending;
+    searching = true;
+    searchSwap_us = now_us + dwell_us;
+    return true;
+}
+
+/**
+ * @brief goes back and forth while looking for the flight side after a change, and back to LINK_HOME once it is silent
+ * @param now_us Time now
+ * @return Returns `true` if the profile changed
+ */
+bool LINK_FOLLOWER::update(uint64_t now_us) {
+    if(profile != LINK_HOME && now_us - lastHeard_us >= silence_us) {
+        profile = pending = LINK_HOME;
+        searching = false;
+        return true;
+    }
+    if(!searching || now_us < searchSwap_us) {
+        return false;
+    }
+    uint8_t other = previous;
+    previous = profile;
+    profile = other;
+    searchSwap_us = now_us + dwell_us;
+    return true;
+}
@@ -0,0 +1,201 @@
+#ifndef SRAD_PHX_LINK_H
+#define SRAD_PHX_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Print.h>
+
+#include "SRAD_PHX_HAL.h"
+#include "SRAD_PHX_Seqlock.h"
+
+// Link adaptation, see README "Link adaptation". Both ends start on
+// LINK_HOME, the most robust profile, and change profile together:
+//
+//   flight: 'P' poll     profile u8  next u8                                 CRC16
+//   ground: 'K' report   heardOn u8  next u8  heard u8  snr i8  rssi i16     CRC16
+//
+// The flight side polls on its profile and listens for the report. The
+// ground answers on the same profile with how many packets it heard
+// there since its last report, the poll included, and their mean SNR and
+// RSSI; then both use `next`. A lost report leaves the flight side where
+// it was, and the ground looks for it on both. A side that hears nothing
+// from the other for a while goes back to LINK_HOME, where they meet
+// again.
+
+#define LINK_FRAME_POLL 'P'
+#define LINK_FRAME_REPORT 'K'
+#define LINK_POLL_BYTES 5
+#define LINK_REPORT_BYTES 9
+
+#define LINK_NOISE_FIGURE_DB 6.0f   // SX127x receiver, on top of the -174 dBm/Hz thermal floor
+#define LINK_SMOOTHING 0.5f         // weight of a report in the signal estimate
+#define LINK_TURNAROUND_US 50000    // ground's RX to TX and decoding, on top of the report's airtime
+
+struct LinkProfile {
+    LoRaSettings modem;
+    float snrFloor_dB;              // lowest SNR the spreading factor demodulates, SX1276 datasheet table 13
+};
+
+// fastest first, each one step more robust than the one before
+inline constexpr LinkProfile LINK_PROFILES[] = {
+    {{7, 500000, 5, 8, true, false}, -7.5f},
+    {{7, 250000, 5, 8, true, false}, -7.5f},
+    {{7, 125000, 5, 8, true, false}, -7.5f},
+    {{8, 125000, 5, 8, true, false}, -10.0f},
+    {{9, 125000, 5, 8, true, false}, -12.5f},
+    {{10, 125000, 5, 8, true, false}, -15.0f},
+    {{11, 125000, 5, 8, true, false}, -17.5f},
+    {{12, 125000, 5, 8, true, false}, -20.0f},
+};
+
+#define LINK_PROFILE_COUNT uint8_t(sizeof(LINK_PROFILES) / sizeof(LINK_PROFILES[0]))
+#define LINK_HOME uint8_t(LINK_PROFILE_COUNT - 1)
+
+/**
+ * @brief noise a receiver sees in a bandwidth
+ * @param bandwidth_Hz Modem bandwidth
+ * @return Returns dBm
+ */
+float linkNoiseFloor(uint32_t bandwidth_Hz);
+
+/**
+ * @brief signal power packets arrived with
+ * @param heard RSSI and SNR of the packets
+ * @param heardOn Profile they were heard on
+ * @return Returns dBm
+ *
+ * The SNR over the noise floor while the SNR is negative, where the
+ * packet RSSI is mostly noise, and the RSSI above it, where the SX127x
+ * SNR flattens out.
+ */
+float linkSignal(const LinkQuality& heard, uint8_t heardOn);
+
+/**
+ * @brief margin a signal has on a profile
+ * @param signal_dBm From linkSignal()
+ * @param profile Profile to judge
+ * @return Returns dB above `profile`'s demodulation floor, below 0 if packets would be lost
+ */
+float linkMargin(float signal_dBm, uint8_t profile);
+
+size_t linkEncodePoll(uint8_t profile, uint8_t next, uint8_t* out);
+bool linkDecodePoll(const uint8_t* frame, size_t size, uint8_t& profile, uint8_t& next);
+size_t linkEncodeReport(uint8_t heardOn, uint8_t next, uint8_t packets, const LinkQuality& heard, uint8_t* out);
+bool linkDecodeReport(const uint8_t* frame, size_t size, uint8_t& heardOn, uint8_t& next, uint8_t& packets,
+                      LinkQuality& heard);
+
+struct LinkStats {
+    uint32_t polls;                 // sent
+    uint32_t reports;               // answered polls
+    uint32_t missed;                // polls nobody answered
+    uint32_t stepsUp;               // to a faster profile
+    uint32_t stepsDown;             // to a more robust one, fallbacks not counted
+    uint32_t fallbacks;             // to LINK_HOME after losing the ground
+    uint8_t profile;
+    float margin_dB;                // of the signal estimate, on the current profile
+    float delivered;                // share of the packets the last report counted
+};
+
+/**
+ * @brief flight side: picks the profile from the ground's reports
+ *
+ * Each report gives the share of the packets sent since the last one
+ * that the ground heard, and moves the estimate of the signal at the
+ * ground LINK_SMOOTHING of the way to theirs. The next poll proposes:
+ *
+ * - under `minDelivered` of the packets heard, or `down_dB` of margin: the
+ *   fastest profile with `target_dB`, at least one step down, at once
+ * - nearly all heard and a faster profile with `up_dB`, `upReports`
+ *   reports in a row: that profile
+ * - otherwise the current one
+ *
+ * The mean SNR only counts packets that made it, so it reads high on a
+ * failing link; the share heard does not. A missed poll is polled again
+ * at once, on the same profile: the ground looks for it there if the
+ * report was lost. Two in a row propose one profile more robust. A change
+ * is polled at once too, to check the new profile. No report for
+ * `lostTimeout_ms` goes back to LINK_HOME without asking.
+ *
+ * Radio side only, e.g. through `RADIO_LINK::setAdapter()`; `getStats()`
+ * can be called from anywhere.
+ */
+class LINK_ADAPTER {
+    public:
+        LINK_ADAPTER(uint32_t pollInterval_ms = 1000, uint32_t lostTimeout_ms = 3000);
+
+        void setMargins(float down, float target, float up, uint8_t reports, float minDelivered = 0.5f);
+
+        uint8_t getProfile() const { return profile; }
+        const LoRaSettings& getModem() const { return LINK_PROFILES[profile].modem; }
+
+        bool pollDue(uint64_t now_us) const;
+        size_t poll(uint64_t now_us, uint8_t* out);
+        void sent() { sentSince++; }
+        bool report(const uint8_t* frame, size_t size, uint64_t now_us);
+        bool missed(uint64_t now_us);
+
+        LinkStats getStats() const { return stats.read(); }
+        void printStats(Print &);
+
+    private:
+        void choose(float delivered);
+        void moveTo(uint8_t newProfile, bool fallback);
+
+        uint64_t pollInterval_us, lostTimeout_us;
+        float down_dB = 0.0f, target_dB = 2.0f, up_dB = 3.0f;
+        float minDelivered = 0.5f;
+        uint8_t upReports = 1;
+
+        uint8_t profile = LINK_HOME;
+        uint8_t next = LINK_HOME;           // proposed by the next poll
+        uint8_t asked = LINK_HOME;          // by the poll on air
+        uint8_t upCount = 0;
+        uint8_t missedInRow = 0;
+        uint32_t sentSince = 0;             // packets on `profile` since the last report
+        float signal_dBm = 0;
+        bool heardOnce = false;             // `signal_dBm` holds an estimate
+        bool polledOnce = false;
+        bool awaiting = false;              // a poll went out, no report or miss yet
+        bool retry = false;                 // the next poll is due now
+        uint64_t exchangeEnd_us = 0;
+        uint64_t lastReport_us = 0;
+        SEQLOCK<LinkStats> stats;
+};
+
+/**
+ * @brief ground side: answers polls and follows the flight side's profile
+ *
+ * Hand every packet heard to `received()`. When it returns a report,
+ * send it on the current modem, then call `replied()` and retune to
+ * `getModem()`. Call `update()` often and retune when it returns `true`.
+ *
+ * After a change it listens on the new profile until it hears the flight
+ * side there; if the report was lost, the flight side polls again on the
+ * old one, so it goes back and forth between the two until it hears it on
+ * either. After `silence_ms` without a packet it goes back to LINK_HOME.
+ */
+class LINK_FOLLOWER {
+    public:
+        LINK_FOLLOWER(uint32_t silence_ms = 2500) : silence_us(uint64_t(silence_ms) * 1000) {}
+
+        uint8_t getProfile() const { return profile; }
+        const LoRaSettings& getModem() const { return LINK_PROFILES[profile].modem; }
+
+        size_t received(const uint8_t* frame, size_t size, const LinkQuality& heard, uint64_t now_us, uint8_t* reply);
+        bool replied(uint64_t now_us);
+        bool update(uint64_t now_us);
+
+    private:
+        uint64_t silence_us;
+        uint64_t lastHeard_us = 0;
+        uint8_t profile = LINK_HOME;
+        uint8_t pending = LINK_HOME;        // `next` of the poll being answered
+        uint8_t previous = LINK_HOME;       // to look on too until the flight side is heard
+        uint32_t heardSince = 0;            // packets since the last report, and their sums
+        float snrSum = 0, rssiSum = 0;
+        bool searching = false;
+        uint64_t dwell_us = 0;              // on each while searching
+        uint64_t searchSwap_us = 0;         // when to try the other one
+};
+
+#endif
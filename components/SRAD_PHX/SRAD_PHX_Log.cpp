@@ -0,0 +1,351 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include <math.h>
+#include <utility>
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_Fields.h"
+#include "SRAD_PHX_Log.h"
+#include "SRAD_PHX_Text.h"
+
+constexpr uint8_t LOG_ENCODING_BYTES[8] = {1, 2, 8, 4, 2, 3, 1, 2};
+
+// 'S' and 'R' are generated from TELEMETRY_FIELDS: time_us, the flags word,
+// then every FIELD_SD field with an encoding, in column order
+static constexpr size_t LOGGED_FIELDS = [] {
+    size_t count = 0;
+    for(const TelemetryField& field : TELEMETRY_FIELDS) {
+        count += field.encoding != FIELD_NOT_LOGGED;
+    }
+    return count + 1;
+}();
+
+struct LogSchema {
+    LogField fields[LOGGED_FIELDS];
+    uint16_t size;                  // of the record, type byte included
+};
+
+// `raw` puts each field's count in its place, LOG_FORMAT_RAW's 'R'
+static constexpr LogSchema makeSchema(bool raw) {
+    LogSchema schema = {};
+    size_t count = 0;
+    schema.size = 1;
+    for(const TelemetryField& field : TELEMETRY_FIELDS) {
+        if(field.encoding == FIELD_NOT_LOGGED) {
+            continue;
+        }
+        LogField& logged = schema.fields[count++];
+        logged.name = field.name;
+        logged.encoding = raw && field.rawOffset ? field.rawEncoding : field.encoding;
+        logged.decimals = field.decimals;
+        logged.conversion = raw && field.rawOffset ? field.conversion : uint8_t(RAW_NONE);
+        if(count == 1) {
+            schema.fields[count++] = {"flags", LOG_U16, 0};
+        }
+    }
+    for(const LogField& logged : schema.fields) {
+        schema.size += LOG_ENCODING_BYTES[logged.encoding];
+    }
+    return schema;
+}
+
+static constexpr LogSchema SAMPLE_SCHEMA = makeSchema(false);
+static constexpr LogSchema RAW_SCHEMA = makeSchema(true);
+
+static_assert(TELEMETRY_FIELDS[0].encoding == LOG_U64, "the flags word goes after time_us");
+static_assert(SAMPLE_SCHEMA.size == LOG_SAMPLE_SIZE, "TELEMETRY_FIELDS changed 'S', update LOG_SAMPLE_SIZE");
+static_assert(RAW_SCHEMA.size == LOG_RAW_SIZE, "TELEMETRY_FIELDS changed 'R', update LOG_RAW_SIZE");
+
+static const LogField GPS_FIELDS[] = {
+    {"gps_fix", LOG_U8, 0},
+    {"gps_sats", LOG_U8, 0},
+    {"gps_lat", LOG_F32, 6},
+    {"gps_lon", LOG_F32, 6},
+    {"gps_speed", LOG_F32, 3},
+    {"gps_angle", LOG_F32, 3},
+    {"gps_alt", LOG_F32, 3},
+};
+
+// RawScales in member order
+static const LogField SCALE_FIELDS[] = {
+    {"lsm_temp_scale", LOG_F32, 3},
+    {"adxl_acc_scale", LOG_F32, 3},
+    {"bno_quat_scale", LOG_F32, 3},
+    {"bno_gyro_scale", LOG_F32, 3},
+    {"bno_acc_scale", LOG_F32, 3},
+    {"bno_mag_scale", LOG_F32, 3},
+};
+
+const LogRecordType LOG_RECORD_TYPES[5] = {
+    {LOG_RECORD_SAMPLE, LOG_SAMPLE_SIZE, LOGGED_FIELDS, SAMPLE_SCHEMA.fields},
+    {LOG_RECORD_GPS, LOG_GPS_SIZE, sizeof(GPS_FIELDS) / sizeof(GPS_FIELDS[0]), GPS_FIELDS},
+    {LOG_RECORD_RAW, LOG_RAW_SIZE, LOGGED_FIELDS, RAW_SCHEMA.fields},
+    {LOG_RECORD_SCALES, LOG_SCALES_SIZE, sizeof(SCALE_FIELDS) / sizeof(SCALE_FIELDS[0]), SCALE_FIELDS},
+    {LOG_RECORD_DELTA, LOG_SIZE_VARIABLE, 0, nullptr},
+};
+
+
+const LogRecordType* logFindType(uint8_t type) {
+    for(const LogRecordType& record : LOG_RECORD_TYPES) {
+        if(record.type == type) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+const LogField* logFindField(uint8_t type, const char* name) {
+    const LogRecordType* record = logFindType(type);
+    for(uint8_t field = 0; record && field < record->fieldCount; field++) {
+        if(!strcmp(record->fields[field].name, name)) {
+            return &record->fields[field];
+        }
+    }
+    return nullptr;
+}
+
+int32_t logFixed(float value, uint8_t decimals, uint8_t bits) {
+    const int32_t lowest = -(int32_t(1) << (bits - 1));
+    const int32_t highest = (int32_t(1) << (bits - 1)) - 1;
+    double number = value;
+
+    if(isnan(number)) {
+        return lowest + LOG_FIXED_NAN;
+    }
+    if(isinf(number)) {
+        return lowest + LOG_FIXED_INF;
+    }
+    if(number > 4294967040.0 || number < -4294967040.0) {
+        return lowest + LOG_FIXED_OVF;
+    }
+
+    bool negative = number < 0.0;
+    if(negative) {
+        number = -number;
+    }
+    number += TEXT_ROUNDING[decimals];
+    uint32_t intPart = (uint32_t)number;
+    double remainder = number - (double)intPart;
+
+    int64_t digits = intPart;
+    for(uint8_t place = 0; place < decimals; place++) {
+        remainder *= 10.0;
+        int toPrint = int(remainder);
+        digits = digits * 10 + toPrint;
+        remainder -= toPrint;
+    }
+
+    if(negative) {
+        if(digits == 0) {
+            return lowest + LOG_FIXED_NEG_ZERO;
+        }
+        digits = -digits;
+    }
+    if(digits > highest || digits < lowest + LOG_FIXED_SENTINELS) {
+        return lowest + LOG_FIXED_OVF;
+    }
+    return int32_t(digits);
+}
+
+size_t logFormatFixed(int32_t value, uint8_t decimals, uint8_t bits, char* out) {
+    const int32_t lowest = -(int32_t(1) << (bits - 1));
+    if(value < lowest + LOG_FIXED_SENTINELS) {
+        static const char* SPECIAL[LOG_FIXED_SENTINELS] = {"nan", "inf", "ovf", "-0"};
+        const char* text = SPECIAL[value - lowest];
+        size_t length = strlen(text);
+        memcpy(out, text, length);
+        if(value - lowest == LOG_FIXED_NEG_ZERO && decimals) {
+            out[length++] = '.';
+            memset(out + length, '0', decimals);
+            length += decimals;
+        }
+        return length;
+    }
+
+    size_t length = 0;
+    uint32_t magnitude = value < 0 ? uint32_t(-int64_t(value)) : uint32_t(value);
+    if(value < 0) {
+        out[length++] = '-';
+    }
+    uint32_t intPart = magnitude / TEXT_POWERS_OF_TEN[decimals];
+    uint32_t fraction = magnitude % TEXT_POWERS_OF_TEN[decimals];
+
+    char digits[12];
+    uint8_t count = 0;
+    do {
+        digits[count++] = char('0' + intPart % 10);
+        intPart /= 10;
+    } while(intPart);
+    while(count) {
+        out[length++] = digits[--count];
+    }
+    if(decimals) {
+        out[length++] = '.';
+        for(int8_t place = decimals - 1; place >= 0; place--) {
+            out[length + place] = char('0' + fraction % 10);
+            fraction /= 10;
+        }
+        length += decimals;
+    }
+    return length;
+}
+
+static uint8_t* putLE(uint8_t* out, uint64_t value, uint8_t bytes) {
+    for(uint8_t ind = 0; ind < bytes; ind++) {
+        *out++ = uint8_t(value >> (8 * ind));
+    }
+    return out;
+}
+
+static uint8_t* putFloat(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return putLE(out, bits, 4);
+}
+
+size_t logPackHeader(const char* csvHeader, uint8_t* out) {
+    uint8_t* start = out;
+    out = putLE(out, LOG_MAGIC, 4);
+    out = putLE(out, LOG_VERSION, 1);
+    out = putLE(out, sizeof(LOG_RECORD_TYPES) / sizeof(LOG_RECORD_TYPES[0]), 1);
+    for(const LogRecordType& record : LOG_RECORD_TYPES) {
+        out = putLE(out, record.type, 1);
+        out = putLE(out, record.size, 2);
+        out = putLE(out, record.fieldCount, 1);
+        for(uint8_t field = 0; field < record.fieldCount; field++) {
+            const LogField& description = record.fields[field];
+            size_t nameLength = strlen(description.name);
+            out = putLE(out, description.encoding, 1);
+            out = putLE(out, description.decimals, 1);
+            out = putLE(out, nameLength, 1);
+            memcpy(out, description.name, nameLength);
+            out += nameLength;
+        }
+    }
+
+    size_t room = LOG_HEADER_MAX_SIZE - (out - start) - 2;
+    size_t headerLength = strlen(csvHeader);
+    headerLength = headerLength < room ? headerLength : room;
+    out = putLE(out, headerLength, 2);
+    memcpy(out, csvHeader, headerLength);
+    return out + headerLength - start;
+}
+
+size_t logHeaderSize(const uint8_t* bytes, size_t length) {
+    size_t offset = 6;
+    if(length < offset || (bytes[0] | bytes[1] << 8 | bytes[2] << 16 | uint32_t(bytes[3]) << 24) != LOG_MAGIC) {
+        return 0;
+    }
+    uint8_t typeCount = bytes[5];
+    for(uint8_t type = 0; type < typeCount; type++) {
+        if(offset + 4 > length) {
+            return 0;
+        }
+        uint8_t fieldCount = bytes[offset + 3];
+        offset += 4;
+        for(uint8_t field = 0; field < fieldCount; field++) {
+            if(offset + 3 > length) {
+                return 0;
+            }
+            offset += 3 + bytes[offset + 2];
+        }
+    }
+    if(offset + 2 > length) {
+        return 0;
+    }
+    offset += 2 + (bytes[offset] | bytes[offset + 1] << 8);
+    return offset <= length ? offset : 0;
+}
+
+static uint16_t sampleFlags(const SampleRecord& sample, bool gpsColumns) {
+    uint16_t flags = uint16_t((sample.state & 0x07) << LOG_FLAG_STATE_SHIFT);
+    for(uint8_t sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        flags |= uint16_t((sample.data.sensor_status[sensor] ? 1 : 0) << sensor);
+    }
+    if(gpsColumns) {
+        flags |= LOG_FLAG_GPS_COLUMNS;
+    }
+    return flags;
+}
+
+// one 'S'/'R' field, straight from its TELEMETRY_FIELDS entry
+template <bool RAW, size_t FIELD>
+static inline uint8_t* packField(const SampleRecord& sample, uint16_t flags, uint8_t* out) {
+    constexpr TelemetryField field = TELEMETRY_FIELDS[FIELD];
+    if constexpr(field.encoding == FIELD_NOT_LOGGED) {
+        return out;
+    } else {
+        const uint8_t* value = (const uint8_t*)&sample + (RAW && field.rawOffset ? field.rawOffset : field.offset);
+        constexpr uint8_t encoding = RAW && field.rawOffset ? field.rawEncoding : field.encoding;
+        if constexpr(encoding == LOG_U64) {
+            uint64_t number;
+            memcpy(&number, value, sizeof(number));
+            out = putLE(out, number, 8);
+        } else if constexpr(encoding == LOG_I16) {
+            uint16_t count;
+            memcpy(&count, value, sizeof(count));
+            out = putLE(out, count, 2);
+        } else if constexpr(encoding == LOG_I8) {
+            out = putLE(out, *value, 1);
+        } else {
+            float number;
+            memcpy(&number, value, sizeof(number));
+            if constexpr(encoding == LOG_F32) {
+                out = putFloat(out, number);
+            } else {
+                static_assert(encoding == LOG_FIXED16 || encoding == LOG_FIXED24, "no packing for this encoding");
+                constexpr uint8_t bits = encoding == LOG_FIXED16 ? 16 : 24;
+                out = putLE(out, uint32_t(logFixed(number, field.decimals, bits)), bits / 8);
+            }
+        }
+        if constexpr(FIELD == 0) {
+            out = putLE(out, flags, 2);
+        }
+        return out;
+    }
+}
+
+template <bool RAW, size_t... FIELDS>
+static inline void packFields(const SampleRecord& sample, uint16_t flags, uint8_t* out, std::index_sequence<FIELDS...>) {
+    ((out = packField<RAW, FIELDS>(sample, flags, out)), ...);
+}
+
+void logPackSample(const SampleRecord& sample, bool gpsColumns, uint8_t* out) {
+    out = putLE(out, LOG_RECORD_SAMPLE, 1);
+    packFields<false>(sample, sampleFlags(sample, gpsColumns), out, std::make_index_sequence<FIELD_COUNT>());
+}
+
+void logPackGps(const TelemetryData& data, uint8_t* out) {
+    out = putLE(out, LOG_RECORD_GPS, 1);
+    out = putLE(out, data.gps_fix, 1);
+    out = putLE(out, data.gps_sats, 1);
+    out = putFloat(out, data.gps_lat);
+    out = putFloat(out, data.gps_lon);
+    out = putFloat(out, data.gps_speed);
+    out = putFloat(out, data.gps_angle);
+    putFloat(out, data.gps_alt);
+}
+
+// no float formatting for the counts: they go out as they came off the bus
+void logPackRaw(const SampleRecord& sample, bool gpsColumns, uint8_t* out) {
+    out = putLE(out, LOG_RECORD_RAW, 1);
+    packFields<true>(sample, sampleFlags(sample, gpsColumns), out, std::make_index_sequence<FIELD_COUNT>());
+}
+
+void logPackScales(const RawScales& scales, uint8_t* out) {
+    out = putLE(out, LOG_RECORD_SCALES, 1);
+    out = putFloat(out, scales.lsm_temp);
+    out = putFloat(out, scales.adxl_acc);
+    out = putFloat(out, scales.bno_quat);
+    out = putFloat(out, scales.bno_gyro);
+    out = putFloat(out, scales.bno_acc);
+    putFloat(out, scales.bno_mag);
+}
@@ -0,0 +1,144 @@
+#ifndef SRAD_PHX_LOG_H
+#define SRAD_PHX_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SRAD_PHX_Raw.h"
+
+// Binary flight log, see README "Binary log". Everything little-endian.
+//
+// header:  u32 LOG_MAGIC, u8 LOG_VERSION, u8 record type count, then per
+//          type: u8 type, u16 size, u8 field count and per field
+//          u8 LOG_ENCODINGS, u8 decimals, u8 name length, name;
+//          finally u16 length + the CSV header line `writeSD` would print
+// records: u8 type followed by the fixed layout below, in log order; a
+//          type of size LOG_SIZE_VARIABLE has a u8 length, then that many bytes
+
+#define LOG_MAGIC 0x48505253            // "SRPH"
+#define LOG_VERSION 3                   // 2 added 'R'/'C' and LOG_I8/LOG_I16, 3 'D'; decoders read 1 too
+
+enum LOG_RECORDS {
+    LOG_RECORD_SAMPLE = 'S',            // one writeSD row without the GPS columns
+    LOG_RECORD_GPS = 'G',               // GPS columns, only written when they change
+    LOG_RECORD_RAW = 'R',               // LOG_FORMAT_RAW's 'S': register counts for the converted columns
+    LOG_RECORD_SCALES = 'C',            // RawScales for the 'R' counts, right after the header
+    LOG_RECORD_DELTA = 'D',             // the last 'S'/'R' again, every field delta coded, see LOG_DELTA
+};
+
+enum LOG_ENCODINGS {
+    LOG_U8 = 0,
+    LOG_U16 = 1,
+    LOG_U64 = 2,
+    LOG_F32 = 3,                        // raw float, decoded with the same printFloat
+    LOG_FIXED16 = 4,                    // printFloat digits as a signed decimal integer
+    LOG_FIXED24 = 5,
+    LOG_I8 = 6,                         // register count, printed after its RAW_CONVERSIONS
+    LOG_I16 = 7,
+};
+
+// LOG_FIXED* values at the bottom of the range stand for printFloat's special outputs
+#define LOG_FIXED_NAN 0                 // "nan"
+#define LOG_FIXED_INF 1                 // "inf", either sign
+#define LOG_FIXED_OVF 2                 // "ovf", or beyond what the field width holds
+#define LOG_FIXED_NEG_ZERO 3            // negative value that prints as -0.00...
+#define LOG_FIXED_SENTINELS 4
+
+// flags word of LOG_RECORD_SAMPLE
+#define LOG_FLAG_STATUS_MASK 0x001F     // sensor_status[0..4], one bit each
+#define LOG_FLAG_STATE_SHIFT 5          // 3 bits of STATES
+#define LOG_FLAG_GPS_COLUMNS 0x0100     // the CSV row carries the GPS columns
+
+#define LOG_SAMPLE_SIZE 66
+#define LOG_GPS_SIZE 23
+#define LOG_RAW_SIZE 52
+#define LOG_SCALES_SIZE 25
+#define LOG_SIZE_VARIABLE 0
+#define LOG_HEADER_MAX_SIZE 1024
+
+struct LogField {
+    const char* name;
+    uint8_t encoding;
+    uint8_t decimals;
+    uint8_t conversion = RAW_NONE;      // not in the file: decoders look it up by name
+};
+
+struct LogRecordType {
+    uint8_t type;
+    uint16_t size;
+    uint8_t fieldCount;
+    const LogField* fields;
+};
+
+extern const LogRecordType LOG_RECORD_TYPES[5];
+extern const uint8_t LOG_ENCODING_BYTES[8];    // stored size of each LOG_ENCODINGS
+
+/**
+ * @brief finds a record type this build writes
+ * @param type LOG_RECORDS
+ * @return Returns its layout, or `nullptr`
+ */
+const LogRecordType* logFindType(uint8_t type);
+
+struct SampleRecord;
+struct TelemetryData;
+
+/**
+ * @brief packs the schema header
+ * @param csvHeader Header line the CSV would start with, kept for the decoder
+ * @param out Destination, LOG_HEADER_MAX_SIZE bytes always fit
+ * @return Returns bytes packed
+ */
+size_t logPackHeader(const char* csvHeader, uint8_t* out);
+
+/**
+ * @brief finds where a packed header ends
+ * @param bytes Start of a log
+ * @param length Bytes available
+ * @return Returns the header size, or 0 if `bytes` doesn't start with a complete header
+ */
+size_t logHeaderSize(const uint8_t* bytes, size_t length);
+
+// LOG_SAMPLE_SIZE bytes, `gpsColumns` as FLIGHT::writeSD decides it
+void logPackSample(const SampleRecord& sample, bool gpsColumns, uint8_t* out);
+
+// LOG_GPS_SIZE bytes
+void logPackGps(const TelemetryData& data, uint8_t* out);
+
+// LOG_RAW_SIZE bytes, the 'S' record with the raw_* counts in place of their floats
+void logPackRaw(const SampleRecord& sample, bool gpsColumns, uint8_t* out);
+
+// LOG_SCALES_SIZE bytes
+void logPackScales(const RawScales& scales, uint8_t* out);
+
+/**
+ * @brief finds a field of the record types this build writes
+ * @param type LOG_RECORDS
+ * @param name Field name, as in the file's schema
+ * @return Returns the field, or `nullptr`
+ */
+const LogField* logFindField(uint8_t type, const char* name);
+
+/**
+ * @brief exactly the digits `Print::print(value, decimals)` would print, as one integer
+ * @param value Float as passed to print
+ * @param decimals Digits after the point, at most 6
+ * @param bits Width of the field, 16 or 24
+ * @return Returns the printed number times 10^decimals, or a LOG_FIXED_* sentinel
+ *         offset from the bottom of the field's range
+ *
+ * Repeats printFloat's own double arithmetic, so the digits match to the
+ * last place, just without emitting them one `write()` at a time.
+ */
+int32_t logFixed(float value, uint8_t decimals, uint8_t bits);
+
+/**
+ * @brief formats a LOG_FIXED* value the way printFloat printed it
+ * @param value Stored field value
+ * @param decimals Digits after the point
+ * @param bits Width of the field, 16 or 24
+ * @param out At least 24 bytes
+ * @return Returns the text length
+ */
+size_t logFormatFixed(int32_t value, uint8_t decimals, uint8_t bits, char* out);
+
+#endif
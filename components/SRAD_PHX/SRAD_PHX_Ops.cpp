@@ -8,79 +8,243 @@
  * All above text must be included in any redistribution.
  */
 
+#include <string.h>
 #include "SRAD_PHX.h"
+#include "SRAD_PHX_Fields.h"
+#include "SRAD_PHX_Text.h"
 
 /** 
  * @brief tracks time during flight
  * 
- * This function calls the millis() function from the
- * Arduino library to track milliseconds since the board
- * was powered on. It updates three variables: 
+ * This function reads the 64 bit microsecond clock from
+ * `nowMicros()` so loop deltas stay exact at high loop
+ * rates. It updates three things: 
  * 
- * 1. `deltaTime_ms`
- * 2. `runningTime_ms`
- * 3. `output.totalTime_ms`
+ * 1. `deltaTime_us`
+ * 2. `runningTime_us`
+ * 3. the loop jitter histogram
  */
 void FLIGHT::incrementTime() {
-    uint64_t newRunningTime_ms = millis();
-    deltaTime_ms = newRunningTime_ms - runningTime_ms;
-    runningTime_ms = newRunningTime_ms;
+    incrementTime(nowMicros());
+}
+
+/**
+ * @brief advances flight time to a given timestamp
+ * @param newRunningTime_us Microsecond timestamp of this loop
+ *
+ * Same as `incrementTime()` with an external clock, used by replay.
+ */
+void FLIGHT::incrementTime(uint64_t newRunningTime_us) {
+    uint32_t newDeltaTime_us = newRunningTime_us - runningTime_us;
+
+    if(runningTime_us != 0) {
+        // error against the nominal period, or against the previous loop if none is set
+        uint32_t expected_us = loopPeriod_us ? loopPeriod_us : deltaTime_us;
+        if(loopPeriod_us || deltaTime_us) {
+            loopJitter.record(newDeltaTime_us > expected_us ? newDeltaTime_us - expected_us
+                                                            : expected_us - newDeltaTime_us);
+        }
+        deltaTime_us = newDeltaTime_us;
+    }
+    runningTime_us = newRunningTime_us;
+}
+
+/**
+ * @brief sets the loop period jitter is measured against
+ * @param period_us Nominal loop period, 0 to measure cycle-to-cycle jitter instead
+ */
+void FLIGHT::setLoopPeriod(uint32_t period_us) {
+    loopPeriod_us = period_us;
+    loopJitter.reset();
+}
+
+// time of the last `incrementTime()`, microseconds since boot
+uint64_t FLIGHT::getTime_us() {
+    return runningTime_us;
+}
+
+/**
+ * @brief histogram of loop timing error in microseconds
+ *
+ * Filled by `incrementTime()`, one entry per loop.
+ */
+const HISTOGRAM& FLIGHT::getLoopJitter() {
+    return loopJitter;
+}
+
+/**
+ * @brief copies the current data into a queueable record
+ * @param time_us Timestamp to attach to the record
+ */
+SampleRecord FLIGHT::makeSample(uint64_t time_us) {
+    SampleRecord sample;
+    sample.time_us = time_us;
+    sample.state = STATE;
+    live.read(sample.data);
+    return sample;
+}
+
+STATES FLIGHT::getState() {
+    return STATE;
+}
+
+// forces the state machine, for ground tests and replay only
+void FLIGHT::setState(STATES state) {
+    STATE = state;
+}
+
+/**
+ * @brief feeds one recorded sample in place of the `read_*` functions
+ * @param time_us Timestamp of the sample, drives `deltaTime_us`
+ * @param sample Data as it was logged
+ *
+ * Call `calculateState()` afterwards, exactly like the flight loop would.
+ */
+void FLIGHT::replaySample(uint64_t time_us, const TelemetryData& sample) {
+    incrementTime(time_us);
+    live.write(sample);
+}
+
+/**
+ * @brief consistent copy of the latest sensor data
+ *
+ * Safe from any task while the readers are running: never blocks the
+ * `read_*` functions and never returns a half updated record.
+ */
+TelemetryData FLIGHT::getSnapshot() {
+    return live.read();
+}
+
+/**
+ * @brief registers a consumer ring filled by `pushSample()`
+ * @param ring Ring drained by exactly one logging or telemetry task
+ * @return Returns `false` if all FLIGHT_MAX_RINGS slots are taken
+ */
+bool FLIGHT::attachRing(FlightRing& ring) {
+    if(ring_count >= FLIGHT_MAX_RINGS) {
+        return false;
+    }
+    rings[ring_count++] = &ring;
+    return true;
+}
+
+/**
+ * @brief queues the current data for every attached consumer
+ * @return Returns the number of rings that were full and dropped the sample
+ *
+ * Must always be called from the same task (the single producer).
+ * Never blocks; drops are counted by each ring.
+ */
+uint8_t FLIGHT::pushSample() {
+    SampleRecord sample = makeSample(nowMicros());
+    uint8_t dropped = 0;
+    for(uint8_t ind = 0; ind < ring_count; ind++) {
+        dropped += !rings[ind]->push(sample);
+    }
+    return dropped;
 }
 
 /**
  * @brief writes data stored in `output` to file
  * @param headers If true, function will only right headers and return early
- * @param File A reference to Arduino file type from SD.h
+ * @param File A reference to an SD.h File, or any other Print
  * 
  * This function can write data headers or current data to SD card.
  */
-void FLIGHT::writeSD(bool headers, File& outputFile) {
+void FLIGHT::writeSD(bool headers, Print& outputFile) {
     if(headers) {
-        outputFile.println(data_header);
+        if(logFormat != LOG_FORMAT_CSV) {
+            uint8_t header[LOG_HEADER_MAX_SIZE];
+            outputFile.write(header, logPackHeader(data_header.c_str(), header));
+            if(logFormat == LOG_FORMAT_RAW) {
+                logPackScales(RAW_SCALES_ADAFRUIT, header);
+                outputFile.write(header, LOG_SCALES_SIZE);
+            }
+            gpsRecordWritten = false;
+            logDelta.reset();
+        } else {
+            outputFile.println(data_header);
+        }
         outputFile.flush();
         return;
     }
 
-    outputFile.print(runningTime_ms); outputFile.print(", ");
+    writeSD(makeSample(runningTime_us), outputFile);
+}
+
+/**
+ * @brief writes one queued sample to file
+ * @param sample Record popped from a `FlightRing`
+ * @param File A reference to an SD.h File, or any other Print
+ *
+ * In `LOG_FORMAT_BINARY` the sample goes out as one 'S' record, preceded
+ * by a 'G' record whenever the GPS fields changed, in a single `write()`.
+ * `LOG_FORMAT_RAW` writes an 'R' record instead, the register counts left
+ * for the decoder to convert. With `setLogKeyframes()` the record goes
+ * through `LOG_DELTA` first. `host/log_decode` turns any of these back
+ * into the CSV this would have printed.
+ */
+void FLIGHT::writeSD(const SampleRecord& sample, Print& outputFile) {
+    PROFILE_STAGE(profiler, STAGE_WRITE_SD);
+    if(logFormat == LOG_FORMAT_CSV) {
+        TEXT_ROW row(outputFile);
+        {
+            PROFILE_STAGE(profiler, STAGE_FORMAT_CSV);
+            fieldsText<FIELD_SD>(sample, last_gps != nullptr, row);
+        }
+        row.send();
+        outputFile.flush();
+        return;
+    }
+
+    uint8_t buffer[LOG_GPS_SIZE + LOG_DELTA_MAX_SIZE];
+    size_t length = 0;
     if(last_gps != nullptr) {
-        if(last_gps->fix) {
-            outputFile.print(last_gps->latitudeDegrees, 6); outputFile.print(", ");
-            outputFile.print(last_gps->longitudeDegrees, 6); outputFile.print(",");
-            outputFile.print((int32_t)last_gps->satellites); outputFile.print(",");
-            outputFile.print(last_gps->speed, 3); outputFile.print(",");
-            outputFile.print(last_gps->angle, 3); outputFile.print(",");
-            outputFile.print(last_gps->altitude, 3); outputFile.print(",");
+        logPackGps(sample.data, buffer);
+        if(!gpsRecordWritten || memcmp(buffer, lastGpsRecord, LOG_GPS_SIZE)) {
+            memcpy(lastGpsRecord, buffer, LOG_GPS_SIZE);
+            gpsRecordWritten = true;
+            length = LOG_GPS_SIZE;
+        }
+    }
+    uint8_t packed[LOG_SAMPLE_SIZE];
+    uint8_t* record = logDelta.enabled() ? packed : buffer + length;
+    {
+        PROFILE_STAGE(profiler, STAGE_FORMAT_BINARY);
+        if(logFormat == LOG_FORMAT_RAW) {
+            logPackRaw(sample, last_gps != nullptr, record);
         } else {
-            outputFile.print("-1,No fix,-1,No fix,0,-1,-1,-1,");
+            logPackSample(sample, last_gps != nullptr, record);
         }
     }
-    outputFile.print(data.bno_ori_w, 5); outputFile.print(",");
-    outputFile.print(data.bno_ori_x, 5); outputFile.print(",");
-    outputFile.print(data.bno_ori_y, 5); outputFile.print(",");
-    outputFile.print(data.bno_ori_z, 5); outputFile.print(",");
-    outputFile.print(data.bno_gyro_x, 5); outputFile.print(",");
-    outputFile.print(data.bno_gyro_y, 5); outputFile.print(",");
-    outputFile.print(data.bno_gyro_z, 5); outputFile.print(",");
-    outputFile.print(data.bno_acc_x, 4); outputFile.print(",");
-    outputFile.print(data.bno_acc_y, 4); outputFile.print(",");
-    outputFile.print(data.bno_acc_z, 4); outputFile.print(",");
-    outputFile.print(data.adxl_acc_x, 2); outputFile.print(",");
-    outputFile.print(data.adxl_acc_y, 2); outputFile.print(",");
-    outputFile.print(data.adxl_acc_z, 2); outputFile.print(",");
-    outputFile.print(data.bmp_press, 6); outputFile.print(",");
-    outputFile.print(data.bmp_alt, 4); outputFile.print(",");
-    outputFile.print(data.lsm_temp, 2); outputFile.print(",");
-    outputFile.print(data.adxl_temp, 2); outputFile.print(",");
-    outputFile.print(data.bno_temp, 2); outputFile.print(",");
-    outputFile.print(data.bmp_temp, 2); outputFile.print(",");
-    outputFile.print(data.sensor_status[0]); outputFile.print(",");
-    outputFile.print(data.sensor_status[1]); outputFile.print(",");
-    outputFile.print(data.sensor_status[2]); outputFile.print(",");
-    outputFile.print(data.sensor_status[3]); outputFile.print(",");
-    outputFile.print(data.sensor_status[4]); outputFile.println();
+    if(logDelta.enabled()) {
+        PROFILE_STAGE(profiler, STAGE_LOG_DELTA);
+        length += logDelta.encode(record, buffer + length);
+    } else {
+        length += logFormat == LOG_FORMAT_RAW ? LOG_RAW_SIZE : LOG_SAMPLE_SIZE;
+    }
+    // a dropped 'G' or 'D' leaves the decoder a stale base, write both whole next time
+    if(outputFile.write(buffer, length) != length) {
+        gpsRecordWritten = false;
+        logDelta.reset();
+    }
     outputFile.flush();
+}
 
-    return;
+void FLIGHT::setLogFormat(LOG_FORMATS format) {
+    logFormat = format;
+}
+
+LOG_FORMATS FLIGHT::getLogFormat() {
+    return logFormat;
+}
+
+/**
+ * @brief delta codes binary samples, see `LOG_DELTA`
+ * @param interval Records from one keyframe to the next, 0 writes every record whole
+ */
+void FLIGHT::setLogKeyframes(uint16_t interval) {
+    logDelta.setKeyframeInterval(interval);
 }
 
 /**
@@ -90,125 +254,46 @@ void FLIGHT::writeSD(bool headers, File& outputFile) {
  * 
  * This function can write data headers or current data to a serial port.
  */
-void FLIGHT::writeSERIAL(bool headers, Stream& outputSerial) {
+void FLIGHT::writeSERIAL(bool headers, Print& outputSerial) {
     if(headers) {
         outputSerial.println(data_header);
         outputSerial.flush();
         return;
     }
 
-    outputSerial.print(runningTime_ms); outputSerial.print(",");
-    if(last_gps != nullptr) {
-        if(last_gps->fix) {
-            outputSerial.print(last_gps->latitudeDegrees, 6); outputSerial.print(",");
-            outputSerial.print(last_gps->longitudeDegrees, 6); outputSerial.print(",");
-            outputSerial.print((int32_t)last_gps->satellites); outputSerial.print(",");
-            outputSerial.print(last_gps->speed, 3); outputSerial.print(",");
-            outputSerial.print(last_gps->angle, 3); outputSerial.print(",");
-            outputSerial.print(last_gps->altitude, 3); outputSerial.print(",");
-        } else {
-            outputSerial.print("-1,No fix,-1,No fix,0,-1,-1,-1,");
-        }
+    writeSERIAL(makeSample(runningTime_us), outputSerial);
+}
+
+/**
+ * @brief writes one queued sample to a serial port
+ * @param sample Record popped from a `FlightRing`
+ * @param Serial1 The serial port to write data to
+ */
+void FLIGHT::writeSERIAL(const SampleRecord& sample, Print& outputSerial) {
+    PROFILE_STAGE(profiler, STAGE_WRITE_SERIAL);
+    TEXT_ROW row(outputSerial);
+    {
+        PROFILE_STAGE(profiler, STAGE_FORMAT_SERIAL);
+        fieldsText<FIELD_SERIAL>(sample, last_gps != nullptr, row);
     }
-    outputSerial.print(data.lsm_gyro_x, 5); outputSerial.print(",");
-    outputSerial.print(data.lsm_gyro_y, 5); outputSerial.print(",");
-    outputSerial.print(data.lsm_gyro_z, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_ori_w, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_ori_x, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_ori_y, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_ori_z, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_gyro_x, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_gyro_y, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_gyro_z, 5); outputSerial.print(",");
-    outputSerial.print(data.bno_acc_x, 4); outputSerial.print(",");
-    outputSerial.print(data.bno_acc_y, 4); outputSerial.print(",");
-    outputSerial.print(data.bno_acc_z, 4); outputSerial.print(",");
-    outputSerial.print(data.adxl_acc_x, 2); outputSerial.print(",");
-    outputSerial.print(data.adxl_acc_y, 2); outputSerial.print(",");
-    outputSerial.print(data.adxl_acc_z, 2); outputSerial.print(",");
-    outputSerial.print(data.bmp_press, 6); outputSerial.print(",");
-    outputSerial.print(data.bmp_alt, 4); outputSerial.print(",");
-    outputSerial.print(data.lsm_temp, 2); outputSerial.print(",");
-    outputSerial.print(data.adxl_temp, 2); outputSerial.print(",");
-    outputSerial.print(data.bno_temp, 2); outputSerial.print(",");
-    outputSerial.print(data.bmp_temp, 2); outputSerial.print(",");
-    outputSerial.print(data.sensor_status[0]); outputSerial.print(",");
-    outputSerial.print(data.sensor_status[1]); outputSerial.print(",");
-    outputSerial.print(data.sensor_status[2]); outputSerial.print(",");
-    outputSerial.print(data.sensor_status[3]); outputSerial.print(",");
-    outputSerial.print(data.sensor_status[4]); outputSerial.println();
+    row.send();
     outputSerial.flush();
 
     return;
 }
 
-void FLIGHT::writeDEBUG(bool headers, Stream &outputSerial) {
+void FLIGHT::writeDEBUG(bool headers, Print &outputSerial) {
     if(headers) {
         outputSerial.println(data_header);
         outputSerial.flush();
         return;
     }
-
-    outputSerial.print("Uptime (ms): ");outputSerial.print(runningTime_ms); outputSerial.print(", \n");
-    outputSerial.print("State: "); outputSerial.println(STATE); outputSerial.println("\n");
-    if(last_gps != nullptr) {
-        if(last_gps->fix) {
-            outputSerial.print("GPS Latitude Degrees: ");outputSerial.print(last_gps->latitudeDegrees, 6); outputSerial.println(", ");
-            outputSerial.print("GPS Longitude Degrees: ");outputSerial.print(last_gps->longitudeDegrees, 6); outputSerial.println(",");
-            outputSerial.print("GPS satellites: ");outputSerial.print((int32_t)last_gps->satellites); outputSerial.print(",");
-            outputSerial.print("GPS speed: ");outputSerial.print(last_gps->speed, 3); outputSerial.print(",");
-            outputSerial.print("GPS angle: ");outputSerial.print(last_gps->angle, 3); outputSerial.print(",");
-            outputSerial.print("GPS altitude: ");outputSerial.println(last_gps->altitude, 3); outputSerial.println();
-        } else {
-            outputSerial.println("-1,No fix,-1,No fix,0,-1,-1,-1,\n");
-        }
+    TEXT_ROW row(outputSerial);
+    {
+        PROFILE_STAGE(profiler, STAGE_FORMAT_DEBUG);
+        fieldsText<FIELD_DEBUG>(makeSample(runningTime_us), last_gps != nullptr, row);
     }
-    // LSM data
-    outputSerial.print("LSM Gyro X: "); outputSerial.print(data.lsm_gyro_x, 5); outputSerial.print(",");
-    outputSerial.print("LSM Gyro Y: "); outputSerial.print(data.lsm_gyro_y, 5); outputSerial.print(",");
-    outputSerial.print("LSM Gyro Z: "); outputSerial.print(data.lsm_gyro_z, 5); outputSerial.println(",");
-
-    outputSerial.print("LSM Acc X: "); outputSerial.print(data.lsm_acc_x, 5); outputSerial.print(",");
-    outputSerial.print("LSM Acc Y: "); outputSerial.print(data.lsm_acc_y, 5); outputSerial.print(",");
-    outputSerial.print("LSM Acc Z: "); outputSerial.print(data.lsm_acc_z, 5); outputSerial.println(",");
-
-    //BNO data
-        //orientation
-    outputSerial.print("BNO W-Orientation: ");outputSerial.print(data.bno_ori_w, 5); outputSerial.print(",");
-    outputSerial.print("BNO X-Orientation: ");outputSerial.print(data.bno_ori_x, 5); outputSerial.print(",");
-    outputSerial.print("BNO Y-Orientation: ");outputSerial.print(data.bno_ori_y, 5); outputSerial.print(",");
-    outputSerial.print("BNO Z-Orientation: ");outputSerial.print(data.bno_ori_z, 5); outputSerial.println(",");
-        //gyro
-    outputSerial.print("BNO X-Gyro: ");outputSerial.print(data.bno_gyro_x, 5); outputSerial.print(",");
-    outputSerial.print("BNO Y-Gyro: ");outputSerial.print(data.bno_gyro_y, 5); outputSerial.print(",");
-    outputSerial.print("BNO Z-Gyro: ");outputSerial.print(data.bno_gyro_z, 5); outputSerial.println(",");
-        //Accel
-    outputSerial.print("BNO X-Accel: ");outputSerial.print(data.bno_acc_x, 4); outputSerial.print(",");
-    outputSerial.print("BNO Y-Accel: ");outputSerial.print(data.bno_acc_y, 4); outputSerial.print(",");
-    outputSerial.print("BNO Z-Accel: ");outputSerial.print(data.bno_acc_z, 4); outputSerial.println(",");
-
-    //ADXL data
-    outputSerial.print("ADXL X_Accel: ");outputSerial.print(data.adxl_acc_x, 2); outputSerial.print(",");
-    outputSerial.print("ADXL Y_Accel: ");outputSerial.print(data.adxl_acc_y, 2); outputSerial.print(",");
-    outputSerial.print("ADXL Z_Accel: ");outputSerial.print(data.adxl_acc_z, 2); outputSerial.println(",");
-
-    //BMP data
-    outputSerial.print("BMP Pressure: ");outputSerial.print(data.bmp_press, 6); outputSerial.print(",");
-    outputSerial.print("BMP Altitude: ");outputSerial.print(data.bmp_alt, 4); outputSerial.println(",");
-
-    //Temperature data
-    outputSerial.print("LSM Temp: ");outputSerial.print(data.lsm_temp, 2); outputSerial.print(",");
-    outputSerial.print("ADXL Temp: ");outputSerial.print(data.adxl_temp, 2); outputSerial.print(",");
-    outputSerial.print("BNO Temp: ");outputSerial.print(data.bno_temp, 2); outputSerial.print(",");
-    outputSerial.print("BMP Temp: ");outputSerial.print(data.bmp_temp, 2); outputSerial.println("\n");
-
-    //Sensor status
-    outputSerial.println("Sensor Status:");
-    outputSerial.print(data.sensor_status[0]); outputSerial.print(", ");
-    outputSerial.print(data.sensor_status[1]); outputSerial.print(", ");
-    outputSerial.print(data.sensor_status[2]); outputSerial.print(", ");
-    outputSerial.print(data.sensor_status[3]); outputSerial.print(", ");
-    outputSerial.print(data.sensor_status[4]); outputSerial.println("\n");
+    row.send();
     outputSerial.flush();
 
     return;
@@ -245,7 +330,51 @@ void FLIGHT::initTransferSerial(Stream &transferSerial) {
 //////////////////////////////////////////////////////////////////////////////
 */
 
-void FLIGHT::printRate() {
-    Serial.print("Cycle Time: "); Serial.println(deltaTime_ms);
-    Serial.print("Cycle Rate: "); Serial.println(1000.0/float(deltaTime_ms));
+/**
+ * @brief dumps loop timing and the per-stage profile on demand
+ * @param output Stream to write to
+ * @param binary If true, writes the compact `PROFILER::serialize()` dump instead of text
+ *
+ * Call this from a housekeeping task, not every loop: the dump itself
+ * costs far more than the stages it reports.
+ */
+void FLIGHT::printProfile(Print &output, bool binary) {
+    if(binary) {
+        uint8_t buffer[PROFILE_DUMP_MAX_SIZE];
+        output.write(buffer, profiler.serialize(buffer, sizeof(buffer)));
+        return;
+    }
+
+    output.print("Cycle Time (us): "); output.println(deltaTime_us);
+    output.print("Cycle Rate: "); output.println(1000000.0/float(deltaTime_us));
+    output.print("Jitter mean/max (us): "); output.print(loopJitter.mean(), 1);
+    output.print("/"); output.println(loopJitter.max());
+    profiler.print(output);
+
+    const FusionStats& fused = fusion.getStats();
+    output.print("Fusion updates/attitude/baro/high-g: "); output.print(fused.updates);
+    output.print("/"); output.print(fused.attitudeUpdates); output.print("/");
+    output.print(fused.baroUpdates); output.print("/"); output.println(fused.highG);
+    output.print("Fusion last/max (us): "); output.print(fused.lastCycles / float(cyclesPerMicro()), 1);
+    output.print("/"); output.print(fused.maxCycles / float(cyclesPerMicro()), 1);
+    output.print(", over "); output.print(fusion.budget_us); output.print(" us budget: ");
+    output.println(fused.overBudget);
+}
+
+PROFILER& FLIGHT::getProfiler() {
+    return profiler;
+}
+
+// configure before liftoff, e.g. `flight.getApogee().configure(16, 2.0, 3)`
+APOGEE& FLIGHT::getApogee() {
+    return apogee;
+}
+
+// tune before the first calculateState(), e.g. `flight.getFusion().baroNoise = 1.0`
+FUSION& FLIGHT::getFusion() {
+    return fusion;
+}
+
+LOG_DELTA& FLIGHT::getLogDelta() {
+    return logDelta;
 }
@@ -0,0 +1,147 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "SRAD_PHX_Profiler.h"
+
+static const char* STAGE_NAMES[STAGE_COUNT] = {
+    "read_LSM", "read_BMP", "read_ADXL", "read_BNO", "read_GPS",
+    "calculateState", "writeSD", "writeSERIAL", "fusion", "logDelta",
+    "formatCSV", "formatBinary", "formatSerial", "formatDebug", "resumeSave"
+};
+
+PROFILER::PROFILER() {
+#if !defined(SRAD_PHX_NO_PROFILER)
+    // cost of one instrumented scope, measured the same way a stage is
+    HISTOGRAM scratch;
+    const uint8_t samples = 16;
+    uint32_t start = nowCycles();
+    for(uint8_t sample = 0; sample < samples; sample++) {
+        uint32_t scopeStart = nowCycles();
+        scratch.record(nowCycles() - scopeStart);
+    }
+    overhead_cycles = (nowCycles() - start) / samples;
+#endif
+}
+
+void PROFILER::reset() {
+#if !defined(SRAD_PHX_NO_PROFILER)
+    for(uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        stages[stage].reset();
+    }
+#endif
+}
+
+bool PROFILER::isEnabled() {
+#if !defined(SRAD_PHX_NO_PROFILER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// cycles one PROFILE_STAGE() adds to the stage it measures
+uint32_t PROFILER::overheadCycles() {
+#if !defined(SRAD_PHX_NO_PROFILER)
+    return overhead_cycles;
+#else
+    return 0;
+#endif
+}
+
+const char* PROFILER::stageName(PROFILE_STAGES stage) {
+    return stage < STAGE_COUNT ? STAGE_NAMES[stage] : "unknown";
+}
+
+/**
+ * @brief prints one line per stage in microseconds
+ * @param output Stream to print to
+ *
+ * p50/p99 are bucket upper bounds, so they overestimate by up to 2x.
+ */
+void PROFILER::print(Print &output) {
+#if !defined(SRAD_PHX_NO_PROFILER)
+    float cyclesPerUs = cyclesPerMicro();
+    output.println("stage, count, min_us, mean_us, p50_us, p99_us, max_us");
+    for(uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        const HISTOGRAM& hist = stages[stage];
+        if(hist.count() == 0) {
+            continue;
+        }
+        output.print(STAGE_NAMES[stage]); output.print(", ");
+        output.print(hist.count()); output.print(", ");
+        output.print(hist.min() / cyclesPerUs, 1); output.print(", ");
+        output.print(hist.mean() / cyclesPerUs, 1); output.print(", ");
+        output.print(hist.percentile(50) / cyclesPerUs, 1); output.print(", ");
+        output.print(hist.percentile(99) / cyclesPerUs, 1); output.print(", ");
+        output.println(hist.max() / cyclesPerUs, 1);
+    }
+    output.print("profiler overhead per stage (cycles): "); output.println(overhead_cycles);
+#else
+    output.println("profiler compiled out (SRAD_PHX_NO_PROFILER)");
+#endif
+}
+
+static uint8_t* putLE(uint8_t* out, uint64_t value, uint8_t bytes) {
+    for(uint8_t ind = 0; ind < bytes; ind++) {
+        *out++ = uint8_t(value >> (8 * ind));
+    }
+    return out;
+}
+
+/**
+ * @brief packs every stage histogram into a little-endian binary dump
+ * @param buffer Destination, PROFILE_DUMP_MAX_SIZE bytes always fit
+ * @param size Size of `buffer`
+ * @return Returns bytes written, 0 if the buffer was too small
+ *
+ * Layout: u16 magic, u8 version, u8 stage count, u16 CPU MHz, then per
+ * stage u32 count, u32 min, u32 max, u64 sum (cycles), u8 n and n pairs
+ * of (u8 bucket, u32 count) for the non-empty log2 buckets.
+ */
+size_t PROFILER::serialize(uint8_t* buffer, size_t size) {
+    uint8_t stageCount = 0;
+#if !defined(SRAD_PHX_NO_PROFILER)
+    stageCount = STAGE_COUNT;
+#endif
+    if(size < 6) {
+        return 0;
+    }
+    uint8_t* out = buffer;
+    out = putLE(out, PROFILE_DUMP_MAGIC, 2);
+    out = putLE(out, PROFILE_DUMP_VERSION, 1);
+    out = putLE(out, stageCount, 1);
+    out = putLE(out, cyclesPerMicro(), 2);
+
+#if !defined(SRAD_PHX_NO_PROFILER)
+    for(uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        const HISTOGRAM& hist = stages[stage];
+        uint8_t used = 0;
+        for(uint8_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            used += hist.bucketCount(bucket) != 0;
+        }
+        if(size_t(out - buffer) + 21 + used * 5 > size) {
+            return 0;
+        }
+
+        out = putLE(out, hist.count(), 4);
+        out = putLE(out, hist.min(), 4);
+        out = putLE(out, hist.max(), 4);
+        out = putLE(out, hist.sumOf(), 8);
+        out = putLE(out, used, 1);
+        for(uint8_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            if(hist.bucketCount(bucket) != 0) {
+                out = putLE(out, bucket, 1);
+                out = putLE(out, hist.bucketCount(bucket), 4);
+            }
+        }
+    }
+#endif
+    return out - buffer;
+}
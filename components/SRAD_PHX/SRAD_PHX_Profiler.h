@@ -0,0 +1,90 @@
+#ifndef SRAD_PHX_PROFILER_H
+#define SRAD_PHX_PROFILER_H
+
+#include <Print.h>
+#include "SRAD_PHX_Time.h"
+#include "SRAD_PHX_Histogram.h"
+
+// read stages share their index with SENSORS
+enum PROFILE_STAGES {
+    STAGE_READ_LSM = 0,
+    STAGE_READ_BMP = 1,
+    STAGE_READ_ADXL = 2,
+    STAGE_READ_BNO = 3,
+    STAGE_READ_GPS = 4,
+    STAGE_CALCULATE_STATE = 5,
+    STAGE_WRITE_SD = 6,
+    STAGE_WRITE_SERIAL = 7,
+    STAGE_FUSION = 8,
+    STAGE_LOG_DELTA = 9,
+    STAGE_FORMAT_CSV = 10,          // the serializers alone, see SRAD_PHX_Fields.h
+    STAGE_FORMAT_BINARY = 11,
+    STAGE_FORMAT_SERIAL = 12,
+    STAGE_FORMAT_DEBUG = 13,
+    STAGE_RESUME_SAVE = 14,
+    STAGE_COUNT = 15,
+};
+
+#define PROFILE_DUMP_MAGIC 0x4650      // "PF" little-endian
+#define PROFILE_DUMP_VERSION 1
+// header + per stage (count, min, max, sum, bucket count, every bucket)
+#define PROFILE_DUMP_MAX_SIZE (6 + STAGE_COUNT * (21 + HISTOGRAM_BUCKETS * 5))
+
+/**
+ * @brief always-on CCOUNT histograms, one per flight loop stage
+ *
+ * Each stage must only be recorded from one task, and that task must stay
+ * on one core while a stage runs (CCOUNT is per core). Build with
+ * SRAD_PHX_NO_PROFILER to compile the histograms and every
+ * `PROFILE_STAGE()` out entirely.
+ */
+class PROFILER {
+    public:
+        PROFILER();
+
+        void record(PROFILE_STAGES stage, uint32_t cycles) {
+#if !defined(SRAD_PHX_NO_PROFILER)
+            stages[stage].record(cycles);
+#else
+            (void)stage; (void)cycles;
+#endif
+        }
+
+        void reset();
+        bool isEnabled();
+        uint32_t overheadCycles();
+        const char* stageName(PROFILE_STAGES);
+
+        void print(Print &);
+        size_t serialize(uint8_t*, size_t);
+
+#if !defined(SRAD_PHX_NO_PROFILER)
+        const HISTOGRAM& getStage(PROFILE_STAGES stage) { return stages[stage]; }
+
+    private:
+        HISTOGRAM stages[STAGE_COUNT];
+        uint32_t overhead_cycles;
+#endif
+};
+
+#if !defined(SRAD_PHX_NO_PROFILER)
+// times the rest of the enclosing scope, early returns included
+class PROFILE_SCOPE {
+    public:
+        PROFILE_SCOPE(PROFILER& p, PROFILE_STAGES s) : profiler(p), stage(s), start(nowCycles()) {}
+        ~PROFILE_SCOPE() { profiler.record(stage, nowCycles() - start); }
+
+    private:
+        PROFILER& profiler;
+        PROFILE_STAGES stage;
+        uint32_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_STAGE(profiler, stage) PROFILE_SCOPE PROFILE_CONCAT(profileScope_, __LINE__)(profiler, stage)
+#else
+#define PROFILE_STAGE(profiler, stage) do {} while(0)
+#endif
+
+#endif
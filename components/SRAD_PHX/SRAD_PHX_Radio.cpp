@@ -0,0 +1,380 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include "SRAD_PHX_Radio.h"
+#include "SRAD_PHX_Time.h"
+
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+
+static const uint32_t RADIO_TASK_STACK = 3072;
+#else
+#define IRAM_ATTR
+#endif
+
+static_assert(SRAD_PHX_RADIO_FRAMES >= 2 && SRAD_PHX_RADIO_FRAMES <= 16, "2 to 16 radio frames");
+
+/**
+ * @brief sets up the frame slots, nothing is sent until `begin()` or `service()`
+ * @param device Radio to send through; only the radio side touches it
+ */
+RADIO_LINK::RADIO_LINK(RADIO_DEVICE& device) : radio(device) {
+    for(uint8_t frame = 0; frame < SRAD_PHX_RADIO_FRAMES; frame++) {
+        lengths[frame] = 0;
+        freeFrames.push(frame);
+    }
+    resetStats();
+}
+
+RADIO_LINK::~RADIO_LINK() {
+    end();
+}
+
+/**
+ * @brief starts the radio task
+ * @param priority FreeRTOS priority, below the sensor readers
+ * @param core Core to pin the task to, clamped on single core builds
+ * @param txDonePin GPIO wired to the radio's TX done output (DIO0), -1 to poll the radio instead
+ * @return Returns `false` if the pin or task could not be set up, or on the host
+ *
+ * The task sleeps until `send()` queues a frame or the TX done
+ * interrupt ends the one on air, and keeps calling `service()` until `end()`.
+ */
+bool RADIO_LINK::begin(uint32_t priority, int core, int txDonePin) {
+#if defined(ESP_PLATFORM)
+    if(running) {
+        return true;
+    }
+    if(txDonePin >= 0) {
+        gpio_num_t gpio = (gpio_num_t)txDonePin;
+        if(!GPIO_IS_VALID_GPIO(gpio)) {
+            return false;
+        }
+        gpio_config_t pinConfig = {};
+        pinConfig.pin_bit_mask = 1ULL << txDonePin;
+        pinConfig.mode = GPIO_MODE_INPUT;
+        pinConfig.intr_type = GPIO_INTR_POSEDGE;
+        if(gpio_config(&pinConfig) != ESP_OK) {
+            return false;
+        }
+        // already installed (e.g. by attachInterrupt or the scheduler) is fine
+        esp_err_t installed = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if(installed != ESP_OK && installed != ESP_ERR_INVALID_STATE) {
+            return false;
+        }
+    }
+
+    running = true;
+    TaskHandle_t handle = nullptr;
+    if(xTaskCreatePinnedToCore(taskLoop, "radio_link", RADIO_TASK_STACK, this, priority, &handle,
+                               core < portNUM_PROCESSORS ? core : portNUM_PROCESSORS - 1) != pdPASS) {
+        running = false;
+        return false;
+    }
+    task = handle;
+
+    if(txDonePin >= 0) {
+        if(gpio_isr_handler_add((gpio_num_t)txDonePin, txDoneISR, this) != ESP_OK) {
+            end();
+            return false;
+        }
+        pin = txDonePin;
+    }
+    return true;
+#else
+    (void)priority;
+    (void)core;
+    (void)txDonePin;
+    return false;
+#endif
+}
+
+void RADIO_LINK::taskLoop(void* arg) {
+#if defined(ESP_PLATFORM)
+    RADIO_LINK* link = (RADIO_LINK*)arg;
+    while(link->running) {
+        TickType_t wait = portMAX_DELAY;
+        if(link->service()) {
+            // on air: the edge wakes us, the timeout only catches a lost one or the polled case;
+            // listening for a report polls the radio every tick
+            wait = link->pin >= 0 && !link->listening ? pdMS_TO_TICKS(link->txTimeout_us / 1000) + 1 : 1;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+    link->task = nullptr;
+    vTaskDelete(nullptr);
+#else
+    (void)arg;
+#endif
+}
+
+// TX done edge: stamps it and wakes the radio task, nothing else
+void IRAM_ATTR RADIO_LINK::txDoneISR(void* arg) {
+#if defined(ESP_PLATFORM)
+    RADIO_LINK* link = (RADIO_LINK*)arg;
+    link->txDoneEdge_us.store(uint32_t(nowMicros()), std::memory_order_relaxed);
+    link->txDone.store(true, std::memory_order_release);
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)link->task, &woken);
+    portYIELD_FROM_ISR(woken);
+#else
+    (void)arg;
+#endif
+}
+
+/**
+ * @brief sends everything queued and stops the task
+ *
+ * Waits while the queued frames go out, a few airtimes at most.
+ * Without a task it only services once: keep calling `service()` until
+ * it returns `false` to send the rest.
+ */
+void RADIO_LINK::end() {
+#if defined(ESP_PLATFORM)
+    if(running) {
+        while(!idle()) {
+            vTaskDelay(1);
+        }
+        running = false;
+        xTaskNotifyGive((TaskHandle_t)task);
+        while(task != nullptr) {
+            vTaskDelay(1);
+        }
+        if(pin >= 0) {
+            gpio_isr_handler_remove((gpio_num_t)pin);
+            pin = -1;
+        }
+        return;
+    }
+#endif
+    service();
+}
+
+/**
+ * @brief queues one frame for the radio
+ * @param frame Encoded telemetry, sent as one packet
+ * @param size Length of `frame`, at most `RADIO_FRAME_SIZE`
+ * @return Returns `false` if every slot is taken or the frame is too long; the frame is dropped and counted
+ */
+bool RADIO_LINK::send(const uint8_t* frame, size_t size) {
+    uint8_t slot = 0;
+    if(size == 0 || size > RADIO_FRAME_SIZE || !freeFrames.pop(slot)) {
+        framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    memcpy(frames[slot], frame, size);
+    lengths[slot] = size;
+    fullFrames.push(slot);
+    framesQueued.fetch_add(1, std::memory_order_relaxed);
+#if defined(ESP_PLATFORM)
+    if(task != nullptr) {
+        xTaskNotifyGive((TaskHandle_t)task);
+    }
+#endif
+    return true;
+}
+
+// true once every queued frame has been handed to the radio
+bool RADIO_LINK::idle() const {
+    return fullFrames.size() == 0;
+}
+
+// true once the frame on air is done, by the TX done edge or by asking the radio
+bool RADIO_LINK::finished(uint64_t now_us) {
+    if(txDone.exchange(false, std::memory_order_acquire)) {
+        return true;
+    }
+    if(pin >= 0 && now_us - txStart_us < txTimeout_us) {
+        return false;
+    }
+    if(radio.transmitting()) {
+        return false;
+    }
+    if(pin >= 0) {
+        Timing& update = timing.beginWrite();
+        update.stats.missedEdges++;
+        timing.endWrite();
+    }
+    return true;
+}
+
+/**
+ * @brief adapts the link's profile from the ground's reports
+ * @param linkAdapter Flight side of the link adaptation, nullptr to keep the radio's settings
+ *
+ * Tunes the radio to the adapter's profile at once. Call it before
+ * `begin()`, or with no frame on air when nothing was started.
+ */
+void RADIO_LINK::setAdapter(LINK_ADAPTER* linkAdapter) {
+    adapter = linkAdapter;
+    if(adapter) {
+        radio.setModem(adapter->getModem());
+    }
+}
+
+/**
+ * @brief ends the frame on air if it is done, then starts the next queued one
+ * @return Returns `true` while a frame is on air or still queued, or a report is awaited
+ */
+bool RADIO_LINK::service() {
+    uint64_t now_us = nowMicros();
+    if(onAir) {
+        if(!finished(now_us)) {
+            return true;
+        }
+        uint32_t end_us = pin >= 0 ? txDoneEdge_us.load(std::memory_order_relaxed) : uint32_t(now_us);
+        uint32_t airtime = end_us - uint32_t(txStart_us);
+        onAir = false;
+
+        if(polling) {
+            // the ground answers on the same profile
+            polling = false;
+            listening = true;
+            listenUntil_us = now_us + radio.airtime_us(LINK_REPORT_BYTES) + LINK_TURNAROUND_US;
+        } else {
+            Timing& update = timing.beginWrite();
+            update.stats.framesSent++;
+            update.stats.bytesSent += txLength;
+            update.airtime.record(airtime);
+            if(airtime > update.stats.airtimeMax_us) {
+                update.stats.airtimeMax_us = airtime;
+            }
+            timing.endWrite();
+        }
+    }
+    if(listening && !listen(now_us)) {
+        return true;
+    }
+
+    if(adapter && adapter->pollDue(now_us)) {
+        uint8_t poll[LINK_POLL_BYTES];
+        if(start(poll, adapter->poll(now_us, poll))) {
+            polling = true;
+            return true;
+        }
+        if(adapter->missed(now_us)) {
+            radio.setModem(adapter->getModem());
+        }
+    }
+
+    uint8_t slot;
+    while(fullFrames.pop(slot)) {
+        bool started = start(frames[slot], lengths[slot]);
+        freeFrames.push(slot);          // the radio has its own copy now
+        if(started) {
+            if(adapter) {
+                adapter->sent();        // counted against the ground's next report
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// hands one frame to the radio, `false` if it refused it
+bool RADIO_LINK::start(const uint8_t* frame, size_t size) {
+    txLength = size;
+    txDone.store(false, std::memory_order_relaxed);
+    uint32_t begin = nowCycles();
+    bool started = radio.transmit(frame, size);
+    uint32_t load_us = (nowCycles() - begin) / cyclesPerMicro();
+
+    Timing& update = timing.beginWrite();
+    if(load_us > update.stats.loadMax_us) {
+        update.stats.loadMax_us = load_us;
+    }
+    update.stats.txFailed += !started;
+    timing.endWrite();
+
+    if(started) {
+        onAir = true;
+        txStart_us = nowMicros();
+        txTimeout_us = 2 * radio.airtime_us(size);
+    }
+    return started;
+}
+
+// true once the report came in or its window closed, retuning the radio if the profile changed
+bool RADIO_LINK::listen(uint64_t now_us) {
+    uint8_t profile = adapter->getProfile();
+    uint8_t reply[LINK_REPORT_BYTES + 1];           // anything longer is not a report
+    LinkQuality heard;
+    size_t size = radio.receive(reply, sizeof(reply), heard);
+    bool answered = size && adapter->report(reply, size, now_us);
+    if(!answered && now_us < listenUntil_us) {
+        return false;
+    }
+    listening = false;
+    if(!answered) {
+        adapter->missed(now_us);
+    }
+    if(adapter->getProfile() != profile) {
+        radio.setModem(adapter->getModem());
+    }
+    return true;
+}
+
+/**
+ * @brief copies the counters
+ * @return Returns radio-side fields consistent with each other, producer-side ones as of the call
+ */
+RadioStats RADIO_LINK::getStats() const {
+    Timing current = timing.read();
+    RadioStats stats = current.stats;
+    stats.framesQueued = framesQueued.load(std::memory_order_relaxed);
+    stats.framesDropped = framesDropped.load(std::memory_order_relaxed);
+    stats.queueDepth = fullFrames.size();
+    stats.queueHighWater = fullFrames.highWater();
+    uint64_t elapsed_us = nowMicros() - current.start_us;
+    stats.packetsPerSecond = elapsed_us ? stats.framesSent * 1e6f / elapsed_us : 0.0f;
+    return stats;
+}
+
+HISTOGRAM RADIO_LINK::getAirtime() const {
+    return timing.read().airtime;
+}
+
+void RADIO_LINK::resetStats() {
+    Timing& update = timing.beginWrite();
+    update.stats = {};
+    update.airtime.reset();
+    update.start_us = nowMicros();
+    timing.endWrite();
+    framesQueued.store(0, std::memory_order_relaxed);
+    framesDropped.store(0, std::memory_order_relaxed);
+    fullFrames.resetCounters();
+}
+
+/**
+ * @brief prints frames sent and dropped, packet rate, queue depth and airtime
+ * @param output Print to write to
+ */
+void RADIO_LINK::printStats(Print& output) {
+    RadioStats stats = getStats();
+    HISTOGRAM airtime = getAirtime();
+    output.print("radio: queued "); output.print(stats.framesQueued);
+    output.print(", sent "); output.print(stats.framesSent);
+    output.print(" ("); output.print(stats.bytesSent);
+    output.print(" B), dropped "); output.print(stats.framesDropped);
+    output.print(", failed "); output.print(stats.txFailed);
+    output.print(", missed edges "); output.print(stats.missedEdges);
+    output.print(", "); output.print(stats.packetsPerSecond, 2); output.println(" packets/s");
+    output.print("radio: queue depth "); output.print(stats.queueDepth);
+    output.print(" (max "); output.print(stats.queueHighWater);
+    output.print(" of "); output.print(SRAD_PHX_RADIO_FRAMES);
+    output.print("), load max "); output.print(stats.loadMax_us);
+    output.print(" us, airtime mean/max "); output.print(airtime.mean(), 0);
+    output.print("/"); output.print(stats.airtimeMax_us); output.println(" us");
+}
@@ -0,0 +1,116 @@
+#ifndef SRAD_PHX_RADIO_H
+#define SRAD_PHX_RADIO_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "SRAD_PHX_HAL.h"
+#include "SRAD_PHX_Histogram.h"
+#include "SRAD_PHX_Link.h"
+#include "SRAD_PHX_Ring.h"
+#include "SRAD_PHX_Seqlock.h"
+
+// queued frames, override before including
+#ifndef SRAD_PHX_RADIO_FRAMES
+#define SRAD_PHX_RADIO_FRAMES 8
+#endif
+#define RADIO_FRAME_SIZE 255        // largest LoRa payload
+
+struct RadioStats {
+    uint32_t framesQueued;          // accepted by send()
+    uint32_t framesDropped;         // refused because every slot was queued, or too long
+    uint32_t framesSent;            // transmissions that finished
+    uint32_t bytesSent;
+    uint32_t txFailed;              // transmit() refused by the radio, frame discarded
+    uint32_t missedEdges;           // sent frames found by polling after the TX done edge never came
+    uint32_t queueDepth;            // frames waiting for the radio
+    uint32_t queueHighWater;
+    uint32_t loadMax_us;            // longest transmit() call, loading the FIFO and starting TX
+    uint32_t airtimeMax_us;         // longest start to TX done
+    float packetsPerSecond;         // frames sent since resetStats()
+};
+
+/**
+ * @brief owns the downlink radio in a task of its own
+ *
+ * `send()` copies an encoded frame into one of `SRAD_PHX_RADIO_FRAMES`
+ * slots and returns; it is all the flight loop does for telemetry. The
+ * radio task takes the oldest frame, starts it with
+ * `RADIO_DEVICE::transmit()` and sleeps until the radio's TX done pin
+ * (DIO0) interrupt wakes it for the next one, so nothing spins through a
+ * packet's airtime. A full queue drops the new frame and counts it.
+ *
+ * Without a TX done pin, or on the host, `service()` polls
+ * `transmitting()` instead. With one, it only polls once a frame has been
+ * on air for twice its airtime, and counts the lost edge.
+ *
+ * With a LINK_ADAPTER, the radio side also sends its polls ahead of the
+ * queue, listens for the ground's report for its airtime plus
+ * `LINK_TURNAROUND_US`, and retunes the radio between frames when the
+ * profile changes. Queued frames wait while it listens.
+ *
+ * One producer task calls `send()`; only the radio task (or the caller of
+ * `service()` when no task was started) touches the radio.
+ */
+class RADIO_LINK {
+    public:
+        RADIO_LINK(RADIO_DEVICE& radio);
+        ~RADIO_LINK();
+
+        bool begin(uint32_t priority, int core = 0, int txDonePin = -1);    // starts the radio task, target only
+        void end();                                     // waits for the queue to empty, stops the task
+
+        // producer side
+        bool send(const uint8_t* frame, size_t size);
+        bool idle() const;
+
+        // radio side, called by the task; call it yourself when no task was started
+        bool service();
+        void setAdapter(LINK_ADAPTER* adapter);         // before begin()
+
+        RadioStats getStats() const;
+        HISTOGRAM getAirtime() const;
+        void resetStats();
+        void printStats(Print &);
+
+    private:
+        static void taskLoop(void*);
+        static void txDoneISR(void*);
+        bool finished(uint64_t now_us);
+        bool start(const uint8_t* frame, size_t size);
+        bool listen(uint64_t now_us);
+
+        RADIO_DEVICE& radio;
+        void* task = nullptr;                           // TaskHandle_t on target
+        int pin = -1;                                   // TX done GPIO, -1 to poll
+        std::atomic<bool> running{false};
+        std::atomic<bool> txDone{false};                // set by the ISR
+        std::atomic<uint32_t> txDoneEdge_us{0};         // low 32 bits of the edge's nowMicros()
+
+        // producer
+        std::atomic<uint32_t> framesQueued{0};
+        std::atomic<uint32_t> framesDropped{0};
+
+        // radio
+        bool onAir = false;
+        uint64_t txStart_us = 0;
+        uint32_t txTimeout_us = 0;                      // twice the airtime of the frame on air
+        uint32_t txLength = 0;
+        LINK_ADAPTER* adapter = nullptr;
+        bool polling = false;                           // the frame on air is a poll
+        bool listening = false;                         // for the report to it
+        uint64_t listenUntil_us = 0;
+        struct Timing {
+            RadioStats stats;
+            uint64_t start_us;                          // of the packets per second window
+            HISTOGRAM airtime;                          // microseconds from transmit() to TX done
+        };
+        SEQLOCK<Timing> timing;
+
+        SAMPLE_RING<uint8_t, 16> fullFrames;            // producer -> radio
+        SAMPLE_RING<uint8_t, 16> freeFrames;            // radio -> producer
+        uint8_t lengths[SRAD_PHX_RADIO_FRAMES];
+        uint8_t frames[SRAD_PHX_RADIO_FRAMES][RADIO_FRAME_SIZE];
+};
+
+#endif
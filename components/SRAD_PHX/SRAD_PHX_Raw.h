@@ -0,0 +1,88 @@
+#ifndef SRAD_PHX_RAW_H
+#define SRAD_PHX_RAW_H
+
+#include <stdint.h>
+
+// Raw register counts to units, for LOG_FORMAT_RAW. Each conversion
+// returns, bit for bit, the float the Adafruit driver computes from the
+// same count (host/raw_verify runs every count through the real drivers),
+// so a log of counts decodes to exactly the CSV the floats would print.
+// The adapters use them in place of the drivers' double math.
+
+#define RAW_DPS_TO_RADS 0.017453293F    // SENSORS_DPS_TO_RADS
+#define RAW_GRAVITY 9.80665F            // SENSORS_GRAVITY_STANDARD
+
+// scale of each raw channel, logged once per file as the 'C' record
+struct RawScales {
+    float lsm_temp;                 // LSM6DSO32 counts per degree C, zero is 25 C
+    float adxl_acc;                 // ADXL375 mg per count
+    float bno_quat;                 // BNO055 counts per unit quaternion
+    float bno_gyro;                 // counts per dps
+    float bno_acc;                  // counts per m/s^2
+    float bno_mag;                  // counts per uT
+};
+
+// what the drivers assume: the ADXL375 range is fixed, the BNO055 keeps its power-on UNIT_SEL
+static const RawScales RAW_SCALES_ADAFRUIT = {256.0f, 49.0f, 16384.0f, 16.0f, 100.0f, 16.0f};
+
+// which conversion a LOG_FORMAT_RAW field needs, see `LogField`
+enum RAW_CONVERSIONS {
+    RAW_NONE = 0,                   // logged in its final form
+    RAW_LSM_TEMP = 1,
+    RAW_ADXL_ACC = 2,
+    RAW_BNO_QUAT = 3,
+    RAW_BNO_GYRO = 4,
+    RAW_BNO_ACC = 5,
+    RAW_BNO_TEMP = 6,
+};
+
+// Each divisor below is a power of two or the division rounds once where
+// the driver's double rounds twice to the same float; raw_verify has the
+// exhaustive proof. The ADXL375 is the exception, no float-only order
+// reproduces the driver's two double products, so it keeps them.
+
+inline float rawLsmTemp(int16_t count, float perDegree) {
+    return float(count) / perDegree + 25.0f;
+}
+
+inline float rawAdxlAcc(int16_t count, float mgPerCount) {
+    return float(count * (double(mgPerCount) / 1000.0) * RAW_GRAVITY);
+}
+
+inline float rawBnoQuat(int16_t count, float perUnit) {
+    return float(count) / perUnit;
+}
+
+// rad/s, like Adafruit_BNO055::getEvent(VECTOR_GYROSCOPE)
+inline float rawBnoGyro(int16_t count, float perDps) {
+    return float(count) / perDps * RAW_DPS_TO_RADS;
+}
+
+inline float rawBnoAcc(int16_t count, float perUnit) {
+    return float(count) / perUnit;
+}
+
+inline float rawBnoMag(int16_t count, float perUnit) {
+    return float(count) / perUnit;
+}
+
+/**
+ * @brief converts one LOG_FORMAT_RAW field, as `host/log_decode` does
+ * @param conversion RAW_CONVERSIONS of the field
+ * @param count Stored count, sign extended
+ * @param scales The file's 'C' record
+ * @return Returns the float the flight computer had for the count
+ */
+inline float rawConvert(uint8_t conversion, int32_t count, const RawScales& scales) {
+    switch(conversion) {
+        case RAW_LSM_TEMP: return rawLsmTemp(int16_t(count), scales.lsm_temp);
+        case RAW_ADXL_ACC: return rawAdxlAcc(int16_t(count), scales.adxl_acc);
+        case RAW_BNO_QUAT: return rawBnoQuat(int16_t(count), scales.bno_quat);
+        case RAW_BNO_GYRO: return rawBnoGyro(int16_t(count), scales.bno_gyro);
+        case RAW_BNO_ACC: return rawBnoAcc(int16_t(count), scales.bno_acc);
+        case RAW_BNO_TEMP: return float(int8_t(count));
+        default: return float(count);
+    }
+}
+
+#endif
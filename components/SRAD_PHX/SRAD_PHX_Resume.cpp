@@ -0,0 +1,117 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <esp_rom_crc.h>
+
+#include "SRAD_PHX_Resume.h"
+
+#if defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#include <esp_system.h>
+#else
+#define RTC_NOINIT_ATTR             // the host keeps them in ordinary memory, zero at start
+#endif
+
+#define RESUME_MAGIC 0x53525253     // "SRRS"
+
+// bytes, not a T: a constructor run at startup would overwrite what the last boot left
+template <typename T>
+struct ResumeSlot {
+    uint32_t magic;
+    uint32_t count;                 // saves so far, the higher valid count is the newer copy
+    alignas(T) uint8_t value[sizeof(T)];
+    uint32_t crc;                   // of everything above, written last
+};
+
+template <typename T>
+struct ResumeSlots {
+    ResumeSlot<T> slot[2];
+};
+
+RTC_NOINIT_ATTR static ResumeSlots<FlightResume> flightSlots;
+RTC_NOINIT_ATTR static ResumeSlots<LogResume> logSlots;
+
+template <typename T>
+static uint32_t slotCrc(const ResumeSlot<T>& slot) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&slot, offsetof(ResumeSlot<T>, crc));
+}
+
+template <typename T>
+static bool slotValid(const ResumeSlot<T>& slot) {
+    return slot.magic == RESUME_MAGIC && slot.crc == slotCrc(slot);
+}
+
+// index of the newer valid copy, -1 if neither is
+template <typename T>
+static int newestSlot(const ResumeSlots<T>& slots) {
+    bool first = slotValid(slots.slot[0]);
+    bool second = slotValid(slots.slot[1]);
+    if(first && second) {
+        return int32_t(slots.slot[1].count - slots.slot[0].count) > 0 ? 1 : 0;
+    }
+    return first ? 0 : (second ? 1 : -1);
+}
+
+template <typename T>
+static void save(ResumeSlots<T>& slots, const T& value) {
+    int newest = newestSlot(slots);
+    uint32_t count = newest < 0 ? 0 : slots.slot[newest].count + 1;
+    ResumeSlot<T>& slot = slots.slot[newest == 0 ? 1 : 0];
+    slot.crc = 0;                   // invalid until the copy is complete
+    slot.magic = RESUME_MAGIC;
+    slot.count = count;
+    memcpy(slot.value, &value, sizeof(T));
+    slot.crc = slotCrc(slot);
+}
+
+// RTC memory after these resets is whatever it powered up with, or stale on purpose
+static bool warmReset() {
+#if defined(ESP_PLATFORM)
+    esp_reset_reason_t reason = esp_reset_reason();
+    return reason != ESP_RST_POWERON && reason != ESP_RST_EXT && reason != ESP_RST_UNKNOWN;
+#else
+    return true;
+#endif
+}
+
+template <typename T>
+static bool load(const ResumeSlots<T>& slots, T& value) {
+    int newest = newestSlot(slots);
+    if(newest < 0 || !warmReset()) {
+        return false;
+    }
+    memcpy(&value, slots.slot[newest].value, sizeof(T));
+    return true;
+}
+
+void resumeSave(const FlightResume& resume) {
+    save(flightSlots, resume);
+}
+
+bool resumeLoad(FlightResume& resume) {
+    return load(flightSlots, resume);
+}
+
+void resumeSaveLog(const LogResume& resume) {
+    save(logSlots, resume);
+}
+
+bool resumeLoadLog(LogResume& resume) {
+    return load(logSlots, resume);
+}
+
+void resumeClear() {
+    for(uint8_t copy = 0; copy < 2; copy++) {
+        flightSlots.slot[copy].magic = 0;
+        logSlots.slot[copy].magic = 0;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SRAD_PHX_RESUME_H
+#define SRAD_PHX_RESUME_H
+
+#include <stdint.h>
+#include "SRAD_PHX_Apogee.h"
+
+// Warm restart, see README "Warm restart". Both records live in RTC slow
+// memory (RTC_NOINIT_ATTR), which keeps its contents through every reset
+// but a power-on. Each is kept twice: a save goes to the older copy and
+// its CRC32 is written last, so a reset in the middle of a save leaves
+// the other copy to load.
+
+// what FLIGHT needs to carry on mid-flight, saved by calculateState()
+struct FlightResume {
+    uint64_t time_us;               // flight time at the save, runningTime_us
+    uint64_t liftoff_us;
+    uint64_t lastBaroSample_us;
+    uint32_t deltaTime_us;
+    uint32_t liftoffTimer_us;
+    float alt_offset;
+    uint8_t state;                  // STATES
+    bool calibrated;
+    APOGEE apogee;                  // the altitude window and its sums
+};
+
+// where the log goes on, saved by the task that writes it
+struct LogResume {
+    uint64_t firstSector;           // FLIGHT_FILE extent, to check the file is the same one
+    uint64_t durable;               // bytes known to be on the card, the log continues from here
+    uint32_t sectorCount;
+    uint8_t pdrv;
+    uint32_t frameStream;           // LOG_FRAMER stream, 0 if unframed
+    uint32_t frameSequence;         // its nextSequence(), the resumed framer starts one past it
+};
+
+/**
+ * @brief stores the flight state for the next boot
+ * @param resume State to keep
+ *
+ * Costs one copy into RTC memory and a CRC32 of about a kilobyte.
+ */
+void resumeSave(const FlightResume& resume);
+
+/**
+ * @brief reads back what the last boot saved
+ * @param resume Filled in when a valid copy is found
+ * @return Returns `false` after a power-on or external reset, or if neither copy checks out
+ */
+bool resumeLoad(FlightResume& resume);
+
+void resumeSaveLog(const LogResume& resume);
+bool resumeLoadLog(LogResume& resume);
+
+// forgets both records, e.g. on the pad before a new flight
+void resumeClear();
+
+#endif
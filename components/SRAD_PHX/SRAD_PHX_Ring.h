@@ -0,0 +1,80 @@
+#ifndef SRAD_PHX_RING_H
+#define SRAD_PHX_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+// define SRAD_PHX_RING_IN_PSRAM (needs CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY)
+// and declare rings with SRAD_PHX_RING_ATTR to move them out of internal RAM
+#if defined(SRAD_PHX_RING_IN_PSRAM)
+#include "esp_attr.h"
+#define SRAD_PHX_RING_ATTR EXT_RAM_BSS_ATTR
+#else
+#define SRAD_PHX_RING_ATTR
+#endif
+
+/**
+ * @brief lock-free single-producer/single-consumer ring
+ *
+ * Fixed capacity `N` (power of two) with no allocation, so it can be a
+ * static. Exactly one task may call `push()` and exactly one other task
+ * may call `pop()`; use one ring per consumer. A full ring drops the new
+ * item and counts it instead of blocking the producer.
+ */
+template <typename T, uint32_t N>
+class SAMPLE_RING {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "ring capacity must be a power of two");
+
+    public:
+        // producer side
+        bool push(const T& item) {
+            uint32_t head = head_ind.load(std::memory_order_relaxed);
+            uint32_t used = head - tail_ind.load(std::memory_order_acquire);
+            if(used >= N) {
+                drop_count.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            slots[head & (N - 1)] = item;
+            head_ind.store(head + 1, std::memory_order_release);
+
+            if(used + 1 > high_water.load(std::memory_order_relaxed)) {
+                high_water.store(used + 1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        // consumer side
+        bool pop(T& item) {
+            uint32_t tail = tail_ind.load(std::memory_order_relaxed);
+            if(tail == head_ind.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            item = slots[tail & (N - 1)];
+            tail_ind.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // safe from either side, exact only from the consumer
+        uint32_t size() const {
+            return head_ind.load(std::memory_order_acquire) - tail_ind.load(std::memory_order_acquire);
+        }
+        uint32_t capacity() const { return N; }
+        uint32_t drops() const { return drop_count.load(std::memory_order_relaxed); }
+        uint32_t highWater() const { return high_water.load(std::memory_order_relaxed); }
+
+        void resetCounters() {
+            drop_count.store(0, std::memory_order_relaxed);
+            high_water.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint32_t> head_ind{0};  // written by producer only
+        std::atomic<uint32_t> tail_ind{0};  // written by consumer only
+        std::atomic<uint32_t> drop_count{0};
+        std::atomic<uint32_t> high_water{0};
+        T slots[N];
+};
+
+#endif
@@ -0,0 +1,387 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "SRAD_PHX_Scheduler.h"
+
+static const char* SENSOR_TASK_NAMES[SENSOR_COUNT] = {
+    "read_LSM", "read_BMP", "read_ADXL", "read_BNO", "read_GPS"
+};
+static const uint32_t SENSOR_TASK_STACK = 4096;
+static const uint64_t RATE_WINDOW_US = 1000000;
+
+SCHEDULER::SCHEDULER() {
+    statsLock = portMUX_INITIALIZER_UNLOCKED;
+    edgeLock = portMUX_INITIALIZER_UNLOCKED;
+    running = false;
+    memset(sensors, 0, sizeof(sensors));
+}
+
+SCHEDULER::~SCHEDULER() {
+    stop();
+}
+
+/**
+ * @brief registers a sensor to be read at a fixed rate
+ * @param sensor Which sensor, also picks the task name
+ * @param rate_hz Target read rate
+ * @param read Function doing one read, e.g. a lambda calling `FLIGHT::read_LSM`
+ * @param context Passed through to `read`
+ * @param priority FreeRTOS priority of the reader task
+ * @param core Core to pin the task to, clamped on single core builds
+ * @param bus Optional mutex held around `read` when sensors share a bus
+ * @return Returns `false` if the arguments are invalid or the scheduler is running
+ *
+ * Each sensor gets its own esp_timer that wakes its own task, so a
+ * slow read only ever delays itself.
+ */
+bool SCHEDULER::addSensor(SENSORS sensor, uint32_t rate_hz, SensorRead read, void* context,
+                          UBaseType_t priority, BaseType_t core, SemaphoreHandle_t bus) {
+    if(running || sensor >= SENSOR_COUNT || read == nullptr || rate_hz == 0 || rate_hz > 20000) {
+        return false;
+    }
+
+    SensorTask& entry = sensors[sensor];
+    memset(&entry, 0, sizeof(entry));
+    entry.owner = this;
+    entry.read = read;
+    entry.context = context;
+    entry.priority = priority;
+    entry.core = core < portNUM_PROCESSORS ? core : portNUM_PROCESSORS - 1;
+    entry.bus = bus;
+    entry.drdyPin = GPIO_NUM_NC;
+    entry.stats.period_us = 1000000 / rate_hz;
+    latency[sensor].reset();
+    return true;
+}
+
+/**
+ * @brief registers a sensor read whenever its data ready line rises
+ * @param sensor Which sensor, also picks the task name
+ * @param pin GPIO wired to the sensor's data ready output
+ * @param rate_hz Output data rate the sensor was configured for
+ * @param read Function doing one read, e.g. a lambda calling `FLIGHT::read_LSM`
+ * @param context Passed through to `read`
+ * @param priority FreeRTOS priority of the reader task
+ * @param core Core to pin the task to, clamped on single core builds
+ * @param bus Optional mutex held around `read` when sensors share a bus
+ * @return Returns `false` if the arguments are invalid or the scheduler is running
+ *
+ * Call the device's `enableDataReady()` first. The ISR only timestamps
+ * the edge and wakes the task, which reads each sample once. More than
+ * one edge per read counts as an overrun (a sample was overwritten), and
+ * no edge for four periods counts as missed: latched lines stay high
+ * after a lost edge, so the task then reads anyway to clear them.
+ */
+bool SCHEDULER::addDataReady(SENSORS sensor, gpio_num_t pin, uint32_t rate_hz, SensorRead read, void* context,
+                             UBaseType_t priority, BaseType_t core, SemaphoreHandle_t bus) {
+    if(!GPIO_IS_VALID_GPIO(pin) || !addSensor(sensor, rate_hz, read, context, priority, core, bus)) {
+        return false;
+    }
+
+    SensorTask& entry = sensors[sensor];
+    entry.drdyPin = pin;
+    entry.drdyTimeout = pdMS_TO_TICKS(4 * entry.stats.period_us / 1000) + 2;
+    return true;
+}
+
+/**
+ * @brief creates one pinned task and periodic timer per registered sensor
+ * @return Returns `true` if every sensor was started
+ */
+bool SCHEDULER::start() {
+    if(running) {
+        return true;
+    }
+    running = true;
+
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        SensorTask& entry = sensors[sensor];
+        if(entry.read == nullptr) {
+            continue;
+        }
+
+        if(xTaskCreatePinnedToCore(taskLoop, SENSOR_TASK_NAMES[sensor], SENSOR_TASK_STACK, &entry,
+                                   entry.priority, &entry.task, entry.core) != pdPASS) {
+            Serial.print("Scheduler: failed to create task "); Serial.println(SENSOR_TASK_NAMES[sensor]);
+            stop();
+            return false;
+        }
+
+        if(entry.drdyPin != GPIO_NUM_NC) {
+            if(!startDataReady(entry)) {
+                Serial.print("Scheduler: failed to attach data ready "); Serial.println(SENSOR_TASK_NAMES[sensor]);
+                stop();
+                return false;
+            }
+            continue;
+        }
+
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = timerCallback;
+        timerArgs.arg = &entry;
+        timerArgs.dispatch_method = ESP_TIMER_TASK;
+        timerArgs.name = SENSOR_TASK_NAMES[sensor];
+        if(esp_timer_create(&timerArgs, &entry.timer) != ESP_OK ||
+           esp_timer_start_periodic(entry.timer, entry.stats.period_us) != ESP_OK) {
+            Serial.print("Scheduler: failed to start timer "); Serial.println(SENSOR_TASK_NAMES[sensor]);
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+// rising edge interrupt on the data ready pin, the task must already exist
+bool SCHEDULER::startDataReady(SensorTask &entry) {
+    gpio_config_t pinConfig = {};
+    pinConfig.pin_bit_mask = 1ULL << entry.drdyPin;
+    pinConfig.mode = GPIO_MODE_INPUT;
+    pinConfig.pull_down_en = GPIO_PULLDOWN_ENABLE;
+    pinConfig.intr_type = GPIO_INTR_POSEDGE;
+    if(gpio_config(&pinConfig) != ESP_OK) {
+        return false;
+    }
+
+    // already installed (e.g. by attachInterrupt) is fine
+    esp_err_t installed = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if(installed != ESP_OK && installed != ESP_ERR_INVALID_STATE) {
+        return false;
+    }
+    return gpio_isr_handler_add(entry.drdyPin, dataReadyISR, &entry) == ESP_OK;
+}
+
+/**
+ * @brief stops all timers and lets each task finish its current read
+ *
+ * Tasks are never deleted mid-read so a shared bus mutex is always released.
+ */
+void SCHEDULER::stop() {
+    if(!running) {
+        return;
+    }
+    running = false;
+
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        SensorTask& entry = sensors[sensor];
+        if(entry.timer != nullptr) {
+            esp_timer_stop(entry.timer);
+            esp_timer_delete(entry.timer);
+            entry.timer = nullptr;
+        }
+        if(entry.read != nullptr && entry.drdyPin != GPIO_NUM_NC) {
+            gpio_isr_handler_remove(entry.drdyPin);
+        }
+        if(entry.task != nullptr) {
+            xTaskNotifyGive(entry.task);
+        }
+    }
+
+    // each task clears its own handle on exit
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        while(sensors[sensor].task != nullptr) {
+            vTaskDelay(1);
+        }
+    }
+}
+
+bool SCHEDULER::isRunning() {
+    return running;
+}
+
+/**
+ * @brief copies the statistics of one sensor
+ * @param sensor Which sensor
+ * @return Returns a consistent copy, zeroed if the sensor is not registered
+ */
+SensorStats SCHEDULER::getStats(SENSORS sensor) {
+    SensorStats stats = {};
+    if(sensor >= SENSOR_COUNT) {
+        return stats;
+    }
+
+    portENTER_CRITICAL(&statsLock);
+    stats = sensors[sensor].stats;
+    portEXIT_CRITICAL(&statsLock);
+    return stats;
+}
+
+/**
+ * @brief copies the edge to read start latency histogram of one sensor
+ * @param sensor Which sensor
+ * @return Returns microsecond latencies, empty unless the sensor uses `addDataReady()`
+ */
+HISTOGRAM SCHEDULER::getLatency(SENSORS sensor) {
+    HISTOGRAM copy;
+    if(sensor >= SENSOR_COUNT) {
+        return copy;
+    }
+
+    portENTER_CRITICAL(&statsLock);
+    copy = latency[sensor];
+    portEXIT_CRITICAL(&statsLock);
+    return copy;
+}
+
+void SCHEDULER::resetStats() {
+    portENTER_CRITICAL(&statsLock);
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        SensorTask& entry = sensors[sensor];
+        uint32_t period_us = entry.stats.period_us;
+        memset(&entry.stats, 0, sizeof(entry.stats));
+        entry.stats.period_us = period_us;
+        entry.jitterSum_us = 0;
+        entry.windowStart_us = 0;
+        entry.windowSamples = 0;
+        entry.latencySum_us = 0;
+        entry.latencySamples = 0;
+        latency[sensor].reset();
+    }
+    portEXIT_CRITICAL(&statsLock);
+}
+
+/**
+ * @brief prints target vs achieved rate and jitter of every registered sensor
+ * @param output Stream to print to, not called from the reader tasks
+ */
+void SCHEDULER::printStats(Stream &output) {
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        if(sensors[sensor].read == nullptr) {
+            continue;
+        }
+        SensorStats stats = getStats((SENSORS)sensor);
+
+        output.print(SENSOR_TASK_NAMES[sensor]);
+        output.print(": target "); output.print(1000000.0 / stats.period_us, 1);
+        output.print(" Hz, achieved "); output.print(stats.rate_hz, 1);
+        output.print(" Hz, jitter mean/max "); output.print(stats.jitterMean_us);
+        output.print("/"); output.print(stats.jitterMax_us);
+        output.print(" us, read max "); output.print(stats.readMax_us);
+        output.print(" us, samples "); output.print(stats.samples);
+        output.print(", errors "); output.print(stats.errors);
+        output.print(", overruns "); output.print(stats.overruns);
+        if(sensors[sensor].drdyPin != GPIO_NUM_NC) {
+            output.print(", drdy missed "); output.print(stats.missed);
+            output.print(", latency mean/max "); output.print(stats.latencyMean_us);
+            output.print("/"); output.print(stats.latencyMax_us); output.print(" us");
+        }
+        output.println();
+    }
+}
+
+// runs in the esp_timer task, only wakes the reader
+void SCHEDULER::timerCallback(void* arg) {
+    SensorTask* entry = (SensorTask*)arg;
+    xTaskNotifyGive(entry->task);
+}
+
+// stamps the edge and wakes the reader, nothing else
+void IRAM_ATTR SCHEDULER::dataReadyISR(void* arg) {
+    SensorTask* entry = (SensorTask*)arg;
+    uint64_t edge_us = nowMicros();
+
+    portENTER_CRITICAL_ISR(&entry->owner->edgeLock);
+    entry->edge_us = edge_us;
+    portEXIT_CRITICAL_ISR(&entry->owner->edgeLock);
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(entry->task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void SCHEDULER::taskLoop(void* arg) {
+    SensorTask* entry = (SensorTask*)arg;
+    SCHEDULER* owner = entry->owner;
+    bool dataReady = entry->drdyPin != GPIO_NUM_NC;
+
+    while(true) {
+        // more than one pending notification means we missed periods (or edges),
+        // none means the data ready wait timed out
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, dataReady ? entry->drdyTimeout : portMAX_DELAY);
+        if(!owner->running) {
+            break;
+        }
+
+        uint64_t edge_us = 0;
+        if(dataReady && pending > 0) {
+            portENTER_CRITICAL(&owner->edgeLock);
+            edge_us = entry->edge_us;
+            portEXIT_CRITICAL(&owner->edgeLock);
+        }
+
+        uint64_t start_us = nowMicros();
+        if(entry->bus != nullptr) {
+            xSemaphoreTake(entry->bus, portMAX_DELAY);
+        }
+        uint8_t result = entry->read(entry->context);
+        if(entry->bus != nullptr) {
+            xSemaphoreGive(entry->bus);
+        }
+        owner->recordSample(*entry, pending, result, start_us, nowMicros(), edge_us);
+    }
+
+    entry->task = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void SCHEDULER::recordSample(SensorTask &entry, uint32_t pending, uint8_t result,
+                             uint64_t start_us, uint64_t end_us, uint64_t edge_us) {
+    portENTER_CRITICAL(&statsLock);
+    SensorStats& stats = entry.stats;
+
+    if(pending == 0) {
+        // forced read after a data ready timeout, not a periodic sample
+        stats.missed++;
+        stats.errors += result != 0;
+        portEXIT_CRITICAL(&statsLock);
+        return;
+    }
+
+    if(edge_us != 0) {
+        uint32_t latency_us = start_us - edge_us;
+        latency[&entry - sensors].record(latency_us);
+        entry.latencySum_us += latency_us;
+        entry.latencySamples++;
+        stats.latencyMean_us = entry.latencySum_us / entry.latencySamples;
+        if(latency_us > stats.latencyMax_us) {
+            stats.latencyMax_us = latency_us;
+        }
+        stats.lastEdge_us = edge_us;
+    }
+
+    if(stats.samples > 0) {
+        // compare against the periods that actually elapsed so one overrun isn't counted as jitter too
+        int64_t expected_us = (int64_t)stats.period_us * pending;
+        int64_t actual_us = start_us - stats.lastSample_us;
+        uint32_t jitter_us = (uint32_t)llabs(actual_us - expected_us);
+        entry.jitterSum_us += jitter_us;
+        stats.jitterMean_us = entry.jitterSum_us / stats.samples;
+        if(jitter_us > stats.jitterMax_us) {
+            stats.jitterMax_us = jitter_us;
+        }
+    }
+
+    stats.samples++;
+    stats.errors += result != 0;
+    stats.overruns += pending - 1;
+    stats.lastSample_us = start_us;
+    if(end_us - start_us > stats.readMax_us) {
+        stats.readMax_us = end_us - start_us;
+    }
+
+    if(entry.windowStart_us == 0) {
+        entry.windowStart_us = start_us;
+    } else if(start_us - entry.windowStart_us >= RATE_WINDOW_US) {
+        stats.rate_hz = entry.windowSamples * 1e6f / float(start_us - entry.windowStart_us);
+        entry.windowStart_us = start_us;
+        entry.windowSamples = 0;
+    }
+    entry.windowSamples++;
+    portEXIT_CRITICAL(&statsLock);
+}
@@ -0,0 +1,87 @@
+#ifndef SRAD_PHX_SCHEDULER_H
+#define SRAD_PHX_SCHEDULER_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+
+#include "SRAD_PHX.h"
+
+// same return convention as FLIGHT::read_*: 0 on success
+typedef uint8_t (*SensorRead)(void* context);
+
+struct SensorStats {
+    uint32_t period_us;         // configured period
+    uint32_t samples;           // completed reads
+    uint32_t errors;            // reads that returned nonzero
+    uint32_t overruns;          // periods skipped because the previous read ran long
+    uint64_t lastSample_us;     // start of the latest read
+    float rate_hz;              // achieved rate over the last one second window
+    uint32_t jitterMean_us;     // mean |actual - nominal| period
+    uint32_t jitterMax_us;      // worst |actual - nominal| period
+    uint32_t readMax_us;        // longest single read, including bus wait
+
+    // data ready mode only, see addDataReady()
+    uint32_t missed;            // timeouts without an edge, recovered with a forced read
+    uint64_t lastEdge_us;       // ISR timestamp of the latest data ready edge
+    uint32_t latencyMean_us;    // edge to read start
+    uint32_t latencyMax_us;
+};
+
+class SCHEDULER {
+    public:
+        SCHEDULER();
+        ~SCHEDULER();
+
+        bool addSensor(SENSORS sensor, uint32_t rate_hz, SensorRead read, void* context,
+                       UBaseType_t priority, BaseType_t core = 1, SemaphoreHandle_t bus = nullptr);
+        bool addDataReady(SENSORS sensor, gpio_num_t pin, uint32_t rate_hz, SensorRead read, void* context,
+                          UBaseType_t priority, BaseType_t core = 1, SemaphoreHandle_t bus = nullptr);
+        bool start();
+        void stop();
+        bool isRunning();
+
+        SensorStats getStats(SENSORS sensor);
+        HISTOGRAM getLatency(SENSORS sensor);
+        void resetStats();
+        void printStats(Stream &);
+
+    private:
+        struct SensorTask {
+            SCHEDULER* owner;
+            SensorRead read;
+            void* context;
+            UBaseType_t priority;
+            BaseType_t core;
+            SemaphoreHandle_t bus;          // optional, shared with other sensors on the same bus
+            TaskHandle_t task;
+            esp_timer_handle_t timer;
+            gpio_num_t drdyPin;             // GPIO_NUM_NC when timer driven
+            TickType_t drdyTimeout;         // longest wait for an edge before a forced read
+            uint64_t edge_us;               // written by the ISR under edgeLock
+
+            SensorStats stats;
+            uint64_t jitterSum_us;
+            uint64_t windowStart_us;
+            uint32_t windowSamples;
+            uint64_t latencySum_us;
+            uint32_t latencySamples;
+        };
+
+        static void timerCallback(void*);
+        static void dataReadyISR(void*);
+        static void taskLoop(void*);
+        bool startDataReady(SensorTask &);
+        void recordSample(SensorTask &, uint32_t, uint8_t, uint64_t, uint64_t, uint64_t);
+
+        SensorTask sensors[SENSOR_COUNT];
+        HISTOGRAM latency[SENSOR_COUNT];    // microseconds from data ready edge to read start
+        portMUX_TYPE statsLock;
+        portMUX_TYPE edgeLock;              // ISR side, only guards SensorTask::edge_us
+        volatile bool running;
+};
+
+#endif
@@ -8,173 +8,193 @@
  * All above text must be included in any redistribution.
  */
 
+#include <string.h>
 #include "SRAD_PHX.h"
 
 /**
- * Reads the Adafruit LSM6DS032 6 DoF Accelerometer/Gyroscope.
+ * Reads the LSM6DS032 6 DoF Accelerometer/Gyroscope.
  * It's index in the sensorStatus is 0.
- * @param LSM Referenece to initialized sensor instance
+ * @param LSM Initialized device, e.g. `LSM_IMU` or `SIM_IMU`
  * @returns Returns `true` if the operation succeeds, False if the operation fails
  */
-uint8_t FLIGHT::read_LSM(Adafruit_LSM6DSO32 &LSM) {
-    sensors_event_t accel, gyro, temp;
+uint8_t FLIGHT::read_LSM(IMU_DEVICE &LSM) {
+    PROFILE_STAGE(profiler, STAGE_READ_LSM);
+    ImuReading reading;
+    uint64_t sampleTime_us = nowMicros();
 
     // Attempt to read sensor data
-    if(!LSM.getEvent(&accel, &gyro, &temp))
+    if(!LSM.read(reading))
     {
-        data.sensor_status[0] = 0;
+        setStatus(SENSOR_LSM, 0);
         return 1;  // Return true if read fails
     }
 
+    // publish everything in one short write section, after the bus transfer
+    TelemetryData& out = live.beginWrite();
+
     // Store gyroscope data
-    data.lsm_gyro_x = gyro.gyro.x;
-    data.lsm_gyro_y = gyro.gyro.y;
-    data.lsm_gyro_z = gyro.gyro.z;
+    out.lsm_gyro_x = reading.gyro_x;
+    out.lsm_gyro_y = reading.gyro_y;
+    out.lsm_gyro_z = reading.gyro_z;
 
     // Store accelerometer data
-    data.lsm_acc_x = accel.acceleration.x;
-    data.lsm_acc_y = accel.acceleration.y;
-    data.lsm_acc_z = accel.acceleration.z;
+    out.lsm_acc_x = reading.acc_x;
+    out.lsm_acc_y = reading.acc_y;
+    out.lsm_acc_z = reading.acc_z;
 
     // Store temperature data
-    data.lsm_temp = float(temp.temperature);
+    out.lsm_temp = reading.temp;
+    out.raw_lsm_temp = reading.raw_temp;
 
-    data.sensor_status[0] = 1;
+    out.sample_time_us[SENSOR_LSM] = sampleTime_us;
+    out.sensor_status[0] = 1;
+    live.endWrite();
     return 0;  // Return false if read succeeds
 }
 
 /**
- * Reads the Adafruit BMP388 Precision Barometer and Altimeter
+ * Reads the BMP388 Precision Barometer and Altimeter
  * It's index in sensorStatus is 1.
- * @param BMP Reference to initialized sensor instance\
+ * @param BMP Initialized device, e.g. `BMP_BARO` or `SIM_BARO`
  * @return Returns `true` if operation succeeds
  */
-uint8_t FLIGHT::read_BMP(Adafruit_BMP3XX &BMP) {
-    if (!BMP.performReading()) {
-        data.sensor_status[1] = 0;
+uint8_t FLIGHT::read_BMP(BARO_DEVICE &BMP) {
+    PROFILE_STAGE(profiler, STAGE_READ_BMP);
+    BaroReading reading;
+    uint64_t sampleTime_us = nowMicros();
+    if (!BMP.read(reading)) {
+        setStatus(SENSOR_BMP, 0);
         return 1;
     }
-    data.bmp_temp = BMP.temperature;
-    data.bmp_press = BMP.pressure;
 
+    float altitude;
     if(STATE < STATES::FLIGHT_ASCENT) {
-        data.bmp_alt = BMP.readAltitude(1013.25);   //uncalibrated/true altitude
+        altitude = pressureAltitude(reading.pressure, 1013.25);     //uncalibrated/true altitude
     } else {
-        data.bmp_alt = BMP.readAltitude(1013.25) - alt_offset;    //sea level can fluctuate under +/- 7 
-                                                                    // depends on the data of the day. 
-                                                                    //But 1013.25 is an acceptable value.
-    }
-    
-    if(++altReadings_ind == 10) {
-        altReadings_ind = 0;
+        altitude = pressureAltitude(reading.pressure, 1013.25) - alt_offset;    //sea level can fluctuate under +/- 7 
+                                                                                // depends on the data of the day. 
+                                                                                //But 1013.25 is an acceptable value.
     }
-    altReadings[altReadings_ind] = data.bmp_alt;
 
-    data.sensor_status[1] = 1;
+    TelemetryData& out = live.beginWrite();
+    out.bmp_temp = reading.temp;
+    out.bmp_press = reading.pressure;
+    out.bmp_alt = altitude;
+    out.sample_time_us[SENSOR_BMP] = sampleTime_us;
+    out.sensor_status[1] = 1;
+    live.endWrite();
     return 0;
 }
 
 /**
- * Reads the Adafruit ADXL_375 High-G Accelerometer
+ * Reads the ADXL_375 High-G Accelerometer
  * It's index in sensor status is 2.
- * @param ADXL Reference to initialized sensor instance
+ * @param ADXL Initialized device, e.g. `ADXL_ACCEL` or `SIM_ACCEL`
  * @return Returns `true`if operation succeeds
  */
-uint8_t FLIGHT::read_ADXL(Adafruit_ADXL375 &ADXL) {
-    sensors_event_t event;
-    if (!ADXL.getEvent(&event)) {
-        data.sensor_status[2] = 0;
+uint8_t FLIGHT::read_ADXL(ACCEL_DEVICE &ADXL) {
+    PROFILE_STAGE(profiler, STAGE_READ_ADXL);
+    AccelReading reading;
+    uint64_t sampleTime_us = nowMicros();
+    if (!ADXL.read(reading)) {
+        setStatus(SENSOR_ADXL, 0);
         return 1;
     }
-    data.adxl_acc_x = event.acceleration.x;
-    data.adxl_acc_y = event.acceleration.y;
-    data.adxl_acc_z = event.acceleration.z;
 
-    data.adxl_temp = float(event.temperature);
+    TelemetryData& out = live.beginWrite();
+    out.adxl_acc_x = reading.acc_x;
+    out.adxl_acc_y = reading.acc_y;
+    out.adxl_acc_z = reading.acc_z;
 
-    data.sensor_status[2] = 1;
+    out.adxl_temp = reading.temp;
+    memcpy(out.raw_adxl_acc, reading.raw_acc, sizeof(out.raw_adxl_acc));
+
+    out.sample_time_us[SENSOR_ADXL] = sampleTime_us;
+    out.sensor_status[2] = 1;
+    live.endWrite();
     return 0;
 }
 
 /**
- * Returns Adafruit BNO055 Absolute Orientation Sensor
+ * Returns BNO055 Absolute Orientation Sensor
  * It's index in sensorStatus is 3.
- * @param BNO Initialized sensor instance
+ * @param BNO Initialized device, e.g. `BNO_AHRS` or `SIM_AHRS`
  * @return Returns `true` if operation succeeds
  */
-uint8_t FLIGHT::read_BNO(Adafruit_BNO055 &BNO) {
-    sensors_event_t orientationData, angVelocityData, magnetometerData, accelerometerData;
+uint8_t FLIGHT::read_BNO(AHRS_DEVICE &BNO) {
+    PROFILE_STAGE(profiler, STAGE_READ_BNO);
+    AhrsReading reading;
+    uint64_t sampleTime_us = nowMicros();
 
-    if (!BNO.getEvent(&orientationData, Adafruit_BNO055::VECTOR_EULER)) {
-        data.sensor_status[3] = 0;
-        return 1;
-    }
-    if (!BNO.getEvent(&angVelocityData, Adafruit_BNO055::VECTOR_GYROSCOPE)) {
-        data.sensor_status[3] = 0;
-        return 1;
-    }
-    if (!BNO.getEvent(&magnetometerData, Adafruit_BNO055::VECTOR_MAGNETOMETER)) {
-        data.sensor_status[3] = 0;
-        return 1;
-    }
-    if (!BNO.getEvent(&accelerometerData, Adafruit_BNO055::VECTOR_ACCELEROMETER)) {
-        data.sensor_status[3] = 0;
+    if (!BNO.read(reading)) {
+        setStatus(SENSOR_BNO, 0);
         return 1;
     }
 
-    imu::Quaternion quat = BNO.getQuat();
-    data.bno_ori_w = quat.w();
-    data.bno_ori_x = quat.x();
-    data.bno_ori_y= quat.y();
-    data.bno_ori_z = quat.z();
+    TelemetryData& out = live.beginWrite();
+    out.bno_ori_w = reading.ori_w;
+    out.bno_ori_x = reading.ori_x;
+    out.bno_ori_y = reading.ori_y;
+    out.bno_ori_z = reading.ori_z;
+
+    out.bno_gyro_x = reading.gyro_x;
+    out.bno_gyro_y = reading.gyro_y;
+    out.bno_gyro_z = reading.gyro_z;
 
-    data.bno_gyro_x = angVelocityData.gyro.x;
-    data.bno_gyro_y = angVelocityData.gyro.y;
-    data.bno_gyro_z = angVelocityData.gyro.z;
+    out.bno_acc_x = reading.acc_x;
+    out.bno_acc_y = reading.acc_y;
+    out.bno_acc_z = reading.acc_z;
 
-    data.bno_acc_x = accelerometerData.acceleration.x;
-    data.bno_acc_y = accelerometerData.acceleration.y;
-    data.bno_acc_z = accelerometerData.acceleration.z;
+    out.bno_mag_x = reading.mag_x;
+    out.bno_mag_y = reading.mag_y;
+    out.bno_mag_z = reading.mag_z;
 
-    data.bno_temp = float(BNO.getTemp());
+    out.bno_temp = reading.temp;
 
-    data.sensor_status[3] = 1;
+    memcpy(out.raw_bno_ori, reading.raw_ori, sizeof(out.raw_bno_ori));
+    memcpy(out.raw_bno_gyro, reading.raw_gyro, sizeof(out.raw_bno_gyro));
+    memcpy(out.raw_bno_acc, reading.raw_acc, sizeof(out.raw_bno_acc));
+    out.raw_bno_temp = reading.raw_temp;
+
+    out.sample_time_us[SENSOR_BNO] = sampleTime_us;
+    out.sensor_status[3] = 1;
+    live.endWrite();
     return 0;
 }
 
 /**
- * Reads Adafruit Ultimate GPS Breakout V3
+ * Reads the GPS
  * It's index in sensorStatus is 4.
- * @param GPS Initialized Sensor instance
- * @return Returns `false` if GPS isn't ready in 500ms or no satellite fix, returns `true` otherwise
+ * @param GPS Initialized device, e.g. `NMEA_GPS` or `SIM_GPS`
+ * @return Returns `false` if there is a satellite fix, returns `true` otherwise
  */
-uint8_t FLIGHT::read_GPS(Adafruit_GPS &GPS) {
+uint8_t FLIGHT::read_GPS(GPS_DEVICE &GPS) {
+    PROFILE_STAGE(profiler, STAGE_READ_GPS);
     last_gps = &GPS;
-    
-    uint32_t startms = millis();
-    uint32_t timeout = startms + 150;
-
-    while (millis() < timeout) {
-        while (GPS.available()) {
-            GPS.read();
-
-            if (GPS.newNMEAreceived()) {
-                // Serial.println(GPS.lastNMEA());
-                if (!GPS.parse(GPS.lastNMEA())) {
-                    continue;
-                }
-
-                if (GPS.fix && GPS.satellites > 0) {
-                    // Serial.print("Satellites: ");
-                    // Serial.println(GPS.satellites);
-                    data.sensor_status[4] = 0;
-                    return 0;
-                }
-            }
-        }
-    }
 
-    data.sensor_status[4] = 1;
-    return 1;
+    // the device only updates what it parsed, keep the rest from last time
+    GpsReading& reading = lastGpsReading;
+    bool hasFix = GPS.read(reading);
+
+    TelemetryData& out = live.beginWrite();
+    out.gps_fix = reading.fix;
+    out.gps_sats = reading.satellites;
+    out.gps_lat = reading.latitudeDegrees;
+    out.gps_lon = reading.longitudeDegrees;
+    out.gps_speed = reading.speed;
+    out.gps_angle = reading.angle;
+    out.gps_alt = reading.altitude;
+    if(hasFix) {
+        out.sample_time_us[SENSOR_GPS] = nowMicros();
+    }
+    out.sensor_status[4] = hasFix ? 0 : 1;
+    live.endWrite();
+    return hasFix ? 0 : 1;
 }
 
+
+// publishes a status change on its own, used on read failures
+void FLIGHT::setStatus(SENSORS sensor, uint8_t status) {
+    live.beginWrite().sensor_status[sensor] = status;
+    live.endWrite();
+}
@@ -0,0 +1,91 @@
+#ifndef SRAD_PHX_SEQLOCK_H
+#define SRAD_PHX_SEQLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+
+// A writer must never be preempted by a spinning reader on the same core,
+// so writers suspend the scheduler (not a mutex, ISRs still run) for the copy.
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#define SEQLOCK_WRITE_ENTER() vTaskSuspendAll()
+#define SEQLOCK_WRITE_EXIT() xTaskResumeAll()
+#else
+#define SEQLOCK_WRITE_ENTER()
+#define SEQLOCK_WRITE_EXIT()
+#endif
+
+/**
+ * @brief sequence-locked value with any number of readers
+ *
+ * Writers bump the sequence to odd, update in place and bump it back to
+ * even; readers copy and retry if the sequence moved. Readers never block
+ * writers and never see a half written `T`. Several writer tasks may each
+ * update their own fields, they are serialized on the sequence itself.
+ * Keep write sections to plain copies, never a bus transfer.
+ */
+template <typename T>
+class SEQLOCK {
+    public:
+        SEQLOCK() : value() {}
+        explicit SEQLOCK(const T& initial) : value(initial) {}
+
+        // returns the value to modify, must be paired with endWrite()
+        T& beginWrite() {
+            SEQLOCK_WRITE_ENTER();
+            uint32_t seq = sequence.load(std::memory_order_relaxed);
+            while((seq & 1) || !sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_relaxed)) {
+                seq = sequence.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            return value;
+        }
+
+        void endWrite() {
+            sequence.fetch_add(1, std::memory_order_release);
+            SEQLOCK_WRITE_EXIT();
+        }
+
+        void write(const T& newValue) {
+            beginWrite() = newValue;
+            endWrite();
+        }
+
+        /**
+         * @brief copies a consistent value
+         * @param out Destination of the copy
+         * @return Returns how many times the copy was retried
+         */
+        uint32_t read(T& out) const {
+            uint32_t retries = 0;
+            while(true) {
+                uint32_t before = sequence.load(std::memory_order_acquire);
+                if(!(before & 1)) {
+                    out = value;
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(sequence.load(std::memory_order_relaxed) == before) {
+                        return retries;
+                    }
+                }
+                retries++;
+            }
+        }
+
+        T read() const {
+            T out;
+            read(out);
+            return out;
+        }
+
+        // changes on every write, odd while a write is in progress
+        uint32_t version() const {
+            return sequence.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic<uint32_t> sequence{0};
+        T value;
+};
+
+#endif
@@ -16,9 +16,14 @@
  * 
  * The function uses a cascading switch case to determine which stage
  * of flight the rocket is in. At each stage, it calls a helper function
- * to determine if it should move to the next one.
+ * to determine if it should move to the next one. The helpers all work
+ * on one consistent snapshot of the sensor data taken here.
  */
 void FLIGHT::calculateState() {
+    PROFILE_STAGE(profiler, STAGE_CALCULATE_STATE);
+    live.read(data);
+    updateFusion();
+
     switch(STATE) {
         case(STATES::PRE_NO_CAL):
             AltitudeCalibrate(); //check altitude offset and set it
@@ -31,6 +36,8 @@ void FLIGHT::calculateState() {
             AltitudeCalibrate(); //check altitude offset and set it
             if(isAscent()) {
                 STATE = STATES::FLIGHT_ASCENT;
+                liftoff_us = runningTime_us;
+                apogee.reset();
             }
             break;
 
@@ -48,6 +55,7 @@ void FLIGHT::calculateState() {
         case STATES::POST_LANDED:
             break;
     }
+    saveResume();
 }
 /**
  * Helper function to check if sensors are calibrated
@@ -65,27 +73,27 @@ bool FLIGHT::isCal() {
  * @return returns true if rocket is ascending
  */
 bool FLIGHT::isAscent() {
-    static uint32_t liftoffTimer_ms;
+    uint32_t liftoffThreshold_us = accel_liftoff_time_threshold * 1000;
     if(data.sensor_status[0] == 1) {
         if(data.lsm_acc_z > accel_liftoff_threshold) {
-            liftoffTimer_ms += deltaTime_ms;
+            liftoffTimer_us += deltaTime_us;
 
-            if(liftoffTimer_ms  > accel_liftoff_time_threshold) {
+            if(liftoffTimer_us  > liftoffThreshold_us) {
                 return true;
             }
         } else {
-            liftoffTimer_ms = 0;
+            liftoffTimer_us = 0;
         }
     } else if (data.sensor_status[2] == 1) {  // if primary accel is known to be bad, check secondary
-        if(data.lsm_acc_z > accel_liftoff_threshold) {
-            liftoffTimer_ms += deltaTime_ms;
+        if(data.adxl_acc_z > accel_liftoff_threshold) {
+            liftoffTimer_us += deltaTime_us;
 
-            if(liftoffTimer_ms  > accel_liftoff_time_threshold) {
+            if(liftoffTimer_us  > liftoffThreshold_us) {
                 return true;
             }
         } 
         else {
-            liftoffTimer_ms = 0;
+            liftoffTimer_us = 0;
         }
     } else {  // if both accelerometers are bad, use altimeter
         // check if altitude is notably higher than 0 (or alt threshold)
@@ -93,27 +101,93 @@ bool FLIGHT::isAscent() {
     return false;
 }
 
+/**
+ * Helper function to check if rocket has passed apogee
+ * Feeds every new BMP sample since liftoff to the trend detector,
+ * constant time per sample. Apogee is judged on the fused vertical
+ * velocity while `FUSION` is valid, else on the least-squares fit of
+ * the BMP altitudes. See `APOGEE`, `getApogee()` and `getFusion()`.
+ * @return returns true once the vertical velocity is descending
+ */
 bool FLIGHT::isDescent() {
     // use altimeter primarily to detect apogee based off of trend in data
-    if(data.sensor_status[1] == 1) { // TODO: fix whole if bock to use uint8
-        uint8_t desc_samples = 0;                                   // tracks the number of samples with a descending delta
-        Serial.println("made it to for loop");
-        for(int i = 0; i < 9; i++) {
-            Serial.print("loop iteration: "); Serial.println(i);
-            uint8_t index1 = (altReadings_ind + i + 1) % 10;        // get an index, starting with our oldest value
-            uint8_t index2 = (altReadings_ind + i + 2) % 10;        // get the value after the first index
-            if(altReadings[index1] - altReadings[index2] > 0.5 ) {  // change 0.5 based on noise values from lab testing
-                desc_samples++;
+    if(data.sensor_status[SENSOR_BMP] == 1) {
+        uint64_t sample_us = data.sample_time_us[SENSOR_BMP];
+        // samples from before liftoff were logged before alt_offset was applied
+        if(sample_us != lastBaroSample_us && sample_us >= liftoff_us) {
+            lastBaroSample_us = sample_us;
+            if(fusion.driveApogee && !resumedInFlight && fusion.isValid(sample_us)) {
+                return apogee.update(sample_us, data.bmp_alt, data.ekf_vel);
             }
-        }
-        if(desc_samples > 7) {
-            return true;
+            return apogee.update(sample_us, data.bmp_alt);
         }
     } // add backup sensor here
 
     return false;
 }
 
+/**
+ * @brief feeds new IMU and BMP samples to `fusion` and publishes its estimate
+ *
+ * Runs once per new LSM6DSO32 sample in the snapshot, so call
+ * `calculateState()` at least at the IMU rate. The ADXL375 stands in when
+ * the LSM6DSO32 has failed or any of its axes nears full scale. The cost
+ * of each update is booked against `FUSION::budget_us`.
+ */
+void FLIGHT::updateFusion() {
+    PROFILE_STAGE(profiler, STAGE_FUSION);
+    uint32_t start = nowCycles();
+    bool lsmOk = data.sensor_status[SENSOR_LSM] == 1;
+    bool adxlOk = data.sensor_status[SENSOR_ADXL] == 1;
+    uint64_t imu_us = lsmOk ? data.sample_time_us[SENSOR_LSM] : (adxlOk ? data.sample_time_us[SENSOR_ADXL] : 0);
+    bool fused = false;
+
+    if(imu_us && imu_us != lastImuSample_us) {
+        lastImuSample_us = imu_us;
+        float gyro[3] = {data.lsm_gyro_x, data.lsm_gyro_y, data.lsm_gyro_z};
+        float lsmAcc[3] = {data.lsm_acc_x, data.lsm_acc_y, data.lsm_acc_z};
+        float adxlAcc[3] = {data.adxl_acc_x, data.adxl_acc_y, data.adxl_acc_z};
+        float saturation = 0.95f * fusion.imuRange;
+        bool saturated = fabsf(lsmAcc[0]) > saturation || fabsf(lsmAcc[1]) > saturation
+                      || fabsf(lsmAcc[2]) > saturation;
+        bool highG = adxlOk && (!lsmOk || saturated);
+
+        fusion.predict(imu_us, lsmOk ? gyro : nullptr, highG ? adxlAcc : lsmAcc, highG);
+        if(lsmOk && !saturated) {
+            fusion.correctAttitude(lsmAcc);
+        }
+        fused = true;
+    }
+    if(data.sensor_status[SENSOR_BMP] == 1 && data.sample_time_us[SENSOR_BMP] != lastFusedBaro_us) {
+        lastFusedBaro_us = data.sample_time_us[SENSOR_BMP];
+        fusion.correctAltitude(pressureAltitude(data.bmp_press, 1013.25));     // same reference as alt_offset
+        fused = true;
+    }
+    if(!fused) {
+        return;
+    }
+
+    float q[4];
+    fusion.attitude(q);
+    data.ekf_ori_w = q[0];
+    data.ekf_ori_x = q[1];
+    data.ekf_ori_y = q[2];
+    data.ekf_ori_z = q[3];
+    data.ekf_vel = fusion.velocity();
+    data.ekf_alt = fusion.altitude() - alt_offset;
+
+    TelemetryData& out = live.beginWrite();
+    out.ekf_ori_w = data.ekf_ori_w;
+    out.ekf_ori_x = data.ekf_ori_x;
+    out.ekf_ori_y = data.ekf_ori_y;
+    out.ekf_ori_z = data.ekf_ori_z;
+    out.ekf_vel = data.ekf_vel;
+    out.ekf_alt = data.ekf_alt;
+    live.endWrite();
+
+    fusion.recordCycles(nowCycles() - start, cyclesPerMicro());
+}
+
 bool FLIGHT::isLanded() {
     if(data.sensor_status[0] == 1) {
         if (data.adxl_acc_z < 2 && data.adxl_acc_z >= 0){
@@ -141,3 +215,73 @@ void FLIGHT::AltitudeCalibrate() {
     alt_offset = data.bmp_alt;
 }
 
+
+/**
+ * @brief keeps what a warm restart needs in RTC memory, see `resume()`
+ *
+ * Saves on every state change and every BMP sample the apogee window
+ * took, and at least every `resumeInterval_us` so flight time is never
+ * set back by more than that.
+ */
+void FLIGHT::saveResume() {
+    if(STATE == resumeSavedState && lastBaroSample_us == resumeSavedBaro_us
+       && runningTime_us - lastResumeSave_us < resumeInterval_us) {
+        return;
+    }
+    PROFILE_STAGE(profiler, STAGE_RESUME_SAVE);
+    FlightResume resume;
+    resume.time_us = runningTime_us;
+    resume.liftoff_us = liftoff_us;
+    resume.lastBaroSample_us = lastBaroSample_us;
+    resume.deltaTime_us = deltaTime_us;
+    resume.liftoffTimer_us = liftoffTimer_us;
+    resume.alt_offset = alt_offset;
+    resume.state = STATE;
+    resume.calibrated = calibrated;
+    resume.apogee = apogee;
+    resumeSave(resume);
+
+    lastResumeSave_us = runningTime_us;
+    resumeSavedState = STATE;
+    resumeSavedBaro_us = lastBaroSample_us;
+}
+
+/**
+ * @brief picks the flight up where a brownout or watchdog reset cut it off
+ * @return Returns `true` if it did; `false` after a power-on, or if nothing worth resuming was saved
+ *
+ * Call once at boot, after configuring the FLIGHT and before the first
+ * `incrementTime()`. It restores `STATE`, `alt_offset`, the apogee window
+ * and the liftoff timing, and sets `timeBase_us` so flight time goes on
+ * from the last save: sample times stay increasing and no calibration
+ * runs at altitude. `FUSION` starts over, and apogee is judged on the BMP
+ * fit for the rest of the flight: attitude can't be aligned under thrust. The log
+ * is the writer's to resume, see `FLIGHT_FILE::resume()`.
+ */
+bool FLIGHT::resume() {
+    FlightResume resume;
+    if(!resumeLoad(resume) || resume.state == STATES::PRE_NO_CAL || resume.state > STATES::POST_LANDED) {
+        return false;
+    }
+    timeBase_us = resume.time_us;
+    runningTime_us = resume.time_us;
+    deltaTime_us = resume.deltaTime_us;
+    liftoff_us = resume.liftoff_us;
+    liftoffTimer_us = resume.liftoffTimer_us;
+    lastBaroSample_us = resume.lastBaroSample_us;
+    alt_offset = resume.alt_offset;
+    calibrated = resume.calibrated;
+    apogee = resume.apogee;
+    STATE = STATES(resume.state);
+    resumedInFlight = STATE == STATES::FLIGHT_ASCENT || STATE == STATES::FLIGHT_DESCENT;
+
+    lastResumeSave_us = runningTime_us;
+    resumeSavedState = STATE;
+    resumeSavedBaro_us = lastBaroSample_us;
+    return true;
+}
+
+// flight time a warm restart may lose, 0 saves every loop
+void FLIGHT::setResumeInterval(uint32_t interval_us) {
+    resumeInterval_us = interval_us;
+}
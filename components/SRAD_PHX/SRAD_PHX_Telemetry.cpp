@@ -0,0 +1,467 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <esp_rom_crc.h>
+
+#include "SRAD_PHX_Telemetry.h"
+
+#define QUAT_SCALE 46340.0f         // 32767 * sqrt(2): +-1/sqrt(2) fills the int16
+
+static_assert(TELEMETRY_FRAME_MAX <= 255, "a telemetry frame must fit one LoRa packet");
+
+// MSB first, `out` zeroed beforehand; a byte's worth of bits at a time
+static void putBits(uint8_t* out, uint32_t& bit, uint32_t value, uint8_t bits) {
+    while(bits) {
+        uint8_t room = 8 - bit % 8;
+        uint8_t take = bits < room ? bits : room;
+        bits -= take;
+        uint8_t chunk = (value >> bits) & ((1U << take) - 1);
+        out[bit / 8] |= chunk << (room - take);
+        bit += take;
+    }
+}
+
+static uint32_t getBits(const uint8_t* in, uint32_t& bit, uint8_t bits) {
+    uint32_t value = 0;
+    while(bits) {
+        uint8_t room = 8 - bit % 8;
+        uint8_t take = bits < room ? bits : room;
+        bits -= take;
+        value = (value << take) | ((in[bit / 8] >> (room - take)) & ((1U << take) - 1));
+        bit += take;
+    }
+    return value;
+}
+
+// rounds to the nearest count and clamps to the field's range, NaN sends 0;
+// in double so 32 bit fields (GPS at 1e-7 degrees) keep every count
+static uint32_t quantize(float value, float resolution, uint8_t bits, bool isSigned) {
+    double lowest = isSigned ? -double(1ULL << (bits - 1)) : 0.0;
+    double highest = isSigned ? double(1ULL << (bits - 1)) - 1 : double((1ULL << bits) - 1);
+    double counts = double(value) / resolution;
+    if(!(counts == counts)) {
+        counts = 0;
+    }
+    counts = round(counts);
+    counts = counts < lowest ? lowest : (counts > highest ? highest : counts);
+    return uint32_t(int64_t(counts));
+}
+
+static float dequantize(uint32_t counts, float resolution, uint8_t bits, bool isSigned) {
+    if(isSigned && bits < 32 && (counts >> (bits - 1)) & 1) {
+        counts |= ~((1UL << bits) - 1);     // sign extend
+    }
+    return (isSigned ? double(int32_t(counts)) : double(counts)) * resolution;
+}
+
+// the field's value in counts, as it is packed
+static uint32_t fieldCounts(const PacketField& field, const SampleRecord& sample) {
+    const uint8_t* value = (const uint8_t*)&sample + field.offset;
+    if(field.type == FIELD_U64) {
+        uint64_t number;
+        memcpy(&number, value, sizeof(number));
+        return uint32_t(number / uint64_t(field.resolution));
+    } else if(field.type == FIELD_U8) {
+        uint8_t number = *value;
+        uint32_t highest = (1UL << field.bits) - 1;
+        return field.bits == 1 ? number != 0 : (number > highest ? highest : number);
+    }
+    float number;
+    memcpy(&number, value, sizeof(number));
+    return quantize(number, field.resolution, field.bits, field.isSigned);
+}
+
+static void setField(const PacketField& field, uint32_t counts, SampleRecord& sample) {
+    uint8_t* value = (uint8_t*)&sample + field.offset;
+    if(field.type == FIELD_U64) {
+        uint64_t number = uint64_t(counts) * uint64_t(field.resolution);
+        memcpy(value, &number, sizeof(number));
+    } else if(field.type == FIELD_U8) {
+        *value = uint8_t(counts);
+    } else {
+        float number = dequantize(counts, field.resolution, field.bits, field.isSigned);
+        memcpy(value, &number, sizeof(number));
+    }
+}
+
+static void unitQuat(const TelemetryData& data, float* q) {
+    q[0] = data.bno_ori_w;
+    q[1] = data.bno_ori_x;
+    q[2] = data.bno_ori_y;
+    q[3] = data.bno_ori_z;
+    float norm = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if(!(norm > 0)) {
+        q[0] = 1;                           // no attitude yet, sent as identity
+        q[1] = q[2] = q[3] = 0;
+        return;
+    }
+    for(uint8_t ind = 0; ind < 4; ind++) {
+        q[ind] /= norm;
+    }
+}
+
+// smallest three: drop the largest component, its sign is made positive
+static void packQuat(const TelemetryData& data, uint8_t* out, uint32_t& bit) {
+    float q[4];
+    unitQuat(data, q);
+    uint8_t largest = 0;
+    for(uint8_t ind = 1; ind < 4; ind++) {
+        if(fabsf(q[ind]) > fabsf(q[largest])) {
+            largest = ind;
+        }
+    }
+    float sign = q[largest] < 0 ? -1.0f : 1.0f;
+    putBits(out, bit, largest, 2);
+    for(uint8_t ind = 0; ind < 4; ind++) {
+        if(ind != largest) {
+            putBits(out, bit, quantize(sign * q[ind], 1.0f / QUAT_SCALE, 16, true), 16);
+        }
+    }
+}
+
+static void unpackQuat(const uint8_t* in, uint32_t& bit, TelemetryData& data) {
+    float q[4];
+    uint8_t largest = getBits(in, bit, 2);
+    float squares = 0;
+    for(uint8_t ind = 0; ind < 4; ind++) {
+        if(ind != largest) {
+            q[ind] = dequantize(getBits(in, bit, 16), 1.0f / QUAT_SCALE, 16, true);
+            squares += q[ind] * q[ind];
+        }
+    }
+    q[largest] = squares < 1 ? sqrtf(1 - squares) : 0;
+    data.bno_ori_w = q[0];
+    data.bno_ori_x = q[1];
+    data.bno_ori_y = q[2];
+    data.bno_ori_z = q[3];
+}
+
+size_t telemetryEncode(const SampleRecord& sample, uint16_t sequence, uint8_t* out) {
+    bool gps = sample.data.gps_fix;
+    size_t size = gps ? TELEMETRY_FRAME_MAX : TELEMETRY_FRAME_BYTES;
+    memset(out, 0, size);
+    uint32_t bit = 0;
+    putBits(out, bit, TELEMETRY_FRAME_SAMPLE, 8);
+    putBits(out, bit, sequence, 16);
+    for(const PacketField& field : PACKET_FIELDS) {
+        putBits(out, bit, fieldCounts(field, sample), field.bits);
+    }
+    packQuat(sample.data, out, bit);
+    if(gps) {
+        putBits(out, bit, quantize(sample.data.gps_lat, 1e-7f, 32, true), 32);
+        putBits(out, bit, quantize(sample.data.gps_lon, 1e-7f, 32, true), 32);
+        putBits(out, bit, quantize(sample.data.gps_alt, 1.0f, 16, true), 16);
+    }
+    uint16_t crc = esp_rom_crc16_le(0, out, size - 2);
+    out[size - 2] = crc & 0xFF;
+    out[size - 1] = crc >> 8;
+    return size;
+}
+
+bool telemetryDecode(const uint8_t* frame, size_t size, SampleRecord& sample, uint16_t& sequence) {
+    if(size < TELEMETRY_FRAME_BYTES || frame[0] != TELEMETRY_FRAME_SAMPLE) {
+        return false;
+    }
+    uint16_t crc = esp_rom_crc16_le(0, frame, size - 2);
+    if(frame[size - 2] != (crc & 0xFF) || frame[size - 1] != (crc >> 8)) {
+        return false;
+    }
+
+    memset(&sample, 0, sizeof(sample));
+    uint32_t bit = 8;
+    sequence = getBits(frame, bit, 16);
+    for(const PacketField& field : PACKET_FIELDS) {
+        setField(field, getBits(frame, bit, field.bits), sample);
+    }
+    if(size != (sample.data.gps_fix ? TELEMETRY_FRAME_MAX : TELEMETRY_FRAME_BYTES)) {
+        return false;
+    }
+    unpackQuat(frame, bit, sample.data);
+    if(sample.data.gps_fix) {
+        sample.data.gps_lat = dequantize(getBits(frame, bit, 32), 1e-7f, 32, true);
+        sample.data.gps_lon = dequantize(getBits(frame, bit, 32), 1e-7f, 32, true);
+        sample.data.gps_alt = dequantize(getBits(frame, bit, 16), 1.0f, 16, true);
+    }
+    return true;
+}
+
+#define QUAT_BATCH_SCALE 32767.0f   // a batch sends all four components
+#define BATCH_HEADER_BITS (8 + 16 + 8)
+
+static uint8_t channelBits(uint8_t channel) {
+    if(channel < PACKET_FIELD_COUNT) {
+        return PACKET_FIELDS[channel].bits;
+    }
+    channel -= PACKET_FIELD_COUNT;
+    return channel < 4 ? 16 : (channel < 6 ? 32 : 16);     // quaternion, lat/lon, GPS altitude
+}
+
+// bits a width of 0 to `bits` is sent in
+static uint8_t widthCodeBits(uint8_t bits) {
+    uint8_t code = 0;
+    while((1U << code) <= bits) {
+        code++;
+    }
+    return code;
+}
+
+static uint32_t fieldMask(uint8_t bits) {
+    return bits >= 32 ? 0xFFFFFFFFUL : (1UL << bits) - 1;
+}
+
+// difference wrapped to the channel's width, then sign extended
+static int32_t wrapDelta(uint32_t value, uint32_t base, uint8_t bits) {
+    uint32_t delta = (value - base) & fieldMask(bits);
+    if(bits < 32 && (delta >> (bits - 1)) & 1) {
+        delta |= ~fieldMask(bits);
+    }
+    return int32_t(delta);
+}
+
+// fewest two's complement bits that hold `delta`, none for 0
+static uint8_t deltaWidth(int32_t delta) {
+    if(delta == 0) {
+        return 0;
+    }
+    uint8_t width = 1;
+    while(delta < -(int64_t(1) << (width - 1)) || delta > (int64_t(1) << (width - 1)) - 1) {
+        width++;
+    }
+    return width;
+}
+
+static size_t batchBytes(uint8_t samples, uint32_t sampleBits) {
+    uint32_t bits = BATCH_HEADER_BITS;
+    for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+        bits += channelBits(channel) + widthCodeBits(channelBits(channel));
+    }
+    bits += (samples - 1) * sampleBits;
+    return (bits + 7) / 8 + 2;
+}
+
+// every channel's counts; the quaternion takes the sign that keeps it nearest the base's
+static void sampleCounts(const SampleRecord& sample, const uint32_t* base, uint32_t* counts) {
+    for(uint8_t field = 0; field < PACKET_FIELD_COUNT; field++) {
+        counts[field] = fieldCounts(PACKET_FIELDS[field], sample);
+    }
+    float q[4];
+    unitQuat(sample.data, q);
+    float dot = q[0];
+    if(base) {
+        dot = 0;
+        for(uint8_t ind = 0; ind < 4; ind++) {
+            dot += q[ind] * int16_t(base[PACKET_FIELD_COUNT + ind]);
+        }
+    }
+    float sign = dot < 0 ? -1.0f : 1.0f;
+    for(uint8_t ind = 0; ind < 4; ind++) {
+        counts[PACKET_FIELD_COUNT + ind] = quantize(sign * q[ind], 1.0f / QUAT_BATCH_SCALE, 16, true);
+    }
+    counts[PACKET_FIELD_COUNT + 4] = quantize(sample.data.gps_lat, 1e-7f, 32, true);
+    counts[PACKET_FIELD_COUNT + 5] = quantize(sample.data.gps_lon, 1e-7f, 32, true);
+    counts[PACKET_FIELD_COUNT + 6] = quantize(sample.data.gps_alt, 1.0f, 16, true);
+}
+
+static void setSample(const uint32_t* counts, SampleRecord& sample) {
+    memset(&sample, 0, sizeof(sample));
+    for(uint8_t field = 0; field < PACKET_FIELD_COUNT; field++) {
+        setField(PACKET_FIELDS[field], counts[field], sample);
+    }
+    float q[4];
+    float squares = 0;
+    for(uint8_t ind = 0; ind < 4; ind++) {
+        q[ind] = dequantize(counts[PACKET_FIELD_COUNT + ind], 1.0f / QUAT_BATCH_SCALE, 16, true);
+        squares += q[ind] * q[ind];
+    }
+    float norm = squares > 0 ? sqrtf(squares) : 1;
+    sample.data.bno_ori_w = q[0] / norm;
+    sample.data.bno_ori_x = q[1] / norm;
+    sample.data.bno_ori_y = q[2] / norm;
+    sample.data.bno_ori_z = q[3] / norm;
+    sample.data.gps_lat = dequantize(counts[PACKET_FIELD_COUNT + 4], 1e-7f, 32, true);
+    sample.data.gps_lon = dequantize(counts[PACKET_FIELD_COUNT + 5], 1e-7f, 32, true);
+    sample.data.gps_alt = dequantize(counts[PACKET_FIELD_COUNT + 6], 1.0f, 16, true);
+}
+
+/**
+ * @brief every state starts at every sample kept, as many per frame as fit
+ * @param maxLength Longest frame, at most a LoRa packet; raised to what one sample needs
+ */
+TELEMETRY_BATCH::TELEMETRY_BATCH(size_t frameLength) {
+    size_t smallest = batchBytes(1, 0);
+    maxLength = frameLength > 255 ? 255 : (frameLength < smallest ? smallest : frameLength);
+    for(BatchRate& rate : rates) {
+        rate = {1, SRAD_PHX_TELEMETRY_BATCH};
+    }
+    memset(widths, 0, sizeof(widths));
+}
+
+/**
+ * @brief sets the decimation and frame size for one flight state
+ * @param state Flight state the samples are in
+ * @param every Keep one sample in this many, 1 keeps all
+ * @param samples Samples per frame, 1 to `SRAD_PHX_TELEMETRY_BATCH`; fewer go out when the frame is full
+ */
+void TELEMETRY_BATCH::setRate(STATES state, uint16_t every, uint8_t samples) {
+    rates[state].every = every ? every : 1;
+    rates[state].samples = samples < 1 ? 1 : (samples > SRAD_PHX_TELEMETRY_BATCH ? SRAD_PHX_TELEMETRY_BATCH : samples);
+}
+
+// a state past POST_LANDED is taken as PRE_NO_CAL
+const BatchRate& TELEMETRY_BATCH::rateFor(uint8_t state) const {
+    return rates[state <= POST_LANDED ? state : 0];
+}
+
+// frame length with one more sample of these deltas, or as it is for nullptr
+size_t TELEMETRY_BATCH::bytesWith(const int32_t* next) const {
+    uint32_t sampleBits = 0;
+    for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+        uint8_t width = next ? deltaWidth(next[channel]) : 0;
+        sampleBits += width > widths[channel] ? width : widths[channel];
+    }
+    return batchBytes(count + (next ? 1 : 0), sampleBits);
+}
+
+/**
+ * @brief hands one sample in, e.g. each one popped from a FlightRing
+ * @param sample The record
+ * @param out At least `maxLength` bytes
+ * @return Returns the length of the frame finished in `out`, 0 if none was
+ *
+ * At most one frame comes out per call. A sample that starts a frame
+ * right after another one went out, in a state that sends single-sample
+ * frames, goes out with the next call or `flush()`.
+ */
+size_t TELEMETRY_BATCH::add(const SampleRecord& sample, uint8_t* out) {
+    uint8_t state = sample.state;
+    bool changed = state != lastState;
+    lastState = state;
+    if(!changed && ++sinceKept < rateFor(state).every) {
+        return 0;
+    }
+    sinceKept = 0;
+
+    size_t length = 0;
+    int32_t next[TELEMETRY_CHANNELS];
+    if(count) {
+        uint32_t counts[TELEMETRY_CHANNELS];
+        sampleCounts(sample, base, counts);
+        for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+            next[channel] = wrapDelta(counts[channel], base[channel], channelBits(channel));
+        }
+        if(count >= rateFor(batchState).samples || count >= SRAD_PHX_TELEMETRY_BATCH || bytesWith(next) > maxLength) {
+            length = encode(out);
+        }
+    }
+
+    if(count == 0) {
+        sampleCounts(sample, nullptr, base);
+        memset(widths, 0, sizeof(widths));
+        batchState = state;
+        count = 1;
+    } else {
+        for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+            uint8_t width = deltaWidth(next[channel]);
+            widths[channel] = width > widths[channel] ? width : widths[channel];
+            deltas[count][channel] = next[channel];
+        }
+        count++;
+    }
+
+    if(length == 0 && (count >= rateFor(batchState).samples || state != batchState)) {
+        length = encode(out);
+    }
+    return length;
+}
+
+/**
+ * @brief finishes the frame being filled, e.g. on landing or before a reset
+ * @param out At least `maxLength` bytes
+ * @return Returns the frame's length, 0 if no sample was waiting
+ */
+size_t TELEMETRY_BATCH::flush(uint8_t* out) {
+    return count ? encode(out) : 0;
+}
+
+size_t TELEMETRY_BATCH::encode(uint8_t* out) {
+    size_t size = bytesWith(nullptr);
+    memset(out, 0, size);
+    uint32_t bit = 0;
+    putBits(out, bit, TELEMETRY_FRAME_BATCH, 8);
+    putBits(out, bit, sequence++, 16);
+    putBits(out, bit, count, 8);
+    for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+        putBits(out, bit, base[channel], channelBits(channel));
+    }
+    for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+        putBits(out, bit, widths[channel], widthCodeBits(channelBits(channel)));
+    }
+    for(uint8_t sample = 1; sample < count; sample++) {
+        for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+            putBits(out, bit, uint32_t(deltas[sample][channel]), widths[channel]);
+        }
+    }
+    uint16_t crc = esp_rom_crc16_le(0, out, size - 2);
+    out[size - 2] = crc & 0xFF;
+    out[size - 1] = crc >> 8;
+    count = 0;
+    return size;
+}
+
+size_t telemetryDecodeBatch(const uint8_t* frame, size_t size, SampleRecord* samples, size_t maxSamples,
+                            uint16_t& sequence) {
+    if(size < batchBytes(1, 0) || frame[0] != TELEMETRY_FRAME_BATCH) {
+        return 0;
+    }
+    uint16_t crc = esp_rom_crc16_le(0, frame, size - 2);
+    if(frame[size - 2] != (crc & 0xFF) || frame[size - 1] != (crc >> 8)) {
+        return 0;
+    }
+
+    uint32_t bit = 8;
+    sequence = getBits(frame, bit, 16);
+    uint8_t count = getBits(frame, bit, 8);
+    if(count == 0 || count > maxSamples) {
+        return 0;
+    }
+    uint32_t base[TELEMETRY_CHANNELS];
+    uint8_t widths[TELEMETRY_CHANNELS];
+    uint32_t sampleBits = 0;
+    for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+        base[channel] = getBits(frame, bit, channelBits(channel));
+    }
+    for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+        widths[channel] = getBits(frame, bit, widthCodeBits(channelBits(channel)));
+        if(widths[channel] > channelBits(channel)) {
+            return 0;
+        }
+        sampleBits += widths[channel];
+    }
+    if(size != batchBytes(count, sampleBits)) {
+        return 0;
+    }
+
+    setSample(base, samples[0]);
+    for(uint8_t sample = 1; sample < count; sample++) {
+        uint32_t counts[TELEMETRY_CHANNELS];
+        for(uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+            uint8_t width = widths[channel];
+            uint32_t delta = width ? getBits(frame, bit, width) : 0;
+            if(width && width < 32 && (delta >> (width - 1)) & 1) {
+                delta |= ~fieldMask(width);     // sign extend
+            }
+            counts[channel] = (base[channel] + delta) & fieldMask(channelBits(channel));
+        }
+        setSample(counts, samples[sample]);
+    }
+    return count;
+}
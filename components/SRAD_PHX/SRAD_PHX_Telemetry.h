@@ -0,0 +1,187 @@
+#ifndef SRAD_PHX_TELEMETRY_H
+#define SRAD_PHX_TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_Fields.h"
+
+// Downlink telemetry frame, see README "Telemetry codec". Every field is
+// quantized to its own resolution and packed MSB first into as many bits
+// as it needs:
+//
+//   type 'T'  sequence u16  PACKET_FIELDS...  quaternion  [GPS block]  CRC16
+//
+// The quaternion is smallest-three: 2 bits for the index of the largest
+// component, the other three as int16 in [-1/sqrt(2), 1/sqrt(2)]. The GPS
+// block (lat/lon int32 at 1e-7 degrees, altitude int16 in meters) is only
+// there when gps_fix is set. The CRC16 (esp_rom_crc16_le) covers every byte
+// before it; the frame is zero padded to a whole byte first.
+
+#define TELEMETRY_FRAME_SAMPLE 'T'
+#define TELEMETRY_FRAME_BATCH 'A'
+
+// samples one TELEMETRY_BATCH frame holds at most, override before including
+#ifndef SRAD_PHX_TELEMETRY_BATCH
+#define SRAD_PHX_TELEMETRY_BATCH 16
+#endif
+
+struct PacketField {
+    const char* name;               // the member's, the decoder's CSV column
+    uint16_t offset;                // in SampleRecord
+    uint8_t type;                   // FIELD_TYPES
+    uint8_t bits;
+    bool isSigned;                  // two's complement, otherwise unsigned
+    float resolution;               // value of one count, in the member's units
+};
+
+#define PACKET_RECORD(member, type, bits, resolution) \
+    {#member, FIELD_AT(member), type, bits, false, resolution}
+#define PACKET_DATA(member, type, bits, isSigned, resolution) \
+    {#member, FIELD_AT(data.member), type, bits, isSigned, resolution}
+#define PACKET_FLOAT(member, bits, resolution) PACKET_DATA(member, FIELD_F32, bits, true, resolution)
+#define PACKET_STATUS(name, index) {name, FIELD_AT(data.sensor_status[index]), FIELD_U8, 1, false, 1.0f}
+
+// a value past a field's range is sent as the nearest end of it, time_us wraps every 49 days
+inline constexpr PacketField PACKET_FIELDS[] = {
+    PACKET_RECORD(time_us, FIELD_U64, 32, 1000.0f),             // ms
+    PACKET_RECORD(state, FIELD_U8, 3, 1.0f),
+    PACKET_STATUS("lsm", SENSOR_LSM),
+    PACKET_STATUS("bmp", SENSOR_BMP),
+    PACKET_STATUS("adxl", SENSOR_ADXL),
+    PACKET_STATUS("bno", SENSOR_BNO),
+    PACKET_STATUS("gps", SENSOR_GPS),
+    PACKET_DATA(gps_fix, FIELD_U8, 1, false, 1.0f),
+    PACKET_DATA(gps_sats, FIELD_U8, 5, false, 1.0f),
+
+    PACKET_FLOAT(bmp_alt, 24, 0.1f),                            // m, +-838 km
+    PACKET_FLOAT(ekf_alt, 24, 0.1f),
+    PACKET_FLOAT(ekf_vel, 16, 0.1f),                            // m/s, +-3276
+    PACKET_DATA(bmp_press, FIELD_F32, 17, false, 1.0f),         // Pa, to 131 kPa
+
+    PACKET_FLOAT(adxl_acc_x, 16, 0.1f),                         // m/s^2, +-334 g
+    PACKET_FLOAT(adxl_acc_y, 16, 0.1f),
+    PACKET_FLOAT(adxl_acc_z, 16, 0.1f),
+    PACKET_FLOAT(bno_gyro_x, 16, 0.002f),                       // rad/s, +-65
+    PACKET_FLOAT(bno_gyro_y, 16, 0.002f),
+    PACKET_FLOAT(bno_gyro_z, 16, 0.002f),
+
+    PACKET_FLOAT(lsm_temp, 8, 1.0f),                            // degrees C, -128 to 127
+    PACKET_FLOAT(adxl_temp, 8, 1.0f),
+    PACKET_FLOAT(bno_temp, 8, 1.0f),
+    PACKET_FLOAT(bmp_temp, 8, 1.0f),
+};
+
+#define PACKET_FIELD_COUNT (sizeof(PACKET_FIELDS) / sizeof(PACKET_FIELDS[0]))
+#define PACKET_QUAT_BITS (2 + 3 * 16)
+#define PACKET_GPS_BITS (32 + 32 + 16)
+
+inline constexpr uint32_t packetFieldBits() {
+    uint32_t bits = 0;
+    for(size_t field = 0; field < PACKET_FIELD_COUNT; field++) {
+        bits += PACKET_FIELDS[field].bits;
+    }
+    return bits;
+}
+
+inline constexpr size_t packetBytes(bool gps) {
+    return (8 + 16 + packetFieldBits() + PACKET_QUAT_BITS + (gps ? PACKET_GPS_BITS : 0) + 7) / 8 + 2;
+}
+
+#define TELEMETRY_FRAME_BYTES packetBytes(false)
+#define TELEMETRY_FRAME_MAX packetBytes(true)
+
+/**
+ * @brief quantizes one record into a downlink frame
+ * @param sample The record, e.g. the newest one popped from a FlightRing
+ * @param sequence Frame counter, lets the ground count lost frames
+ * @param out At least `TELEMETRY_FRAME_MAX` bytes
+ * @return Returns the frame length, `TELEMETRY_FRAME_BYTES` or `TELEMETRY_FRAME_MAX` with a GPS fix
+ */
+size_t telemetryEncode(const SampleRecord& sample, uint16_t sequence, uint8_t* out);
+
+/**
+ * @brief unpacks a frame back into a record
+ * @param frame As received
+ * @param size Its length
+ * @param sample Filled with the sent fields at their resolution, everything else zeroed
+ * @param sequence The frame's counter
+ * @return Returns `false` if the frame is not a telemetry frame, has the wrong length or fails its CRC
+ */
+bool telemetryDecode(const uint8_t* frame, size_t size, SampleRecord& sample, uint16_t& sequence);
+
+// what a TELEMETRY_BATCH frame packs per sample: PACKET_FIELDS, the
+// quaternion's four components and the GPS block
+#define TELEMETRY_CHANNELS (PACKET_FIELD_COUNT + 4 + 3)
+
+struct BatchRate {
+    uint16_t every;                 // keep one sample in this many
+    uint8_t samples;                // per frame, at most SRAD_PHX_TELEMETRY_BATCH
+};
+
+/**
+ * @brief packs several decimated samples into one downlink frame
+ *
+ * Every LoRa packet pays for its preamble and header, which is most of
+ * the airtime of a single-sample frame. A batch frame pays it once for up
+ * to `SRAD_PHX_TELEMETRY_BATCH` samples:
+ *
+ *   type 'A'  sequence u16  count u8  base  widths  deltas...  CRC16
+ *
+ * The first sample is the base, quantized like a 'T' frame's fields, with
+ * the quaternion as four int16 at 1/32767 and the GPS block always there.
+ * Every later sample is sent as each channel's difference from the base,
+ * wrapped to the channel's width. Each channel has one width for the whole
+ * frame, the fewest bits that hold all its differences, so a channel that
+ * didn't change costs nothing past its width.
+ *
+ * `setRate()` picks the decimation and the samples per frame for each
+ * flight state. A frame goes out when it has its samples, when the next
+ * one would not fit `maxLength`, or at a change of state, which ends the
+ * frame with the new state's first sample so the transition reaches the
+ * ground at once. The first sample of a new state is always kept.
+ *
+ * Not thread safe: one task adds.
+ */
+class TELEMETRY_BATCH {
+    public:
+        TELEMETRY_BATCH(size_t maxLength = 255);
+
+        void setRate(STATES state, uint16_t every, uint8_t samples);
+        BatchRate getRate(STATES state) const { return rates[state]; }
+
+        size_t add(const SampleRecord& sample, uint8_t* out);
+        size_t flush(uint8_t* out);
+        uint8_t pending() const { return count; }
+        uint16_t nextSequence() const { return sequence; }
+
+    private:
+        const BatchRate& rateFor(uint8_t state) const;
+        size_t bytesWith(const int32_t* deltas) const;
+        size_t encode(uint8_t* out);
+
+        size_t maxLength;
+        BatchRate rates[POST_LANDED + 1];
+        uint16_t sequence = 0;
+        uint16_t sinceKept = 0;             // samples handed in since the last one kept
+        uint8_t lastState = 0xFF;           // of the last sample handed in
+        uint8_t batchState = 0;             // of the base
+        uint8_t count = 0;
+        uint8_t widths[TELEMETRY_CHANNELS];
+        uint32_t base[TELEMETRY_CHANNELS];
+        int32_t deltas[SRAD_PHX_TELEMETRY_BATCH][TELEMETRY_CHANNELS];   // [0] unused, the base
+};
+
+/**
+ * @brief unpacks a TELEMETRY_BATCH frame back into its samples
+ * @param frame As received
+ * @param size Its length
+ * @param samples Filled like telemetryDecode() fills one
+ * @param maxSamples Room in `samples`, 255 always fits
+ * @param sequence The frame's counter
+ * @return Returns the number of samples, 0 if the frame is not a batch frame, is malformed or fails its CRC
+ */
+size_t telemetryDecodeBatch(const uint8_t* frame, size_t size, SampleRecord* samples, size_t maxSamples,
+                            uint16_t& sequence);
+
+#endif
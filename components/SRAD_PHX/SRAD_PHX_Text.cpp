@@ -0,0 +1,154 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "SRAD_PHX_Text.h"
+
+// printFloat's rounding term, built by the same repeated division so every bit matches
+static constexpr double roundingFor(uint8_t decimals) {
+    double rounding = 0.5;
+    for(uint8_t ind = 0; ind < decimals; ++ind) {
+        rounding /= 10.0;
+    }
+    return rounding;
+}
+
+const double TEXT_ROUNDING[TEXT_MAX_DECIMALS + 1] = {
+    roundingFor(0), roundingFor(1), roundingFor(2), roundingFor(3),
+    roundingFor(4), roundingFor(5), roundingFor(6)
+};
+
+const uint32_t TEXT_POWERS_OF_TEN[TEXT_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+// "00" to "99", two digits per division
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+size_t textUnsigned(uint64_t value, char* out) {
+    char digits[20];
+    uint8_t count = sizeof(digits);
+    // 32 bit divisions once the value fits, the ESP32's 64 bit ones are library calls
+    while(value > UINT32_MAX) {
+        uint32_t pair = uint32_t(value % 100);
+        value /= 100;
+        count -= 2;
+        memcpy(digits + count, DIGIT_PAIRS + 2 * pair, 2);
+    }
+    uint32_t small = uint32_t(value);
+    while(small >= 100) {
+        uint32_t pair = small % 100;
+        small /= 100;
+        count -= 2;
+        memcpy(digits + count, DIGIT_PAIRS + 2 * pair, 2);
+    }
+    if(small >= 10) {
+        count -= 2;
+        memcpy(digits + count, DIGIT_PAIRS + 2 * small, 2);
+    } else {
+        digits[--count] = char('0' + small);
+    }
+    size_t length = sizeof(digits) - count;
+    memcpy(out, digits + count, length);
+    return length;
+}
+
+size_t textFloat(double number, uint8_t decimals, char* out) {
+    if(isnan(number)) {
+        memcpy(out, "nan", 3);
+        return 3;
+    }
+    if(isinf(number)) {
+        memcpy(out, "inf", 3);
+        return 3;
+    }
+    if(number > 4294967040.0 || number < -4294967040.0) {
+        memcpy(out, "ovf", 3);
+        return 3;
+    }
+
+    size_t length = 0;
+    if(number < 0.0) {
+        out[length++] = '-';
+        number = -number;
+    }
+    number += decimals <= TEXT_MAX_DECIMALS ? TEXT_ROUNDING[decimals] : roundingFor(decimals);
+
+    uint32_t intPart = (uint32_t)number;
+    double remainder = number - (double)intPart;
+    length += textUnsigned(intPart, out + length);
+    if(decimals) {
+        out[length++] = '.';
+    }
+    while(decimals-- > 0) {
+        remainder *= 10.0;
+        int toPrint = int(remainder);
+        out[length++] = char('0' + toPrint);
+        remainder -= toPrint;
+    }
+    return length;
+}
+
+// makes room for `size` more bytes, writing out what's collected if it has to
+void TEXT_ROW::reserve(size_t size) {
+    if(length + size > TEXT_ROW_SIZE) {
+        send();
+    }
+}
+
+void TEXT_ROW::print(const char* text) {
+    size_t size = strlen(text);
+    while(size) {
+        reserve(1);
+        size_t chunk = size < TEXT_ROW_SIZE - length ? size : TEXT_ROW_SIZE - length;
+        memcpy(buffer + length, text, chunk);
+        length += chunk;
+        text += chunk;
+        size -= chunk;
+    }
+}
+
+void TEXT_ROW::print(char c) {
+    reserve(1);
+    buffer[length++] = c;
+}
+
+void TEXT_ROW::print(long value) {
+    reserve(21);
+    if(value < 0) {
+        buffer[length++] = '-';
+    }
+    length += textUnsigned(value < 0 ? 0 - (unsigned long)value : (unsigned long)value, buffer + length);
+}
+
+void TEXT_ROW::print(unsigned long long value) {
+    reserve(20);
+    length += textUnsigned(value, buffer + length);
+}
+
+void TEXT_ROW::print(double value, int decimals) {
+    uint8_t places = uint8_t(decimals);         // printFloat takes its digits as uint8_t
+    reserve(12 + places);
+    length += textFloat(value, places, buffer + length);
+}
+
+/**
+ * @brief writes the row out
+ * @return Returns the bytes the output took for this row, counting any earlier writes
+ */
+size_t TEXT_ROW::send() {
+    if(length) {
+        sent += out.write((const uint8_t*)buffer, length);
+        length = 0;
+    }
+    return sent;
+}
@@ -0,0 +1,65 @@
+#ifndef SRAD_PHX_TEXT_H
+#define SRAD_PHX_TEXT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Print.h>
+
+#define TEXT_ROW_SIZE 256               // a writeSD CSV row is at most ~225 characters
+#define TEXT_MAX_DECIMALS 6             // table sizes, more decimals still format
+
+// printFloat's rounding term per decimals, and 10^decimals
+extern const double TEXT_ROUNDING[TEXT_MAX_DECIMALS + 1];
+extern const uint32_t TEXT_POWERS_OF_TEN[TEXT_MAX_DECIMALS + 1];
+
+/**
+ * @brief formats a number exactly as `Print::print(value, decimals)` does
+ * @param value Number as passed to print, floats widened to double like print does
+ * @param decimals Digits after the point
+ * @param out 12 + `decimals` bytes, not terminated
+ * @return Returns the text length
+ *
+ * The digits come from printFloat's own double arithmetic, step for step,
+ * so every output is the same bytes. What goes is the rest of the work:
+ * printFloat writes the integer part, the point and every digit through
+ * separate `print()` calls, each of them at least one virtual `write()`.
+ */
+size_t textFloat(double value, uint8_t decimals, char* out);
+
+// `value` in decimal, as Print::print(unsigned long long) prints it, at most 20 bytes
+size_t textUnsigned(uint64_t value, char* out);
+
+/**
+ * @brief builds a line of text in a stack buffer and writes it in one call
+ *
+ * Takes the same `print()`/`println()` calls as `Print` and produces the
+ * same bytes, then `send()` hands them to the output with a single
+ * `write()`. A row that outgrows the buffer is written in more than one.
+ */
+class TEXT_ROW {
+    public:
+        TEXT_ROW(Print& output) : out(output) {}
+
+        void print(const char* text);
+        void print(char c);
+        void print(int value) { print(long(value)); }
+        void print(long value);
+        void print(unsigned long value) { print((unsigned long long)value); }
+        void print(unsigned long long value);
+        void print(double value, int decimals);
+        void println() { print("\r\n"); }
+        template <typename T> void println(T value) { print(value); println(); }
+        void println(double value, int decimals) { print(value, decimals); println(); }
+
+        size_t send();
+
+    private:
+        void reserve(size_t size);
+
+        Print& out;
+        size_t length = 0;
+        size_t sent = 0;
+        char buffer[TEXT_ROW_SIZE];
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SRAD_PHX_TIME_H
+#define SRAD_PHX_TIME_H
+
+#include <stdint.h>
+#include <esp_timer.h>
+#include <esp_cpu.h>
+#include <esp_rom_sys.h>
+
+// flight time at boot: 0, or where the last boot left off after FLIGHT::resume()
+inline uint64_t timeBase_us = 0;
+
+/**
+ * @brief microseconds since boot, or since the first boot after a warm restart
+ *
+ * Backed by esp_timer (64 bit, never wraps in flight), safe to call
+ * from any task or ISR. This is the flight timebase: loop time, sample
+ * timestamps and logged times all come from here. `timeBase_us` is only
+ * set at boot, before any other task runs.
+ */
+inline uint64_t nowMicros() {
+    return timeBase_us + (uint64_t)esp_timer_get_time();
+}
+
+/**
+ * @brief raw CPU cycle counter (CCOUNT)
+ *
+ * One cycle resolution but per core and wraps every few seconds, so only
+ * use it for short intervals measured on one core: `nowCycles() - start`.
+ */
+inline uint32_t nowCycles() {
+    return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+inline uint32_t cyclesPerMicro() {
+    return esp_rom_get_cpu_ticks_per_us();
+}
+
+#endif
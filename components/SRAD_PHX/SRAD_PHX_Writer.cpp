@@ -0,0 +1,285 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+#include "SRAD_PHX_Writer.h"
+#include "SRAD_PHX_Time.h"
+
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const uint32_t WRITER_TASK_STACK = 4096;
+#endif
+
+/**
+ * @brief sets up the buffers, nothing runs until `begin()` or `service()`
+ * @param file Destination, e.g. an SD `File`; only the writer side touches it
+ * @param flushInterval_ms Longest time written sectors go without a file flush
+ * @param flushBytes Most bytes written between file flushes
+ */
+LOG_WRITER::LOG_WRITER(Print& f, uint32_t flushInterval_ms, uint32_t bytes)
+: file(f), flushInterval_us(flushInterval_ms * 1000), flushBytes(bytes) {
+    for(uint8_t buffer = 0; buffer < SRAD_PHX_WRITER_BUFFERS; buffer++) {
+        lengths[buffer] = 0;
+        freeBuffers.push(buffer);
+    }
+    resetStats();
+}
+
+LOG_WRITER::~LOG_WRITER() {
+    end();
+}
+
+/**
+ * @brief starts the writer task
+ * @param priority FreeRTOS priority, below the sensor readers
+ * @param core Core to pin the task to, clamped on single core builds
+ * @return Returns `false` if the task could not be created, or on the host
+ *
+ * The task wakes on every full buffer and at least every
+ * `flushInterval_ms`, and keeps calling `service()` until `end()`.
+ */
+bool LOG_WRITER::begin(uint32_t priority, int core) {
+#if defined(ESP_PLATFORM)
+    if(running) {
+        return true;
+    }
+    running = true;
+    TaskHandle_t handle = nullptr;
+    if(xTaskCreatePinnedToCore(taskLoop, "log_writer", WRITER_TASK_STACK, this, priority, &handle,
+                               core < portNUM_PROCESSORS ? core : portNUM_PROCESSORS - 1) != pdPASS) {
+        running = false;
+        return false;
+    }
+    task = handle;
+    return true;
+#else
+    (void)priority;
+    (void)core;
+    return false;
+#endif
+}
+
+void LOG_WRITER::taskLoop(void* arg) {
+#if defined(ESP_PLATFORM)
+    LOG_WRITER* writer = (LOG_WRITER*)arg;
+    while(writer->running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(writer->flushInterval_us / 1000) + 1);
+        writer->service();
+    }
+    writer->task = nullptr;
+    vTaskDelete(nullptr);
+#else
+    (void)arg;
+#endif
+}
+
+/**
+ * @brief writes everything out, flushes the file and stops the task
+ *
+ * Call after landing, before closing the file. Without a task the
+ * caller's thread does the writing.
+ */
+void LOG_WRITER::end() {
+    sync();
+#if defined(ESP_PLATFORM)
+    if(running) {
+        while(!drained()) {
+            xTaskNotifyGive((TaskHandle_t)task);
+            vTaskDelay(1);
+        }
+        running = false;
+        xTaskNotifyGive((TaskHandle_t)task);
+        while(task != nullptr) {
+            vTaskDelay(1);
+        }
+        return;
+    }
+#endif
+    service();
+}
+
+/**
+ * @brief copies one write into the current buffer
+ * @param buffer Bytes to log, e.g. one packed record or one CSV field
+ * @param size Length of `buffer`
+ * @return Returns `size`, or 0 if no buffer was free and the whole write was dropped
+ */
+size_t LOG_WRITER::write(const uint8_t* buffer, size_t size) {
+    uint32_t freeCount = freeBuffers.size();
+    uint32_t room = fill >= 0 ? fillCapacity - fillLength + freeCount * SRAD_PHX_WRITER_BUFFER_SIZE
+                  : freeCount ? nextCapacity() + (freeCount - 1) * SRAD_PHX_WRITER_BUFFER_SIZE : 0;
+    if(size > room) {
+        bytesDropped.fetch_add(size, std::memory_order_relaxed);
+        return 0;
+    }
+
+    size_t left = size;
+    while(left) {
+        if(fill < 0) {
+            uint8_t next = 0;
+            freeBuffers.pop(next);          // room above guarantees one
+            fill = next;
+            fillLength = 0;
+            fillCapacity = nextCapacity();
+        }
+        size_t chunk = left < fillCapacity - fillLength ? left : fillCapacity - fillLength;
+        memcpy(buffers[fill] + fillLength, buffer, chunk);
+        fillLength += chunk;
+        buffer += chunk;
+        left -= chunk;
+        if(fillLength == fillCapacity) {
+            queueFill();
+        }
+    }
+    bytesQueued.fetch_add(size, std::memory_order_relaxed);
+    return size;
+}
+
+// a buffer ends on a sector boundary of the file, even after a sync() left it mid-sector
+uint32_t LOG_WRITER::nextCapacity() const {
+    return SRAD_PHX_WRITER_BUFFER_SIZE - fileOffset % WRITER_SECTOR_SIZE;
+}
+
+// hands the buffer being filled to the writer
+void LOG_WRITER::queueFill() {
+    lengths[fill] = fillLength;
+    fileOffset += fillLength;
+    fullBuffers.push(fill);
+    fill = -1;
+    fillLength = 0;
+#if defined(ESP_PLATFORM)
+    if(task != nullptr) {
+        xTaskNotifyGive((TaskHandle_t)task);
+    }
+#endif
+}
+
+/**
+ * @brief queues the partly filled buffer and asks for a file flush
+ *
+ * The one place a write may end mid-sector; the next buffer is cut short
+ * so the ones after it are sector aligned again. Returns at once, poll
+ * `drained()` to know it reached the card.
+ */
+void LOG_WRITER::sync() {
+    if(fill >= 0 && fillLength > 0) {
+        queueFill();
+    }
+    syncsRequested.fetch_add(1, std::memory_order_release);
+#if defined(ESP_PLATFORM)
+    if(task != nullptr) {
+        xTaskNotifyGive((TaskHandle_t)task);
+    }
+#endif
+}
+
+// true once every queued buffer and the last sync() reached the file
+bool LOG_WRITER::drained() const {
+    return fullBuffers.size() == 0
+        && syncsDone.load(std::memory_order_acquire) == syncsRequested.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief writes every queued buffer, then flushes the file if a bound is reached
+ * @return Returns `true` if anything was written or flushed
+ */
+bool LOG_WRITER::service() {
+    uint32_t syncTarget = syncsRequested.load(std::memory_order_acquire);
+    bool worked = false;
+    uint8_t buffer;
+    while(fullBuffers.pop(buffer)) {
+        uint32_t length = lengths[buffer];
+        uint32_t start = nowCycles();
+        file.write(buffers[buffer], length);
+        uint32_t write_us = (nowCycles() - start) / cyclesPerMicro();
+        freeBuffers.push(buffer);
+
+        Timing& update = timing.beginWrite();
+        update.stats.bytesWritten += length;
+        update.stats.writes++;
+        update.writeLatency.record(write_us);
+        if(write_us > update.stats.writeMax_us) {
+            update.stats.writeMax_us = write_us;
+        }
+        timing.endWrite();
+        unflushed += length;
+        worked = true;
+    }
+
+    uint64_t now_us = nowMicros();
+    bool syncing = syncTarget != syncsDone.load(std::memory_order_relaxed);
+    if(syncing || unflushed >= flushBytes || (unflushed && now_us - lastFlush_us >= flushInterval_us)) {
+        uint32_t start = nowCycles();
+        file.flush();
+        uint32_t flush_us = (nowCycles() - start) / cyclesPerMicro();
+        unflushed = 0;
+        lastFlush_us = now_us;
+
+        Timing& update = timing.beginWrite();
+        update.stats.flushes++;
+        if(flush_us > update.stats.flushMax_us) {
+            update.stats.flushMax_us = flush_us;
+        }
+        timing.endWrite();
+        worked = true;
+    }
+    syncsDone.store(syncTarget, std::memory_order_release);
+    return worked;
+}
+
+/**
+ * @brief copies the counters
+ * @return Returns writer-side fields consistent with each other, producer-side ones as of the call
+ */
+WriterStats LOG_WRITER::getStats() const {
+    WriterStats stats = timing.read().stats;
+    stats.bytesQueued = bytesQueued.load(std::memory_order_relaxed);
+    stats.bytesDropped = bytesDropped.load(std::memory_order_relaxed);
+    stats.queueDepth = fullBuffers.size();
+    stats.queueHighWater = fullBuffers.highWater();
+    return stats;
+}
+
+HISTOGRAM LOG_WRITER::getWriteLatency() const {
+    return timing.read().writeLatency;
+}
+
+void LOG_WRITER::resetStats() {
+    Timing& update = timing.beginWrite();
+    update.stats = {};
+    update.writeLatency.reset();
+    timing.endWrite();
+    bytesQueued.store(0, std::memory_order_relaxed);
+    bytesDropped.store(0, std::memory_order_relaxed);
+    fullBuffers.resetCounters();
+}
+
+/**
+ * @brief prints throughput, queue depth and the worst stalls
+ * @param output Print to write to, not this writer
+ */
+void LOG_WRITER::printStats(Print& output) {
+    WriterStats stats = getStats();
+    HISTOGRAM latency = getWriteLatency();
+    output.print("log writer: queued "); output.print(stats.bytesQueued);
+    output.print(" B, written "); output.print(stats.bytesWritten);
+    output.print(" B, dropped "); output.print(stats.bytesDropped);
+    output.print(" B, writes "); output.print(stats.writes);
+    output.print(", flushes "); output.println(stats.flushes);
+    output.print("log writer: queue depth "); output.print(stats.queueDepth);
+    output.print(" (max "); output.print(stats.queueHighWater);
+    output.print(" of "); output.print(SRAD_PHX_WRITER_BUFFERS);
+    output.print("), write mean/p99/max "); output.print(latency.mean(), 0);
+    output.print("/"); output.print(latency.percentile(99));
+    output.print("/"); output.print(stats.writeMax_us);
+    output.print(" us, flush max "); output.print(stats.flushMax_us); output.println(" us");
+}
@@ -0,0 +1,111 @@
+#ifndef SRAD_PHX_WRITER_H
+#define SRAD_PHX_WRITER_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "SRAD_PHX_HAL.h"
+#include "SRAD_PHX_Histogram.h"
+#include "SRAD_PHX_Ring.h"
+#include "SRAD_PHX_Seqlock.h"
+
+// buffer count and size, override before including; the size must be whole sectors
+#ifndef SRAD_PHX_WRITER_BUFFERS
+#define SRAD_PHX_WRITER_BUFFERS 4
+#endif
+#ifndef SRAD_PHX_WRITER_BUFFER_SIZE
+#define SRAD_PHX_WRITER_BUFFER_SIZE 8192
+#endif
+#define WRITER_SECTOR_SIZE 512
+
+struct WriterStats {
+    uint32_t bytesQueued;           // accepted by write()
+    uint32_t bytesDropped;          // refused because every buffer was full
+    uint32_t bytesWritten;          // handed to the file
+    uint32_t writes;                // file writes, one per buffer
+    uint32_t flushes;               // file flushes (FAT/directory updates)
+    uint32_t queueDepth;            // full buffers waiting for the task
+    uint32_t queueHighWater;
+    uint32_t writeMax_us;           // longest single buffer write
+    uint32_t flushMax_us;           // longest file flush
+};
+
+/**
+ * @brief batches log output into whole sectors for a dedicated writer task
+ *
+ * A `Print` for `FLIGHT::writeSD` and friends that only copies into one of
+ * `SRAD_PHX_WRITER_BUFFERS` RAM buffers. Full buffers go to the writer
+ * task, which hands each one to the file in a single sector-multiple
+ * `write()`. The task flushes the file only every `flushInterval_ms` or
+ * `flushBytes`, whichever comes first, not once per row. An SD stall only
+ * holds up the task. The producer never blocks: once every buffer is
+ * waiting, whole writes are dropped and counted, so a record is either
+ * logged complete or not at all.
+ *
+ * One producer task calls `write()`/`sync()`; only the writer task (or
+ * the caller of `service()` when no task was started) touches the file.
+ */
+class LOG_WRITER : public Print {
+    static_assert(SRAD_PHX_WRITER_BUFFER_SIZE % WRITER_SECTOR_SIZE == 0, "writer buffers must be whole sectors");
+    static_assert(SRAD_PHX_WRITER_BUFFERS >= 2 && SRAD_PHX_WRITER_BUFFERS <= 16, "2 to 16 writer buffers");
+
+    public:
+        LOG_WRITER(Print& file, uint32_t flushInterval_ms = 500, uint32_t flushBytes = 65536);
+        ~LOG_WRITER();
+
+        bool begin(uint32_t priority, int core = 0);    // starts the writer task, target only
+        void end();                                     // sync(), waits for the task to drain, stops it
+
+        // producer side
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+        void flush() override {}                        // per-row flushes are what this class removes
+        void sync();
+        bool drained() const;
+
+        // writer side, called by the task; call it yourself when no task was started
+        bool service();
+
+        WriterStats getStats() const;
+        HISTOGRAM getWriteLatency() const;
+        void resetStats();
+        void printStats(Print &);
+
+    private:
+        static void taskLoop(void*);
+        void queueFill();
+        uint32_t nextCapacity() const;
+
+        Print& file;
+        uint32_t flushInterval_us;
+        uint32_t flushBytes;
+        void* task = nullptr;                           // TaskHandle_t on target
+        std::atomic<bool> running{false};
+
+        // producer
+        int8_t fill = -1;                               // buffer being filled, -1 if none
+        uint32_t fillLength = 0;
+        uint32_t fillCapacity = 0;                      // bytes that keep the buffer's end sector aligned
+        uint64_t fileOffset = 0;                        // file position after the last queued buffer
+        std::atomic<uint32_t> bytesQueued{0};
+        std::atomic<uint32_t> bytesDropped{0};
+        std::atomic<uint32_t> syncsRequested{0};
+
+        // writer
+        uint32_t unflushed = 0;                         // bytes written since the last file flush
+        uint64_t lastFlush_us = 0;
+        std::atomic<uint32_t> syncsDone{0};             // syncsRequested as of the last completed service()
+        struct Timing {
+            WriterStats stats;
+            HISTOGRAM writeLatency;                     // microseconds per buffer write
+        };
+        SEQLOCK<Timing> timing;
+
+        SAMPLE_RING<uint8_t, 16> fullBuffers;           // producer -> writer
+        SAMPLE_RING<uint8_t, 16> freeBuffers;           // writer -> producer
+        uint32_t lengths[SRAD_PHX_WRITER_BUFFERS];      // bytes in each queued buffer, set before it is queued
+        alignas(4) uint8_t buffers[SRAD_PHX_WRITER_BUFFERS][SRAD_PHX_WRITER_BUFFER_SIZE];
+};
+
+#endif
@@ -0,0 +1,88 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// LOG_DELTA on the flight computer itself. Flies the simulated devices
+// through FLIGHT at 1 kHz of simulated time, packs every sample as an
+// 'S' and an 'R' record, and delta codes each with a keyframe every
+// KEYFRAMES records. Reports the compression ratio and the CCOUNT cycles
+// per encode. No sensors or card needed; the sim runs as fast as it can.
+
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_HAL_Sim.h"
+
+#define SIM_SECONDS 60
+#define KEYFRAMES 100
+
+SIM_TRAJECTORY trajectory;
+SIM_IMU lsm(trajectory);
+SIM_BARO bmp(trajectory);
+SIM_ACCEL adxl(trajectory);
+SIM_AHRS bno(trajectory);
+TelemetryData initial = {};
+FLIGHT flight(20, 100, 5000, 10, String(""), initial);
+FlightRing ring;
+
+struct Channel {
+    const char* name;
+    LOG_DELTA delta;
+    HISTOGRAM cycles;
+};
+static Channel channels[2] = {{"'S'", LOG_DELTA(KEYFRAMES), {}}, {"'R'", LOG_DELTA(KEYFRAMES), {}}};
+
+static void encode(Channel& channel, const uint8_t* record) {
+    static uint8_t out[LOG_DELTA_MAX_SIZE];
+    uint32_t start = nowCycles();
+    channel.delta.encode(record, out);
+    channel.cycles.record(nowCycles() - start);
+}
+
+void setup() {
+    Serial.begin(115200);
+    flight.attachRing(ring);
+    flight.setState(STATES::PRE_CAL);
+
+    SampleRecord sample;
+    uint8_t packed[LOG_SAMPLE_SIZE];
+    for(uint64_t time_us = 1000; time_us <= SIM_SECONDS * 1000000ULL; time_us += 1000) {
+        trajectory.update(time_us);
+        flight.incrementTime(time_us);
+        flight.read_LSM(lsm);
+        flight.read_ADXL(adxl);
+        flight.read_BNO(bno);
+        if(time_us % 40000 == 0) {
+            flight.read_BMP(bmp);
+        }
+        flight.calculateState();
+        flight.pushSample();
+        while(ring.pop(sample)) {
+            logPackSample(sample, false, packed);
+            encode(channels[0], packed);
+            logPackRaw(sample, false, packed);
+            encode(channels[1], packed);
+        }
+    }
+
+    Serial.print(SIM_SECONDS); Serial.print(" s simulated, keyframe every "); Serial.println(KEYFRAMES);
+    for(Channel& channel : channels) {
+        DeltaStats stats = channel.delta.getStats();
+        Serial.print(channel.name);
+        Serial.print(": "); Serial.print(double(stats.bytesIn) / stats.records, 1);
+        Serial.print(" -> "); Serial.print(double(stats.bytesOut) / stats.records, 1);
+        Serial.print(" B/sample, ratio "); Serial.print(double(stats.bytesIn) / stats.bytesOut, 2);
+        Serial.print(", encode mean/p99/max "); Serial.print(channel.cycles.mean(), 0);
+        Serial.print("/"); Serial.print(channel.cycles.percentile(99));
+        Serial.print("/"); Serial.print(channel.cycles.max()); Serial.print(" cycles (");
+        Serial.print(channel.cycles.mean() / cyclesPerMicro(), 2); Serial.println(" us)");
+    }
+}
+
+void loop() {
+    delay(1000);
+}
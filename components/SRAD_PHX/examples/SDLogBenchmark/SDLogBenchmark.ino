@@ -0,0 +1,151 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// SD logging paths compared on the card actually flown. Each run writes
+// BENCH_BYTES and reports sustained MB/s and the per-call latency spread:
+//
+//   1. File::print   writeSD CSV rows straight to an SD File, flush per row (the old path)
+//   2. File 8 KB     8 KB File::write calls flushed every 64 KB, LOG_WRITER on a File
+//   3. FLIGHT_FILE   8 KB raw multi-block writes into a preallocated contiguous extent
+//
+// Leaves /bench_*.bin on the card; delete them afterwards.
+
+#include <SPI.h>
+#include <SD.h>
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_FlightFile.h"
+
+#define VSPI_SCLK_PIN 18
+#define VSPI_MISO_PIN 17
+#define VSPI_MOSI_PIN 16
+#define SD_CS 15                        // SD chip select, match your wiring
+#define SD_HZ 20000000
+
+#define BENCH_BYTES (4UL * 1024 * 1024)
+#define BLOCK_BYTES 8192
+
+SPIClass sdSPI(FSPI);
+TelemetryData initial = {};
+FLIGHT flight(20, 100, 5000, 10, String("time_us, ori_w, ori_x, ori_y, ori_z, gyro_x, gyro_y, gyro_z, "
+              "acc_x, acc_y, acc_z, adxl_x, adxl_y, adxl_z, press, alt, lsm_temp, adxl_temp, bno_temp, bmp_temp, "
+              "lsm, bmp, adxl, bno, gps"), initial);
+static uint8_t block[BLOCK_BYTES];
+
+// a plausible sample, so CSV rows are their flight length
+static SampleRecord fakeSample(uint32_t index) {
+    SampleRecord sample = {};
+    float t = index * 0.001f;
+    sample.time_us = uint64_t(index) * 1000;
+    sample.state = FLIGHT_ASCENT;
+    sample.data.bno_ori_w = cosf(t); sample.data.bno_ori_x = sinf(t);
+    sample.data.bno_gyro_x = 0.1f * sinf(3 * t); sample.data.bno_acc_z = 9.81f + sinf(t);
+    sample.data.adxl_acc_z = 9.8f + 20 * sinf(t);
+    sample.data.bmp_press = 101325.0f - t * 12; sample.data.bmp_alt = t;
+    sample.data.lsm_temp = sample.data.adxl_temp = sample.data.bno_temp = sample.data.bmp_temp = 24.5f;
+    for(uint8_t sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        sample.data.sensor_status[sensor] = 1;
+    }
+    return sample;
+}
+
+static void report(const char* name, uint64_t bytes, uint64_t elapsed_us, const HISTOGRAM& latency) {
+    Serial.print(name);
+    Serial.print(": "); Serial.print(bytes / 1048576.0 / (elapsed_us / 1e6), 3);
+    Serial.print(" MB/s, call mean/p99/max "); Serial.print(latency.mean(), 0);
+    Serial.print("/"); Serial.print(latency.percentile(99));
+    Serial.print("/"); Serial.print(latency.max());
+    Serial.print(" us over "); Serial.print(latency.count()); Serial.println(" calls");
+}
+
+static void benchPrint() {
+    File file = SD.open("/bench_print.csv", FILE_WRITE);
+    if(!file) {
+        Serial.println("File::print: open failed");
+        return;
+    }
+    flight.setLogFormat(LOG_FORMAT_CSV);
+    HISTOGRAM latency;
+    uint64_t start_us = nowMicros();
+    for(uint32_t index = 0; file.size() < BENCH_BYTES; index++) {
+        SampleRecord sample = fakeSample(index);
+        uint64_t call_us = nowMicros();
+        flight.writeSD(sample, file);
+        latency.record(uint32_t(nowMicros() - call_us));
+    }
+    uint64_t elapsed_us = nowMicros() - start_us;
+    report("File::print", file.size(), elapsed_us, latency);
+    file.close();
+}
+
+static void benchFileBlocks() {
+    File file = SD.open("/bench_file.bin", FILE_WRITE);
+    if(!file) {
+        Serial.println("File 8 KB: open failed");
+        return;
+    }
+    HISTOGRAM latency;
+    uint64_t start_us = nowMicros();
+    for(uint32_t written = 0; written < BENCH_BYTES; written += BLOCK_BYTES) {
+        uint64_t call_us = nowMicros();
+        file.write(block, BLOCK_BYTES);
+        if(written % 65536 == 65536 - BLOCK_BYTES) {
+            file.flush();
+        }
+        latency.record(uint32_t(nowMicros() - call_us));
+    }
+    uint64_t elapsed_us = nowMicros() - start_us;
+    report("File 8 KB", BENCH_BYTES, elapsed_us, latency);
+    file.close();
+}
+
+static void benchFlightFile() {
+    static FLIGHT_FILE file;
+    uint64_t prepare_us = nowMicros();
+    if(!file.preallocate("0:/bench_raw.bin", BENCH_BYTES)) {
+        Serial.println("FLIGHT_FILE: preallocate failed, card full or fragmented?");
+        return;
+    }
+    prepare_us = nowMicros() - prepare_us;
+
+    HISTOGRAM latency;
+    uint64_t start_us = nowMicros();
+    for(uint32_t written = 0; written < BENCH_BYTES; written += BLOCK_BYTES) {
+        uint64_t call_us = nowMicros();
+        file.write(block, BLOCK_BYTES);
+        latency.record(uint32_t(nowMicros() - call_us));
+    }
+    uint64_t elapsed_us = nowMicros() - start_us;
+    report("FLIGHT_FILE", BENCH_BYTES, elapsed_us, latency);
+    Serial.print("FLIGHT_FILE: preallocate "); Serial.print(uint32_t(prepare_us / 1000));
+    Serial.print(" ms, errors "); Serial.println(file.errors());
+    file.close();
+}
+
+void setup() {
+    Serial.begin(115200);
+    sdSPI.begin(VSPI_SCLK_PIN, VSPI_MISO_PIN, VSPI_MOSI_PIN, SD_CS);
+    if(!SD.begin(SD_CS, sdSPI, SD_HZ)) {
+        Serial.println("SD mount failed");
+        return;
+    }
+    for(uint32_t ind = 0; ind < BLOCK_BYTES; ind++) {
+        block[ind] = uint8_t(ind * 31);
+    }
+    Serial.print("card "); Serial.print(uint32_t(SD.cardSize() / 1048576)); Serial.print(" MB, ");
+    Serial.print(BENCH_BYTES / 1048576); Serial.println(" MB per run");
+
+    benchPrint();
+    benchFileBlocks();
+    benchFlightFile();
+}
+
+void loop() {
+    delay(1000);
+}
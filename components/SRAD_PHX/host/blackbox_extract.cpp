@@ -0,0 +1,81 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Pulls the BLACK_BOX log out of a dump of its partition, oldest segment
+// first, as one binary flight log for log_decode. Read the partition off
+// the board with esptool (offset and size from partitions.csv):
+//
+//   esptool.py --chip esp32s3 read_flash 0x110000 0xF0000 blackbox.img
+//   blackbox_extract blackbox.img flight.bin
+//   log_decode flight.bin flight.csv
+//
+//   blackbox_extract IMAGE OUT [--block-size BYTES]   (default 4096)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "SD.h"
+#include "SRAD_PHX_BlackBox.h"
+#include "SRAD_PHX_HAL_Sim.h"
+
+int main(int argc, char** argv) {
+    const char* imagePath = nullptr;
+    const char* outputPath = nullptr;
+    uint32_t blockSize = 4096;
+    for(int arg = 1; arg < argc; arg++) {
+        if(!strcmp(argv[arg], "--block-size") && arg + 1 < argc) {
+            blockSize = atoi(argv[++arg]);
+        } else if(!imagePath) {
+            imagePath = argv[arg];
+        } else {
+            outputPath = argv[arg];
+        }
+    }
+    if(!imagePath || !outputPath || !blockSize) {
+        fprintf(stderr, "usage: %s image.img out.bin [--block-size BYTES]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* input = fopen(imagePath, "rb");
+    if(!input) {
+        perror(imagePath);
+        return 1;
+    }
+    std::vector<uint8_t> image;
+    uint8_t chunk[65536];
+    size_t got;
+    while((got = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+        image.insert(image.end(), chunk, chunk + got);
+    }
+    fclose(input);
+    if(image.size() < blockSize || image.size() % blockSize) {
+        fprintf(stderr, "%s: %zu bytes is not a whole number of %u byte blocks\n", imagePath, image.size(), blockSize);
+        return 1;
+    }
+
+    FILE* output = fopen(outputPath, "wb");
+    if(!output) {
+        perror(outputPath);
+        return 1;
+    }
+    File out(output);
+    SIM_FLASH flash(image.data(), uint32_t(image.size()), blockSize);
+    static BLACK_BOX blackBox;
+    uint32_t segments = blackBox.extract(flash, out);
+    out.close();
+    if(!segments) {
+        fprintf(stderr, "%s: no black box segments (not a LittleFS image, or empty)\n", imagePath);
+        return 1;
+    }
+    fprintf(stderr, "%u segments, %llu bytes read from flash\n", segments, (unsigned long long)flash.bytesRead());
+    return 0;
+}
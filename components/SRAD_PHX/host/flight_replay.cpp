@@ -0,0 +1,348 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Replays recorded flight CSVs through FLIGHT::calculateState() at full
+// speed and prints every state transition with its timestamp, then the
+// replay throughput. Rows are parsed in the exact writeSD (or writeSERIAL)
+// column layout, with or without the GPS columns.
+//
+//   flight_replay [options] flight.csv [more.csv ...]
+//     --layout sd|serial       column layout (default sd)
+//     --time-unit us|ms        unit of the first column (default us, ms for old logs)
+//     --start-state N          initial STATES value (default 1, calibrate() is still a stub)
+//     --liftoff-accel M/S2     accel_liftoff_threshold (default 20)
+//     --liftoff-time MS        accel_liftoff_time_threshold (default 100)
+//     --land-time MS           land_time_threshold (default 5000)
+//     --land-alt M             land_altitude_threshold (default 10)
+//     --apogee N,V,C           detector window samples, descent m/s, confirmations (default 10,1,3)
+//     --no-fusion              judge apogee on the BMP fit only, for logs whose press column is synthetic
+//     --repeat N               timed passes for the throughput figure (default 20)
+//     --keyframes N            also pack every row as an 'S' record, delta code them with a
+//                              keyframe every N and report the ratio and encode time
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SRAD_PHX.h"
+
+static const char* STATE_NAMES[] = {
+    "PRE_NO_CAL", "PRE_CAL", "FLIGHT_ASCENT", "FLIGHT_DESCENT", "POST_LANDED"
+};
+
+struct ReplayRow {
+    uint64_t time_us;
+    TelemetryData data;
+};
+
+struct ReplayOptions {
+    bool serialLayout = false;
+    uint32_t timeScale = 1;
+    int startState = STATES::PRE_CAL;
+    int liftoffAccel = 20;
+    int liftoffTime = 100;
+    int landTime = 5000;
+    int landAltitude = 10;
+    int repeat = 20;
+    unsigned apogeeWindow = 10, apogeeConfirm = 3;
+    float apogeeDescentRate = 1;
+    bool fusion = true;
+    unsigned keyframes = 0;
+};
+
+static std::vector<std::string> splitRow(char* line) {
+    std::vector<std::string> fields;
+    char* field = line;
+    while(true) {
+        char* comma = strchr(field, ',');
+        if(comma) {
+            *comma = '\0';
+        }
+        while(*field == ' ' || *field == '\t') {
+            field++;
+        }
+        size_t length = strlen(field);
+        while(length && (field[length - 1] == '\r' || field[length - 1] == '\n' || field[length - 1] == ' ')) {
+            field[--length] = '\0';
+        }
+        fields.push_back(field);
+        if(!comma) {
+            return fields;
+        }
+        field = comma + 1;
+    }
+}
+
+static bool parseNumber(const std::string& field, double& value) {
+    char* end;
+    value = strtod(field.c_str(), &end);
+    return !field.empty() && *end == '\0';
+}
+
+/**
+ * @brief turns one CSV row into a sample
+ * @return Returns `false` for headers and rows that don't match the layout
+ */
+static bool parseRow(char* line, const ReplayOptions& options, ReplayRow& row) {
+    std::vector<std::string> fields = splitRow(line);
+
+    // time, [GPS: 6 columns with a fix, 8 without], [serial: LSM gyro x3], 19 floats, 5 status
+    size_t dataColumns = 19 + 5 + (options.serialLayout ? 3 : 0);
+    size_t gpsColumns;
+    if(fields.size() == 1 + dataColumns) {
+        gpsColumns = 0;
+    } else if(fields.size() == 1 + 8 + dataColumns && fields[2] == "No fix") {
+        gpsColumns = 8;
+    } else if(fields.size() == 1 + 6 + dataColumns) {
+        gpsColumns = 6;
+    } else {
+        return false;
+    }
+
+    double values[32];
+    size_t index = 1 + gpsColumns;
+    for(size_t column = 0; column < dataColumns; column++) {
+        if(!parseNumber(fields[index + column], values[column])) {
+            return false;
+        }
+    }
+    double time;
+    if(!parseNumber(fields[0], time)) {
+        return false;
+    }
+
+    memset(&row, 0, sizeof(row));
+    row.time_us = uint64_t(time) * options.timeScale;
+    TelemetryData& data = row.data;
+    const double* value = values;
+    if(options.serialLayout) {
+        data.lsm_gyro_x = *value++; data.lsm_gyro_y = *value++; data.lsm_gyro_z = *value++;
+    }
+    data.bno_ori_w = *value++; data.bno_ori_x = *value++; data.bno_ori_y = *value++; data.bno_ori_z = *value++;
+    data.bno_gyro_x = *value++; data.bno_gyro_y = *value++; data.bno_gyro_z = *value++;
+    data.bno_acc_x = *value++; data.bno_acc_y = *value++; data.bno_acc_z = *value++;
+    data.adxl_acc_x = *value++; data.adxl_acc_y = *value++; data.adxl_acc_z = *value++;
+    data.bmp_press = *value++; data.bmp_alt = *value++;
+    data.lsm_temp = *value++; data.adxl_temp = *value++; data.bno_temp = *value++; data.bmp_temp = *value++;
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        data.sensor_status[sensor] = uint8_t(*value++);
+        data.sample_time_us[sensor] = row.time_us;
+    }
+
+    // neither layout logs LSM acceleration, so let isAscent() fall back to the ADXL
+    data.sensor_status[SENSOR_LSM] = 0;
+    return true;
+}
+
+static bool loadFlight(const char* path, const ReplayOptions& options, std::vector<ReplayRow>& rows, size_t& skipped) {
+    FILE* input = fopen(path, "r");
+    if(!input) {
+        perror(path);
+        return false;
+    }
+
+    char line[4096];
+    ReplayRow row;
+    while(fgets(line, sizeof(line), input)) {
+        if(parseRow(line, options, row)) {
+            // logs repeat the latest BMP sample every loop, it is only new once its values change
+            if(!rows.empty() && row.data.bmp_press == rows.back().data.bmp_press
+                             && row.data.bmp_alt == rows.back().data.bmp_alt) {
+                row.data.sample_time_us[SENSOR_BMP] = rows.back().data.sample_time_us[SENSOR_BMP];
+            }
+            rows.push_back(row);
+        } else {
+            skipped++;
+        }
+    }
+    fclose(input);
+    return true;
+}
+
+static const char* detectorName(FLIGHT& flight) {
+    static char name[48];
+    snprintf(name, sizeof(name), flight.getFusion().driveApogee ? "fused velocity, window %u samples"
+                                                                : "window %u samples", flight.getApogee().window());
+    return name;
+}
+
+// FLIGHT holds atomics and can't be copied, so every pass builds its own
+static FLIGHT* makeFlight(const ReplayOptions& options) {
+    TelemetryData initial = {};
+    FLIGHT* flight = new FLIGHT(options.liftoffAccel, options.liftoffTime, options.landTime,
+                                options.landAltitude, String(""), initial);
+    flight->setState(STATES(options.startState));
+    flight->getApogee().configure(options.apogeeWindow, options.apogeeDescentRate, options.apogeeConfirm);
+    flight->getFusion().driveApogee = options.fusion;
+    return flight;
+}
+
+/**
+ * @brief delta codes the rows as writeSD's 'S' records and times the encoder
+ *
+ * Rows are packed up front, so the timed passes cover `LOG_DELTA::encode`
+ * alone; the state packed is the replay's, which only moves the flags word.
+ */
+static void replayLog(const std::vector<ReplayRow>& rows, const ReplayOptions& options) {
+    std::vector<uint8_t> packed(rows.size() * LOG_SAMPLE_SIZE);
+    std::unique_ptr<FLIGHT> flight(makeFlight(options));
+    for(size_t ind = 0; ind < rows.size(); ind++) {
+        flight->replaySample(rows[ind].time_us, rows[ind].data);
+        flight->calculateState();
+        SampleRecord sample = {rows[ind].time_us, uint8_t(flight->getState()), rows[ind].data};
+        logPackSample(sample, false, &packed[ind * LOG_SAMPLE_SIZE]);
+    }
+
+    uint8_t out[LOG_DELTA_MAX_SIZE];
+    uint64_t checksum = 0;
+    LOG_DELTA delta(options.keyframes);
+    auto begin = std::chrono::steady_clock::now();
+    for(int pass = 0; pass < options.repeat; pass++) {
+        delta.reset();
+        delta.resetStats();
+        for(size_t ind = 0; ind < rows.size(); ind++) {
+            checksum += delta.encode(&packed[ind * LOG_SAMPLE_SIZE], out);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    DeltaStats stats = delta.getStats();
+    printf("  log:     %llu B of 'S' records, %llu B delta coded (%u keyframes), ratio %.2f, encode %.1f ns/sample\n",
+           (unsigned long long)stats.bytesIn, (unsigned long long)stats.bytesOut, stats.keyframes,
+           double(stats.bytesIn) / stats.bytesOut, elapsed * 1e9 / (double(rows.size()) * options.repeat));
+    if(checksum != stats.bytesOut * options.repeat) {
+        printf("  WARNING: encoded sizes differ between passes\n");
+    }
+}
+
+static void replayFile(const char* path, const ReplayOptions& options) {
+    std::vector<ReplayRow> rows;
+    size_t skipped = 0;
+    if(!loadFlight(path, options, rows, skipped)) {
+        return;
+    }
+
+    printf("%s\n", path);
+    printf("  samples: %zu (%zu lines skipped)\n", rows.size(), skipped);
+    if(rows.empty()) {
+        return;
+    }
+
+    // pass 1: report transitions
+    std::unique_ptr<FLIGHT> flight(makeFlight(options));
+    STATES state = flight->getState();
+    uint64_t start_us = rows.front().time_us;
+    printf("  start:   %s\n", STATE_NAMES[state]);
+
+    // the logged apogee is the highest BMP altitude after liftoff
+    bool flying = state >= STATES::FLIGHT_ASCENT;
+    float peak_m = 0;
+    uint64_t peak_us = 0;
+    for(const ReplayRow& row : rows) {
+        flight->replaySample(row.time_us, row.data);
+        flight->calculateState();
+        flying = flying || flight->getState() >= STATES::FLIGHT_ASCENT;
+        if(flying && row.data.sensor_status[SENSOR_BMP] == 1 && (!peak_us || row.data.bmp_alt > peak_m)) {
+            peak_m = row.data.bmp_alt;
+            peak_us = row.time_us;
+        }
+        if(flight->getState() != state) {
+            printf("  %12.6f s  (t=%llu us)  %s -> %s\n", (row.time_us - start_us) / 1e6,
+                   (unsigned long long)row.time_us, STATE_NAMES[state], STATE_NAMES[flight->getState()]);
+            state = flight->getState();
+        }
+    }
+    printf("  end:     %s after %.3f s of flight data\n", STATE_NAMES[state], (rows.back().time_us - start_us) / 1e6);
+    APOGEE& apogee = flight->getApogee();
+    if(peak_us) {
+        printf("  apogee:  logged peak %.2f m at %.6f s", peak_m, (peak_us - start_us) / 1e6);
+        if(apogee.detected()) {
+            printf(", detected %.0f ms later (%s)\n",
+                   (int64_t(apogee.detectedTime_us()) - int64_t(peak_us)) / 1e3, detectorName(*flight));
+        } else {
+            printf(", not detected\n");
+        }
+    }
+
+    // pass 2: timed, state logic only
+    uint8_t finalStates = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for(int pass = 0; pass < options.repeat; pass++) {
+        std::unique_ptr<FLIGHT> timed(makeFlight(options));
+        for(const ReplayRow& row : rows) {
+            timed->replaySample(row.time_us, row.data);
+            timed->calculateState();
+        }
+        finalStates += timed->getState();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double samples = double(rows.size()) * options.repeat;
+    printf("  replay:  %.0f samples in %.3f s = %.0f samples/s (%.1f ns/sample)\n",
+           samples, elapsed, samples / elapsed, elapsed * 1e9 / samples);
+    if(finalStates != uint8_t(state * options.repeat)) {
+        printf("  WARNING: timed passes ended in a different state than pass 1\n");
+    }
+    if(options.keyframes) {
+        replayLog(rows, options);
+    }
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    std::vector<const char*> files;
+
+    for(int arg = 1; arg < argc; arg++) {
+        const char* name = argv[arg];
+        const char* value = arg + 1 < argc ? argv[arg + 1] : nullptr;
+        if(!strcmp(name, "--layout") && value) {
+            options.serialLayout = !strcmp(value, "serial");
+        } else if(!strcmp(name, "--time-unit") && value) {
+            options.timeScale = !strcmp(value, "ms") ? 1000 : 1;
+        } else if(!strcmp(name, "--start-state") && value) {
+            options.startState = atoi(value);
+        } else if(!strcmp(name, "--liftoff-accel") && value) {
+            options.liftoffAccel = atoi(value);
+        } else if(!strcmp(name, "--liftoff-time") && value) {
+            options.liftoffTime = atoi(value);
+        } else if(!strcmp(name, "--land-time") && value) {
+            options.landTime = atoi(value);
+        } else if(!strcmp(name, "--land-alt") && value) {
+            options.landAltitude = atoi(value);
+        } else if(!strcmp(name, "--apogee") && value) {
+            sscanf(value, "%u,%f,%u", &options.apogeeWindow, &options.apogeeDescentRate, &options.apogeeConfirm);
+        } else if(!strcmp(name, "--no-fusion")) {
+            options.fusion = false;
+            continue;
+        } else if(!strcmp(name, "--keyframes") && value) {
+            options.keyframes = atoi(value);
+        } else if(!strcmp(name, "--repeat") && value) {
+            options.repeat = atoi(value) > 0 ? atoi(value) : 1;
+        } else if(name[0] == '-') {
+            fprintf(stderr, "unknown option %s, see the top of flight_replay.cpp\n", name);
+            return 2;
+        } else {
+            files.push_back(name);
+            continue;
+        }
+        arg++;
+    }
+
+    if(files.empty() || options.startState < 0 || options.startState > STATES::POST_LANDED) {
+        fprintf(stderr, "usage: %s [options] flight.csv [...]\n", argv[0]);
+        return 2;
+    }
+    for(const char* path : files) {
+        replayFile(path, options);
+    }
+    return 0;
+}
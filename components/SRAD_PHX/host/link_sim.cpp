@@ -0,0 +1,350 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Downlink over a simulated flight with link adaptation: a RADIO_LINK with
+// a LINK_ADAPTER on a SIM_RADIO, and a ground station with a LINK_FOLLOWER
+// across a 915 MHz channel whose margin follows the rocket's range. The
+// rocket carries a vertical dipole, so the ground sees it in its pattern
+// null as it climbs overhead. Each packet is heard if its SNR, after
+// log-normal fading, clears the profile's demodulation floor and the
+// ground is tuned to it. Prints the profile, the margin and the samples
+// per second the ground decoded, every few seconds of the flight.
+//
+//   link_sim [options]
+//     --fixed N                  keep LINK_PROFILES[N] on both ends, no adaptation
+//     --margins D,T,U[,N[,F]]    LINK_ADAPTER::setMargins(), default 0,2,3,1,0.5
+//     --rate HZ                  samples offered per second (default 10)
+//     --batch N                  send them N to a TELEMETRY_BATCH frame (default 0, one 'T' frame each)
+//     --ground-m M               ground station distance from the pad (default 1500)
+//     --drift MPS                horizontal drift away from it after launch (default 4)
+//     --power DBM                transmit power, both ends (default 10)
+//     --gain DBI                 ground antenna gain (default 6)
+//     --loss DB                  cable, polarization and body losses (default 30)
+//     --fading DB                standard deviation of the per packet fading (default 3)
+//     --seed N                   another run of the fading (default 1)
+//     --thrust MPS2              motor acceleration, higher flies higher (default 120)
+//     --pad S                    seconds on the pad before launch (default 20)
+//     --every S                  seconds per printed row (default 5)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_HAL_Sim.h"
+#include "SRAD_PHX_Link.h"
+#include "SRAD_PHX_Radio.h"
+#include "SRAD_PHX_Telemetry.h"
+#include "SRAD_PHX_Time.h"
+
+static const float FREQUENCY_MHZ = 915.0f;
+static const float DIPOLE_GAIN_DBI = 2.15f;
+static const float DIPOLE_NULL_DB = -20.0f;        // deepest the pattern null gets, straight up
+static const uint32_t GROUND_TURNAROUND_US = 10000;
+
+struct Channel {
+    float groundDistance_m = 1500, drift = 4;
+    float power_dBm = 10, groundGain_dBi = 6, loss_dB = 30, fading_dB = 3;
+    uint32_t noiseState = 0x9E3779B9;
+
+    float range_m = 0, elevation_deg = 0;
+
+    // geometry for the rocket at `altitude`, `sinceLaunch_s` after launch
+    void place(float altitude, float sinceLaunch_s) {
+        float horizontal = groundDistance_m + (sinceLaunch_s > 0 ? drift * sinceLaunch_s : 0);
+        range_m = sqrtf(horizontal * horizontal + altitude * altitude);
+        elevation_deg = atan2f(altitude, horizontal) * 180.0f / float(M_PI);
+    }
+
+    // received power before fading
+    float signal_dBm() const {
+        float path = 20.0f * log10f(range_m / 1000.0f) + 20.0f * log10f(FREQUENCY_MHZ) + 32.44f;
+        float tilt = cosf(elevation_deg * float(M_PI) / 180.0f);
+        float pattern = 10.0f * log10f(tilt * tilt);
+        pattern = pattern > DIPOLE_NULL_DB ? pattern : DIPOLE_NULL_DB;
+        return power_dBm + DIPOLE_GAIN_DBI + pattern + groundGain_dBi - path - loss_dB;
+    }
+
+    // uniform (0, 1], repeatable
+    float uniform() {
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        return (noiseState >> 8) / float(1 << 24) + 1.0f / (1 << 25);
+    }
+
+    // one packet: how the SX127x would report it, `false` if it is lost on `profile`
+    bool hear(uint8_t profile, LinkQuality& heard) {
+        float gaussian = sqrtf(-2.0f * logf(uniform())) * cosf(2.0f * float(M_PI) * uniform());
+        float signal = signal_dBm() + fading_dB * gaussian;
+        const LinkProfile& link = LINK_PROFILES[profile];
+        float noise = linkNoiseFloor(link.modem.bandwidth_Hz);
+        float snr = signal - noise;
+        if(snr < link.snrFloor_dB) {
+            return false;
+        }
+        heard.snr_dB = roundf((snr > 31.75f ? 31.75f : snr) * 4) / 4;
+        heard.rssi_dBm = roundf(10.0f * log10f(powf(10, signal / 10) + powf(10, noise / 10)));
+        return true;
+    }
+};
+
+static bool sameModem(const LoRaSettings& a, const LoRaSettings& b) {
+    return a.spreadingFactor == b.spreadingFactor && a.bandwidth_Hz == b.bandwidth_Hz;
+}
+
+static uint8_t profileOf(const LoRaSettings& modem) {
+    for(uint8_t profile = 0; profile < LINK_PROFILE_COUNT; profile++) {
+        if(sameModem(LINK_PROFILES[profile].modem, modem)) {
+            return profile;
+        }
+    }
+    return LINK_HOME;
+}
+
+static bool inFlight(uint8_t state) {
+    return state == FLIGHT_ASCENT || state == FLIGHT_DESCENT;
+}
+
+// what SIM_RADIO puts on air, one byte length then the packet, heard through the channel
+class GROUND_STATION : public Print {
+    public:
+        GROUND_STATION(Channel& c, int fixedProfile) : channel(c), fixed(fixedProfile) {}
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override {
+            for(size_t ind = 0; ind < size; ind++) {
+                if(!length) {
+                    length = buffer[ind];
+                    received = 0;
+                    continue;
+                }
+                packet[received++] = buffer[ind];
+                if(received == length) {
+                    receive();
+                    length = 0;
+                }
+            }
+            return size;
+        }
+        using Print::write;
+
+        uint8_t profile() const { return fixed >= 0 ? uint8_t(fixed) : follower.getProfile(); }
+
+        SIM_RADIO* rocket = nullptr;       // where the reports go back to
+        LINK_FOLLOWER follower;
+        uint32_t frames = 0, lost = 0, samples = 0, flightSamples = 0;
+        uint64_t longestGap_us = 0;        // between frames with flight samples
+
+    private:
+        void receive() {
+            LinkQuality heard;
+            uint8_t on = profileOf(rocket->settings);
+            if(on != profile() || !channel.hear(on, heard)) {
+                lost += packet[0] != LINK_FRAME_POLL;
+                return;
+            }
+            uint64_t now_us = nowMicros();
+            uint8_t reply[LINK_REPORT_BYTES];
+            if(size_t size = fixed < 0 ? follower.received(packet, length, heard, now_us, reply) : 0) {
+                LinkQuality up;
+                uint64_t at_us = now_us + rocket->airtime_us(length) + GROUND_TURNAROUND_US + rocket->airtime_us(size);
+                if(channel.hear(on, up)) {
+                    rocket->deliver(reply, size, up, at_us);
+                }
+                follower.replied(at_us);
+                return;
+            }
+            if(packet[0] == LINK_FRAME_POLL) {
+                return;
+            }
+            uint16_t sequence;
+            size_t count = telemetryDecodeBatch(packet, length, decoded, 255, sequence);
+            if(!count && telemetryDecode(packet, length, decoded[0], sequence)) {
+                count = 1;
+            }
+            frames += count != 0;
+            samples += count;
+            size_t flying = 0;
+            for(size_t sample = 0; sample < count; sample++) {
+                flying += inFlight(decoded[sample].state);
+            }
+            if(flying) {
+                if(lastFlight_us && now_us - lastFlight_us > longestGap_us) {
+                    longestGap_us = now_us - lastFlight_us;
+                }
+                lastFlight_us = now_us;
+                flightSamples += flying;
+            }
+        }
+
+        Channel& channel;
+        int fixed;
+        uint8_t packet[255];
+        uint8_t length = 0, received = 0;
+        uint64_t lastFlight_us = 0;
+        SampleRecord decoded[255];
+};
+
+static const char* profileName(uint8_t profile) {
+    static char names[LINK_PROFILE_COUNT][16];
+    const LoRaSettings& modem = LINK_PROFILES[profile].modem;
+    snprintf(names[profile], sizeof(names[profile]), "SF%u/%u", modem.spreadingFactor, unsigned(modem.bandwidth_Hz / 1000));
+    return names[profile];
+}
+
+int main(int argc, char** argv) {
+    Channel channel;
+    int fixed = -1;
+    unsigned rate_hz = 10, batchSamples = 0;
+    float every_s = 5, thrust = 120, pad_s = 20;
+    float down = 0, target = 2, up = 3, minDelivered = 0.5f;
+    unsigned upReports = 1;
+    for(int arg = 1; arg + 1 < argc; arg += 2) {
+        const char* name = argv[arg];
+        const char* value = argv[arg + 1];
+        if(!strcmp(name, "--fixed")) {
+            fixed = atoi(value);
+        } else if(!strcmp(name, "--margins")) {
+            if(sscanf(value, "%f,%f,%f,%u,%f", &down, &target, &up, &upReports, &minDelivered) < 3) {
+                fprintf(stderr, "--margins takes down,target,up[,reports[,delivered]], margins in dB\n");
+                return 2;
+            }
+        } else if(!strcmp(name, "--rate")) {
+            rate_hz = atoi(value);
+        } else if(!strcmp(name, "--batch")) {
+            batchSamples = atoi(value);
+        } else if(!strcmp(name, "--ground-m")) {
+            channel.groundDistance_m = atof(value);
+        } else if(!strcmp(name, "--drift")) {
+            channel.drift = atof(value);
+        } else if(!strcmp(name, "--power")) {
+            channel.power_dBm = atof(value);
+        } else if(!strcmp(name, "--gain")) {
+            channel.groundGain_dBi = atof(value);
+        } else if(!strcmp(name, "--loss")) {
+            channel.loss_dB = atof(value);
+        } else if(!strcmp(name, "--fading")) {
+            channel.fading_dB = atof(value);
+        } else if(!strcmp(name, "--seed")) {
+            channel.noiseState = 0x9E3779B9u * uint32_t(atoi(value) | 1);
+        } else if(!strcmp(name, "--thrust")) {
+            thrust = atof(value);
+        } else if(!strcmp(name, "--pad")) {
+            pad_s = atof(value);
+        } else if(!strcmp(name, "--every")) {
+            every_s = atof(value);
+        } else {
+            fprintf(stderr, "unknown option %s, see the top of link_sim.cpp\n", name);
+            return 2;
+        }
+    }
+    if(fixed >= LINK_PROFILE_COUNT || rate_hz == 0 || rate_hz > 1000 || every_s <= 0 || pad_s < 0) {
+        fprintf(stderr, "bad option value\n");
+        return 2;
+    }
+
+    SIM_TRAJECTORY trajectory;
+    trajectory.thrustAccel = thrust;
+    trajectory.launchTime_us = uint64_t(pad_s * 1e6f);
+    hostSetTime(0);
+    static GROUND_STATION ground(channel, fixed);
+    static SIM_RADIO radio(LINK_PROFILES[fixed >= 0 ? fixed : LINK_HOME].modem, &ground);
+    ground.rocket = &radio;
+    static RADIO_LINK link(radio);
+    static LINK_ADAPTER adapter;
+    adapter.setMargins(down, target, up, uint8_t(upReports), minDelivered);
+    if(fixed < 0) {
+        link.setAdapter(&adapter);
+    }
+    static TELEMETRY_BATCH batch;
+    for(uint8_t flightState = PRE_NO_CAL; flightState <= POST_LANDED; flightState++) {
+        batch.setRate(STATES(flightState), 1, batchSamples);
+    }
+
+    printf("%8s %8s %8s %6s  %-9s %-9s %8s %10s %9s\n",
+           "time s", "alt m", "range m", "elev", "flight", "ground", "margin", "samples/s", "lost");
+    const uint32_t period_us = 1000;
+    const uint32_t sampleEvery = 1000 / rate_hz;
+    const uint64_t every_us = uint64_t(every_s * 1e6f);
+    uint64_t landed_us = 0, nextRow_us = every_us;
+    uint32_t rowSamples = 0, rowLost = 0, offered = 0, flightOffered = 0;
+    uint16_t sequence = 0;
+    SampleRecord record = {};
+    record.data.gps_fix = 1;
+    record.data.gps_sats = 9;
+    record.data.bno_ori_w = 1;
+
+    for(uint64_t loops = 0; !landed_us || nowMicros() < landed_us + 10000000; loops++) {
+        uint64_t time_us = (loops + 1) * period_us;
+        hostSetTime(time_us);
+        trajectory.update(time_us);
+        float sinceLaunch_s = (int64_t(time_us) - int64_t(trajectory.launchTime_us)) / 1e6f;
+        channel.place(trajectory.altitude(), sinceLaunch_s);
+        if(trajectory.hasLanded() && !landed_us) {
+            landed_us = time_us;
+        }
+
+        if(loops % sampleEvery == 0) {
+            // just the fields the frames carry, from the trajectory
+            record.time_us = time_us;
+            record.state = trajectory.hasLanded() ? POST_LANDED : trajectory.apogeeTime_us() ? FLIGHT_DESCENT
+                         : sinceLaunch_s > 0 ? FLIGHT_ASCENT : PRE_CAL;
+            record.data.bmp_alt = record.data.ekf_alt = trajectory.altitude() + trajectory.padAltitude_m;
+            record.data.ekf_vel = trajectory.velocity();
+            record.data.adxl_acc_z = trajectory.specificForce();
+            record.data.bmp_press = 101325.0f * powf(1 - record.data.bmp_alt / 44330.0f, 5.255f);
+            record.data.gps_alt = record.data.bmp_alt;
+            record.data.gps_lat = 32.99f + channel.range_m * 9e-6f;
+            record.data.gps_lon = -106.97f;
+            offered++;
+            flightOffered += inFlight(record.state);
+
+            uint8_t frame[RADIO_FRAME_SIZE];
+            size_t size = batchSamples ? batch.add(record, frame) : telemetryEncode(record, sequence++, frame);
+            if(size) {
+                link.send(frame, size);
+            }
+        }
+        link.service();
+        if(fixed < 0) {
+            ground.follower.update(time_us);
+        }
+
+        if(time_us >= nextRow_us) {
+            uint8_t flying = profileOf(radio.settings);
+            float margin = channel.signal_dBm() - linkNoiseFloor(LINK_PROFILES[flying].modem.bandwidth_Hz)
+                         - LINK_PROFILES[flying].snrFloor_dB;
+            printf("%8.1f %8.0f %8.0f %6.1f  %-9s %-9s %8.1f %10.2f %9u\n",
+                   time_us / 1e6, trajectory.altitude(), channel.range_m, channel.elevation_deg,
+                   profileName(flying), profileName(ground.profile()), margin,
+                   (ground.samples - rowSamples) / every_s, ground.lost - rowLost);
+            rowSamples = ground.samples;
+            rowLost = ground.lost;
+            nextRow_us += every_us;
+        }
+    }
+
+    RadioStats stats = link.getStats();
+    double seconds = nowMicros() / 1e6;
+    printf("ground: %u of %u samples (%.1f%%), %.2f samples/s over %.0f s, %u frames heard, %u lost; apogee %.0f m\n",
+           ground.samples, offered, 100.0 * ground.samples / offered, ground.samples / seconds, seconds,
+           ground.frames, ground.lost, trajectory.apogeeAltitude());
+    double flight_s = (landed_us - trajectory.launchTime_us) / 1e6;
+    printf("flight: %u of %u samples (%.1f%%), %.2f samples/s over %.0f s, longest gap %.1f s\n",
+           ground.flightSamples, flightOffered, 100.0 * ground.flightSamples / flightOffered,
+           ground.flightSamples / flight_s, flight_s, ground.longestGap_us / 1e6);
+    printf("radio: %u frames sent, %u dropped at the queue\n", stats.framesSent, stats.framesDropped);
+    if(fixed < 0) {
+        Serial.setEcho(true);
+        adapter.printStats(Serial);
+    }
+    return 0;
+}
@@ -0,0 +1,477 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Turns a binary flight log (FLIGHT::writeSD in LOG_FORMAT_BINARY or
+// LOG_FORMAT_RAW) back into the exact CSV writeSD prints in LOG_FORMAT_CSV,
+// byte for byte. Record layouts come from the schema in the file header;
+// record types this build doesn't know are skipped by their size. Raw
+// counts are converted with the file's 'C' record, the Adafruit driver
+// scales if it has none. 'D' records are undone against the record before
+// them; any before the first keyframe are counted and skipped.
+//
+// A framed log (LOG_FRAMER) is unframed first. The recovery scan finds the
+// last valid block, anything after it is a torn tail. Up to there, a bad
+// block or a gap in the sequence numbers (blocks the writer dropped) ends
+// a run of records; the next run starts at the next block's first record,
+// and its 'D' records wait for a keyframe. Byte offsets in messages then
+// count from the start of the run's payload. A framed CSV log comes out
+// as its text, each run cut to whole lines.
+//
+//   log_decode flight.bin [out.csv]      CSV to out.csv, or stdout
+//     --schema                           print the header schema instead
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_Frame.h"
+
+class FILE_PRINT : public Print {
+    public:
+        FILE_PRINT(FILE* f) : file(f) {}
+        size_t write(uint8_t c) override { return fputc(c, file) == EOF ? 0 : 1; }
+        size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, file); }
+        using Print::write;
+
+    private:
+        FILE* file;
+};
+
+struct SchemaField {
+    std::string name;
+    uint8_t encoding, decimals;
+    uint8_t conversion;             // RAW_CONVERSIONS, from this build's table by name
+};
+
+struct SchemaType {
+    uint8_t type;
+    uint16_t size;
+    std::vector<SchemaField> fields;
+};
+
+class READER {
+    public:
+        READER(const std::vector<uint8_t>& b) : bytes(b) {}
+        bool has(size_t count) const { return offset + count <= bytes.size(); }
+        uint64_t get(uint8_t count) {
+            uint64_t value = 0;
+            for(uint8_t ind = 0; ind < count; ind++) {
+                value |= uint64_t(bytes[offset++]) << (8 * ind);
+            }
+            return value;
+        }
+        const uint8_t* take(size_t count) {
+            offset += count;
+            return &bytes[offset - count];
+        }
+        size_t position() const { return offset; }
+
+    private:
+        const std::vector<uint8_t>& bytes;
+        size_t offset = 0;
+};
+
+class MEMORY_FRAME_SOURCE : public FRAME_SOURCE {
+    public:
+        MEMORY_FRAME_SOURCE(const std::vector<uint8_t>& b) : bytes(b) {}
+        uint32_t blockCount() override { return uint32_t(bytes.size() / LOG_FRAME_SIZE); }
+        bool readBlock(uint32_t index, uint8_t* block) override {
+            memcpy(block, &bytes[size_t(index) * LOG_FRAME_SIZE], LOG_FRAME_SIZE);
+            return true;
+        }
+
+    private:
+        const std::vector<uint8_t>& bytes;
+};
+
+// the payloads of a framed log as runs of whole records
+static std::vector<std::vector<uint8_t>> unframe(const std::vector<uint8_t>& bytes) {
+    MEMORY_FRAME_SOURCE source(bytes);
+    FrameRecovery recovery = logFrameRecover(source);
+    fprintf(stderr, "framed log, stream %08x: %u of %u blocks up to the last valid one, found in %u reads",
+            recovery.stream, recovery.blocks, source.blockCount(), recovery.reads);
+
+    std::vector<std::vector<uint8_t>> runs;
+    uint32_t bad = 0, gaps = 0, expected = 0;
+    bool broken = true;
+    for(uint32_t index = 0; index < recovery.blocks; index++) {
+        const uint8_t* block = &bytes[size_t(index) * LOG_FRAME_SIZE];
+        FrameHeader header;
+        if(!logFrameCheck(block, &header) || header.stream != recovery.stream) {
+            bad++;
+            expected++;                     // it took a sequence number, not a gap
+            broken = true;
+            continue;
+        }
+        if(header.sequence != expected) {
+            gaps++;
+            broken = true;
+        }
+        expected = header.sequence + 1;
+        uint16_t start = 0;
+        if(broken) {
+            if(header.firstRecord == LOG_FRAME_NO_RECORD) {
+                continue;                   // the middle of a record whose start is lost
+            }
+            runs.emplace_back();
+            start = header.firstRecord;
+            broken = false;
+        }
+        const uint8_t* payload = block + LOG_FRAME_HEADER_SIZE;
+        runs.back().insert(runs.back().end(), payload + start, payload + header.length);
+    }
+    fprintf(stderr, ", %u bad, %u sequence gaps\n", bad, gaps);
+    return runs;
+}
+
+// a framed LOG_FORMAT_CSV log: rows are many writes, so runs are cut to whole lines
+static int copyCsvRuns(const std::vector<std::vector<uint8_t>>& runs, const char* outputPath) {
+    FILE* output = outputPath ? fopen(outputPath, "wb") : stdout;
+    if(!output) {
+        perror(outputPath);
+        return 1;
+    }
+    uint64_t rows = 0;
+    for(size_t run = 0; run < runs.size(); run++) {
+        const uint8_t* begin = runs[run].data();
+        const uint8_t* end = begin + runs[run].size();
+        if(run) {
+            while(begin < end && *begin++ != '\n') {}      // the row a lost block cut
+        }
+        while(end > begin && end[-1] != '\n') {
+            end--;
+        }
+        fwrite(begin, 1, end - begin, output);
+        for(const uint8_t* at = begin; at < end; at++) {
+            rows += *at == '\n';
+        }
+    }
+    if(output != stdout) {
+        fclose(output);
+    }
+    fprintf(stderr, "framed CSV log: %llu lines\n", (unsigned long long)rows);
+    return 0;
+}
+
+// one decoded field, printed the way writeSD printed the original float
+struct FieldValue {
+    uint8_t encoding, decimals, conversion;
+    uint64_t raw;
+};
+
+static RawScales scales = RAW_SCALES_ADAFRUIT;
+
+static FieldValue readField(READER& in, const SchemaField& field) {
+    FieldValue value = {field.encoding, field.decimals, field.conversion, 0};
+    value.raw = in.get(LOG_ENCODING_BYTES[field.encoding]);
+    return value;
+}
+
+static void printField(Print& out, const FieldValue& value) {
+    if(value.encoding == LOG_F32) {
+        uint32_t bits = uint32_t(value.raw);
+        float number;
+        memcpy(&number, &bits, sizeof(number));
+        out.print(number, value.decimals);
+    } else if(value.encoding == LOG_FIXED16 || value.encoding == LOG_FIXED24) {
+        uint8_t width = value.encoding == LOG_FIXED16 ? 16 : 24;
+        int32_t fixed = int32_t(uint32_t(value.raw) << (32 - width)) >> (32 - width);
+        char text[24];
+        out.write(text, logFormatFixed(fixed, value.decimals, width, text));
+    } else if(value.encoding == LOG_I8 || value.encoding == LOG_I16) {
+        uint8_t width = value.encoding == LOG_I8 ? 8 : 16;
+        int32_t count = int32_t(uint32_t(value.raw) << (32 - width)) >> (32 - width);
+        out.print(rawConvert(value.conversion, count, scales), value.decimals);
+    } else {
+        out.print((unsigned long long)value.raw);
+    }
+}
+
+static bool readSchema(READER& in, std::vector<SchemaType>& types, std::string& csvHeader) {
+    if(!in.has(6) || in.get(4) != LOG_MAGIC) {
+        fprintf(stderr, "not a flight log\n");
+        return false;
+    }
+    uint8_t version = in.get(1);
+    if(version < 1 || version > LOG_VERSION) {
+        fprintf(stderr, "log version %u, this decoder reads 1 to %u\n", version, LOG_VERSION);
+        return false;
+    }
+    uint8_t typeCount = in.get(1);
+    for(uint8_t type = 0; type < typeCount; type++) {
+        if(!in.has(4)) {
+            return false;
+        }
+        SchemaType schema;
+        schema.type = in.get(1);
+        schema.size = in.get(2);
+        uint8_t fieldCount = in.get(1);
+        for(uint8_t field = 0; field < fieldCount; field++) {
+            if(!in.has(3)) {
+                return false;
+            }
+            SchemaField description;
+            description.encoding = in.get(1);
+            description.decimals = in.get(1);
+            uint8_t nameLength = in.get(1);
+            if(!in.has(nameLength) || description.encoding > LOG_I16) {
+                return false;
+            }
+            description.name.assign((const char*)in.take(nameLength), nameLength);
+            const LogField* known = logFindField(schema.type, description.name.c_str());
+            description.conversion = known ? known->conversion : uint8_t(RAW_NONE);
+            schema.fields.push_back(description);
+        }
+        types.push_back(schema);
+    }
+    if(!in.has(2)) {
+        return false;
+    }
+    uint16_t headerLength = in.get(2);
+    if(!in.has(headerLength)) {
+        return false;
+    }
+    csvHeader.assign((const char*)in.take(headerLength), headerLength);
+    return true;
+}
+
+// 'C' record into `scales`, by field name so scales can be added or reordered
+static void readScales(READER& in, const SchemaType& schema) {
+    static const struct {
+        const char* name;
+        float RawScales::*member;
+    } MEMBERS[] = {
+        {"lsm_temp_scale", &RawScales::lsm_temp}, {"adxl_acc_scale", &RawScales::adxl_acc},
+        {"bno_quat_scale", &RawScales::bno_quat}, {"bno_gyro_scale", &RawScales::bno_gyro},
+        {"bno_acc_scale", &RawScales::bno_acc}, {"bno_mag_scale", &RawScales::bno_mag},
+    };
+    for(const SchemaField& field : schema.fields) {
+        FieldValue value = readField(in, field);
+        for(const auto& member : MEMBERS) {
+            if(field.encoding == LOG_F32 && field.name == member.name) {
+                uint32_t bits = uint32_t(value.raw);
+                memcpy(&(scales.*member.member), &bits, sizeof(float));
+            }
+        }
+    }
+}
+
+// the GPS columns exactly as writeSD's `last_gps != nullptr` branch prints them
+static void printGps(Print& out, const std::vector<FieldValue>& gps) {
+    if(gps.empty() || !gps[0].raw) {
+        out.print("-1,No fix,-1,No fix,0,-1,-1,-1,");
+        return;
+    }
+    printField(out, gps[2]); out.print(", ");
+    printField(out, gps[3]); out.print(",");
+    out.print((int32_t)gps[1].raw); out.print(",");
+    printField(out, gps[4]); out.print(",");
+    printField(out, gps[5]); out.print(",");
+    printField(out, gps[6]); out.print(",");
+}
+
+int main(int argc, char** argv) {
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    bool schemaOnly = false;
+    for(int arg = 1; arg < argc; arg++) {
+        if(!strcmp(argv[arg], "--schema")) {
+            schemaOnly = true;
+        } else if(!inputPath) {
+            inputPath = argv[arg];
+        } else {
+            outputPath = argv[arg];
+        }
+    }
+    if(!inputPath) {
+        fprintf(stderr, "usage: %s [--schema] flight.bin [out.csv]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* input = fopen(inputPath, "rb");
+    if(!input) {
+        perror(inputPath);
+        return 1;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[65536];
+    size_t got;
+    while((got = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + got);
+    }
+    fclose(input);
+
+    std::vector<std::vector<uint8_t>> runs;
+    bool framed = bytes.size() >= 4 && READER(bytes).get(4) == LOG_FRAME_MAGIC;
+    if(framed) {
+        runs = unframe(bytes);
+    } else {
+        runs.push_back(bytes);
+    }
+    if(runs.empty()) {
+        fprintf(stderr, "%s: no valid first block\n", inputPath);
+        return 1;
+    }
+    if(framed && (runs[0].size() < 4 || READER(runs[0]).get(4) != LOG_MAGIC)) {
+        return copyCsvRuns(runs, outputPath);
+    }
+
+    READER header(runs[0]);
+    std::vector<SchemaType> types;
+    std::string csvHeader;
+    if(!readSchema(header, types, csvHeader)) {
+        fprintf(stderr, "%s: bad header\n", inputPath);
+        return 1;
+    }
+    if(schemaOnly) {
+        for(const SchemaType& schema : types) {
+            if(schema.size == LOG_SIZE_VARIABLE) {
+                printf("'%c' record, variable size\n", schema.type);
+            } else {
+                printf("'%c' record, %u bytes\n", schema.type, schema.size);
+            }
+            for(const SchemaField& field : schema.fields) {
+                printf("  %-14s encoding %u, %u decimals", field.name.c_str(), field.encoding, field.decimals);
+                if(field.conversion != RAW_NONE) {
+                    printf(", conversion %u", field.conversion);
+                }
+                printf("\n");
+            }
+        }
+        printf("csv header: %s\n", csvHeader.c_str());
+        return 0;
+    }
+
+    FILE* output = outputPath ? fopen(outputPath, "wb") : stdout;
+    if(!output) {
+        perror(outputPath);
+        return 1;
+    }
+    FILE_PRINT out(output);
+    out.println(String(csvHeader));
+
+    std::vector<FieldValue> gps, sample;
+    uint64_t samples = 0, skipped = 0, orphaned = 0;
+    std::vector<uint8_t> last;              // last 'S'/'R' record, type byte included, what 'D' builds on
+    const SchemaType* lastSchema = nullptr;
+    std::vector<uint8_t> lastBytes;         // its field widths
+    for(size_t run = 0; run < runs.size(); run++) {
+        READER in(runs[run]);
+        if(run) {
+            lastSchema = nullptr;               // the record before this run's first is lost
+        } else {
+            in.take(header.position());
+        }
+        while(in.has(1)) {
+            uint8_t type = in.get(1);
+            const SchemaType* schema = nullptr;
+            for(const SchemaType& candidate : types) {
+                if(candidate.type == type) {
+                    schema = &candidate;
+                }
+            }
+            if(!schema && type == 0) {
+                break;                      // zero filled FLIGHT_FILE extent past the last record
+            }
+            if(!schema) {
+                fprintf(stderr, "unknown record type 0x%02x at byte %zu, stopping\n", type, in.position() - 1);
+                break;
+            }
+            size_t recordStart = in.position() - 1;
+            bool variable = schema->size == LOG_SIZE_VARIABLE;
+            size_t length = variable ? 0 : schema->size - 1;
+            if(variable && in.has(1)) {
+                length = in.get(1);
+            }
+            if((variable && in.position() == recordStart + 1) || !in.has(length)) {
+                if(run + 1 == runs.size()) {
+                    fprintf(stderr, "truncated '%c' record at byte %zu\n", type, recordStart);
+                }
+                break;                  // earlier runs end where a lost block cut a record
+            }
+            if(type == LOG_RECORD_SCALES) {
+                readScales(in, *schema);
+                continue;
+            }
+            if(type == LOG_RECORD_GPS) {
+                gps.clear();
+                for(const SchemaField& field : schema->fields) {
+                    gps.push_back(readField(in, field));
+                }
+                continue;
+            }
+            if(type == LOG_RECORD_SAMPLE || type == LOG_RECORD_RAW) {
+                lastSchema = schema;
+                lastBytes.clear();
+                for(const SchemaField& field : schema->fields) {
+                    lastBytes.push_back(LOG_ENCODING_BYTES[field.encoding]);
+                }
+                const uint8_t* body = in.take(length);
+                last.assign(1, type);
+                last.insert(last.end(), body, body + length);
+            } else if(type == LOG_RECORD_DELTA) {
+                const uint8_t* payload = in.take(length);
+                if(!lastSchema) {
+                    orphaned++;
+                    continue;
+                }
+                if(!logDeltaDecode(last.data(), lastBytes.data(), uint8_t(lastBytes.size()), payload, length)) {
+                    fprintf(stderr, "bad 'D' record at byte %zu, skipping to the next keyframe\n", recordStart);
+                    lastSchema = nullptr;
+                    continue;
+                }
+            } else {
+                in.take(length);
+                skipped++;
+                continue;
+            }
+
+            READER record(last);
+            record.take(1);
+            sample.clear();
+            for(const SchemaField& field : lastSchema->fields) {
+                sample.push_back(readField(record, field));
+            }
+
+            // time_us, flags, then the fields in column order
+            out.print((unsigned long long)sample[0].raw); out.print(", ");
+            uint16_t flags = uint16_t(sample[1].raw);
+            if(flags & LOG_FLAG_GPS_COLUMNS) {
+                printGps(out, gps);
+            }
+            for(size_t field = 2; field < sample.size(); field++) {
+                printField(out, sample[field]); out.print(",");
+            }
+            for(uint8_t sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+                if(sensor) {
+                    out.print(",");
+                }
+                out.print((flags >> sensor) & 1);
+            }
+            out.println();
+            samples++;
+        }
+    }
+    if(output != stdout) {
+        fclose(output);
+    }
+    fprintf(stderr, "%llu samples from %zu bytes", (unsigned long long)samples, bytes.size());
+    if(skipped) {
+        fprintf(stderr, ", %llu unknown records skipped", (unsigned long long)skipped);
+    }
+    if(orphaned) {
+        fprintf(stderr, ", %llu 'D' records before the first keyframe skipped", (unsigned long long)orphaned);
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
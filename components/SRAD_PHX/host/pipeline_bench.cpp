@@ -0,0 +1,610 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Runs the whole flight loop (read_* -> calculateState -> pushSample ->
+// writeSD) on the simulated HAL backend as fast as the host allows, and
+// reports the wall-clock cost per loop next to FLIGHT's own stage profile.
+// Simulated time advances one loop period per iteration, so the flight
+// itself is identical on every run.
+//
+//   pipeline_bench [options]
+//     --rate HZ          loop rate, LSM/ADXL/BNO are read every loop (default 1000)
+//     --baro-rate HZ     BMP read rate (default 25)
+//     --gps-rate HZ      GPS read rate (default 10)
+//     --seconds S        simulated seconds (default: until 5 s after landing, at most 600)
+//     --fail lsm|bmp|adxl|bno|gps   fail a device for the whole run, repeatable
+//     --noise SCALE      sensor noise multiplier (default 1)
+//     --apogee N,V,C     detector window samples, descent m/s, confirmations (default 10,1,3)
+//     --no-fusion        judge apogee on the BMP fit only
+//     --format csv|binary|raw  writeSD log format (default binary)
+//     --keyframes N      delta code binary samples, a keyframe every N (default 0, off)
+//     --csv PATH         also keep the log, otherwise it is only counted
+//     --writer           log through LOG_WRITER, drained by its own thread
+//     --framed           cut the log into CRC32 checked LOG_FRAMER blocks
+//     --sd-stall MS[,KB] every KB written (default 1024) one write takes MS longer
+//     --realtime         pace loops to the wall clock, so stalls cost what they would in flight
+//     --blackbox IMAGE   also log to a BLACK_BOX on a simulated 960 KB partition kept in IMAGE
+//                        (loaded first if it exists, like the next flight on the same board)
+//     --blackbox-sync MS black box file sync interval (default 2000)
+//     --reset-at S[,MS]  warm reset at S simulated seconds: the board is out for MS (default 250),
+//                        then a new FLIGHT (and LOG_FRAMER) picks up from what the RTC store kept
+//     --radio SF[,HZ[,KHZ]]  queue a telemetryEncode() frame HZ times a second (default 10) on a
+//                        RADIO_LINK over a simulated SF, KHZ (default 125), 4/5 LoRa link, serviced once per loop
+//     --batch N          send the HZ samples N to a TELEMETRY_BATCH frame instead
+//     --ground PATH      keep what the radio sent, for telemetry_decode
+//     --quiet            skip the stage profile
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <thread>
+
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_BlackBox.h"
+#include "SRAD_PHX_Frame.h"
+#include "SRAD_PHX_HAL_Sim.h"
+#include "SRAD_PHX_Radio.h"
+#include "SRAD_PHX_Telemetry.h"
+#include "SRAD_PHX_Writer.h"
+
+static const char* STATE_NAMES[] = {
+    "PRE_NO_CAL", "PRE_CAL", "FLIGHT_ASCENT", "FLIGHT_DESCENT", "POST_LANDED"
+};
+
+// keeps the log off the disk unless --csv asked for it, and plays SD card hiccups
+class COUNTING_FILE : public SIM_STORAGE {
+    public:
+        COUNTING_FILE(FILE* f) : file(f) {}
+        size_t write(const uint8_t* buffer, size_t size) override {
+            if(file) {
+                fwrite(buffer, 1, size, file);
+            }
+            if(stall_ms && (bytesWritten() + size) / stallEvery != bytesWritten() / stallEvery) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(stall_ms));
+                stalls++;
+            }
+            return SIM_STORAGE::write(buffer, size);
+        }
+        using SIM_STORAGE::write;
+
+        uint32_t stall_ms = 0;
+        size_t stallEvery = 1024 * 1024;
+        uint32_t stalls = 0;
+
+    private:
+        FILE* file;
+};
+
+// decodes what reaches it to count samples, and keeps it for --ground
+class GROUND_STATION : public Print {
+    public:
+        GROUND_STATION(FILE* f) : file(f) {}
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override {
+            if(file) {
+                fwrite(buffer, 1, size, file);
+            }
+            for(size_t ind = 0; ind < size; ind++) {
+                if(!length) {
+                    length = buffer[ind];
+                    received = 0;
+                    continue;
+                }
+                packet[received++] = buffer[ind];
+                if(received == length) {
+                    receive();
+                    length = 0;
+                }
+            }
+            return size;
+        }
+        using Print::write;
+
+        uint32_t frames = 0, samples = 0, bad = 0;
+
+    private:
+        void receive() {
+            SampleRecord sample;
+            uint16_t sequence;
+            size_t count = telemetryDecodeBatch(packet, length, decoded, 255, sequence);
+            if(!count && telemetryDecode(packet, length, sample, sequence)) {
+                count = 1;
+            }
+            frames += count != 0;
+            samples += count;
+            bad += count == 0;
+        }
+
+        FILE* file;
+        uint8_t packet[255];
+        uint8_t length = 0, received = 0;
+        SampleRecord decoded[255];
+};
+
+// partitions.csv "blackbox", and typical SPI NOR timings for estimating the time flash keeps the CPU stalled
+static const uint32_t BLACKBOX_PARTITION_SIZE = 0xF0000;
+static const uint32_t BLACKBOX_BLOCK_SIZE = 4096;
+static const float FLASH_PAGE_PROGRAM_MS = 0.5f;       // per 256 byte page
+static const float FLASH_BLOCK_ERASE_MS = 45.0f;       // per 4 KB sector
+
+static uint32_t everyLoops(uint32_t rate_hz, uint32_t sensorRate_hz) {
+    return sensorRate_hz && sensorRate_hz < rate_hz ? rate_hz / sensorRate_hz : 1;
+}
+
+int main(int argc, char** argv) {
+    uint32_t rate_hz = 1000, baroRate_hz = 25, gpsRate_hz = 10;
+    float seconds = 0, noise = 1;
+    uint8_t apogeeWindow = 10, apogeeConfirm = 3;
+    float apogeeDescentRate = 1;
+    const char* csvPath = nullptr;
+    const char* blackBoxPath = nullptr;
+    const char* groundPath = nullptr;
+    unsigned blackBoxSync_ms = 2000;
+    bool quiet = false, useFusion = true, useWriter = false, realtime = false, framed = false;
+    unsigned stall_ms = 0, stallEvery_kb = 1024;
+    LOG_FORMATS logFormat = LOG_FORMAT_BINARY;
+    unsigned keyframes = 0;
+    float resetAt = 0;
+    unsigned resetOutage_ms = 250;
+    unsigned radioSf = 0, radioRate_hz = 10, radioBandwidth_khz = 125, batchSamples = 0;
+
+    SIM_TRAJECTORY trajectory;
+    SIM_IMU lsm(trajectory);
+    SIM_BARO bmp(trajectory);
+    SIM_ACCEL adxl(trajectory);
+    SIM_AHRS bno(trajectory);
+    SIM_GPS gps(trajectory);
+
+    for(int arg = 1; arg < argc; arg++) {
+        const char* name = argv[arg];
+        const char* value = arg + 1 < argc ? argv[arg + 1] : nullptr;
+        if(!strcmp(name, "--quiet")) {
+            quiet = true;
+            continue;
+        }
+        if(!strcmp(name, "--no-fusion")) {
+            useFusion = false;
+            continue;
+        }
+        if(!strcmp(name, "--writer")) {
+            useWriter = true;
+            continue;
+        }
+        if(!strcmp(name, "--framed")) {
+            framed = true;
+            continue;
+        }
+        if(!strcmp(name, "--realtime")) {
+            realtime = true;
+            continue;
+        }
+        if(!value) {
+            fprintf(stderr, "usage: %s [options], see the top of pipeline_bench.cpp\n", argv[0]);
+            return 2;
+        }
+        if(!strcmp(name, "--rate")) {
+            rate_hz = atoi(value) > 0 ? atoi(value) : 1;
+        } else if(!strcmp(name, "--baro-rate")) {
+            baroRate_hz = atoi(value);
+        } else if(!strcmp(name, "--gps-rate")) {
+            gpsRate_hz = atoi(value);
+        } else if(!strcmp(name, "--seconds")) {
+            seconds = atof(value);
+        } else if(!strcmp(name, "--noise")) {
+            noise = atof(value);
+        } else if(!strcmp(name, "--apogee")) {
+            unsigned window = 10, confirm = 3;
+            float descentRate = 1;
+            sscanf(value, "%u,%f,%u", &window, &descentRate, &confirm);
+            apogeeWindow = window;
+            apogeeDescentRate = descentRate;
+            apogeeConfirm = confirm;
+        } else if(!strcmp(name, "--format")) {
+            if(!strcmp(value, "csv")) {
+                logFormat = LOG_FORMAT_CSV;
+            } else if(!strcmp(value, "binary")) {
+                logFormat = LOG_FORMAT_BINARY;
+            } else if(!strcmp(value, "raw")) {
+                logFormat = LOG_FORMAT_RAW;
+            } else {
+                fprintf(stderr, "unknown format %s\n", value);
+                return 2;
+            }
+        } else if(!strcmp(name, "--keyframes")) {
+            keyframes = atoi(value);
+        } else if(!strcmp(name, "--sd-stall")) {
+            sscanf(value, "%u,%u", &stall_ms, &stallEvery_kb);
+        } else if(!strcmp(name, "--blackbox")) {
+            blackBoxPath = value;
+        } else if(!strcmp(name, "--blackbox-sync")) {
+            blackBoxSync_ms = atoi(value);
+        } else if(!strcmp(name, "--reset-at")) {
+            sscanf(value, "%f,%u", &resetAt, &resetOutage_ms);
+        } else if(!strcmp(name, "--radio")) {
+            sscanf(value, "%u,%u,%u", &radioSf, &radioRate_hz, &radioBandwidth_khz);
+        } else if(!strcmp(name, "--batch")) {
+            batchSamples = atoi(value);
+        } else if(!strcmp(name, "--ground")) {
+            groundPath = value;
+        } else if(!strcmp(name, "--csv")) {
+            csvPath = value;
+        } else if(!strcmp(name, "--fail")) {
+            SIM_DEVICE* device = !strcmp(value, "lsm") ? (SIM_DEVICE*)&lsm : !strcmp(value, "bmp") ? (SIM_DEVICE*)&bmp
+                               : !strcmp(value, "adxl") ? (SIM_DEVICE*)&adxl : !strcmp(value, "bno") ? (SIM_DEVICE*)&bno
+                               : !strcmp(value, "gps") ? (SIM_DEVICE*)&gps : nullptr;
+            if(!device) {
+                fprintf(stderr, "unknown device %s\n", value);
+                return 2;
+            }
+            device->failed = true;
+        } else {
+            fprintf(stderr, "unknown option %s, see the top of pipeline_bench.cpp\n", name);
+            return 2;
+        }
+        arg++;
+    }
+    lsm.noiseScale = bmp.noiseScale = adxl.noiseScale = bno.noiseScale = gps.noiseScale = noise;
+
+    FILE* csv = nullptr;
+    if(csvPath && !(csv = fopen(csvPath, "w"))) {
+        perror(csvPath);
+        return 1;
+    }
+    static COUNTING_FILE log(csv);         // static like the writer, whose destructor still flushes it
+    log.stall_ms = stall_ms;
+    log.stallEvery = size_t(stallEvery_kb ? stallEvery_kb : 1) * 1024;
+
+    // the writer thread stands in for the writer task
+    static LOG_WRITER writer(log);
+    std::atomic<bool> writerRunning{useWriter};
+    std::thread writerThread;
+    if(useWriter) {
+        writerThread = std::thread([&]() {
+            while(writerRunning) {
+                if(!writer.service()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+    }
+    Print& card = useWriter ? (Print&)writer : (Print&)log;
+    LOG_FRAMER bootFramer(card);
+    std::unique_ptr<LOG_FRAMER> resumedFramer;
+    LOG_FRAMER* framer = &bootFramer;
+    Print* sink = framed ? (Print*)framer : &card;
+
+    const char* csvHeader = "time_us, lat, lon, sats, speed, angle, gps_alt, ori_w, ori_x, ori_y, ori_z, "
+                            "gyro_x, gyro_y, gyro_z, acc_x, acc_y, acc_z, adxl_x, adxl_y, adxl_z, press, alt, "
+                            "lsm_temp, adxl_temp, bno_temp, bmp_temp, lsm, bmp, adxl, bno, gps";
+    TelemetryData initial = {};
+    // the FLIGHT after a --reset-at comes up with the same configuration, its RAM lost
+    static FLIGHT bootFlight(20, 100, 5000, 10, String(csvHeader), gps, initial);
+    static FLIGHT resumedFlight(20, 100, 5000, 10, String(csvHeader), gps, initial);
+    static FlightRing bootRing, resumedRing;
+    for(FLIGHT* board : {&bootFlight, &resumedFlight}) {
+        board->attachRing(board == &bootFlight ? bootRing : resumedRing);
+        board->getApogee().configure(apogeeWindow, apogeeDescentRate, apogeeConfirm);
+        board->getFusion().driveApogee = useFusion;
+        board->setLogFormat(logFormat);
+        board->setLogKeyframes(keyframes);
+    }
+    FLIGHT* flight = &bootFlight;
+    FlightRing* ring = &bootRing;
+    resumeClear();                          // a power-on
+    flight->setState(STATES::PRE_CAL);      // calibrate() is still a stub
+    flight->writeSD(true, *sink);
+
+    // the black box partition, begin() is the pad-side work: rotation and pre-erase
+    static uint8_t flashImage[BLACKBOX_PARTITION_SIZE];
+    static uint32_t blockErases[BLACKBOX_PARTITION_SIZE / BLACKBOX_BLOCK_SIZE];
+    memset(flashImage, 0xFF, sizeof(flashImage));
+    if(blackBoxPath) {
+        FILE* image = fopen(blackBoxPath, "rb");
+        if(image) {
+            size_t loaded = fread(flashImage, 1, sizeof(flashImage), image);
+            fclose(image);
+            printf("black box: loaded %zu bytes of %s\n", loaded, blackBoxPath);
+        }
+    }
+    SIM_FLASH flash(flashImage, BLACKBOX_PARTITION_SIZE, BLACKBOX_BLOCK_SIZE, blockErases);
+    static BLACK_BOX blackBox(25, 3072, blackBoxSync_ms);
+    uint64_t preFlightErases = 0;
+    double beginSeconds = 0;
+    if(blackBoxPath) {
+        auto beginStart = std::chrono::steady_clock::now();
+        if(!blackBox.begin(flash, csvHeader, true)) {
+            fprintf(stderr, "black box: begin failed\n");
+            return 1;
+        }
+        beginSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - beginStart).count();
+        preFlightErases = flash.eraseCount();
+        flash.resetCounters();
+    }
+
+    // the downlink, service() stands in for the radio task
+    FILE* groundFile = nullptr;
+    if(groundPath && !(groundFile = fopen(groundPath, "wb"))) {
+        perror(groundPath);
+        return 1;
+    }
+    static GROUND_STATION ground(groundFile);
+    LoRaSettings modem = {uint8_t(radioSf), radioBandwidth_khz * 1000, 5, 8, true, false};
+    static SIM_RADIO radio(modem, &ground);
+    static RADIO_LINK link(radio);
+    HISTOGRAM radioSend_ns;
+    uint16_t radioSequence = 0;
+    size_t radioFrameSize = 0;
+    static TELEMETRY_BATCH batch;
+    uint32_t batchFrames = 0, batchBytes = 0;
+
+    const uint32_t period_us = 1000000 / rate_hz;
+    const uint32_t baroEvery = everyLoops(rate_hz, baroRate_hz);
+    const uint32_t gpsEvery = everyLoops(rate_hz, gpsRate_hz);
+    const uint32_t radioEvery = radioSf ? everyLoops(rate_hz, radioRate_hz) : 0;
+    for(uint8_t flightState = PRE_NO_CAL; flightState <= POST_LANDED; flightState++) {
+        batch.setRate(STATES(flightState), radioEvery, batchSamples);
+    }
+    const uint64_t maxLoops = uint64_t((seconds > 0 ? seconds : 600) * rate_hz);
+
+    HISTOGRAM loopCost_ns;
+    double velocitySquares = 0, altitudeSquares = 0;
+    float velocityMax = 0, altitudeMax = 0;
+    uint64_t fusedLoops = 0;
+    STATES state = flight->getState();
+    uint64_t landed_us = 0;
+    uint64_t loops = 0;
+    uint64_t lateLoops = 0;
+    SampleRecord record;
+    const uint64_t reset_us = uint64_t(resetAt * 1e6);
+    uint64_t boot_us = 0;                   // simulated time of the last reset, esp_timer counts from here
+    uint32_t savedSequence = 0;
+
+    hostSetTime(0);
+    link.resetStats();
+    auto begin = std::chrono::steady_clock::now();
+    while(loops < maxLoops) {
+        uint64_t time_us = (loops + 1) * period_us;
+        if(reset_us && !boot_us && time_us > reset_us) {
+            // power comes back after the outage; nothing in RAM survived, the RTC store did
+            boot_us = reset_us;
+            time_us = reset_us + resetOutage_ms * 1000ull;
+            loops = time_us / period_us - 1;
+            trajectory.update(time_us);
+            hostSetTime(time_us - boot_us);
+            FlightResume saved = {};
+            resumeLoad(saved);
+            auto resumeStart = std::chrono::steady_clock::now();
+            flight = &resumedFlight;
+            ring = &resumedRing;
+            bool resumed = flight->resume();
+            LogResume position;
+            if(framed && resumeLoadLog(position)) {
+                resumedFramer.reset(new LOG_FRAMER(card, position.frameStream, position.frameSequence + 1));
+                framer = resumedFramer.get();
+                sink = framer;
+            }
+            double resume_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - resumeStart).count();
+            printf("%10.3f s  warm reset after %u ms out: %s %s in %.1f us, flight time %.3f s (set back %.1f ms)\n",
+                   time_us / 1e6, resetOutage_ms, resumed ? "resumed" : "no resume,", STATE_NAMES[flight->getState()],
+                   resume_us, nowMicros() / 1e6, (reset_us - saved.time_us) / 1e3);
+            state = flight->getState();
+            link.resetStats();              // its counters were in RAM too
+        }
+        auto loopStart = std::chrono::steady_clock::now();
+
+        trajectory.update(time_us);
+        hostSetTime(time_us - boot_us);     // sample_time_us follows the simulated flight too
+        flight->incrementTime(nowMicros());
+        flight->read_LSM(lsm);
+        flight->read_ADXL(adxl);
+        flight->read_BNO(bno);
+        if(loops % baroEvery == 0) {
+            flight->read_BMP(bmp);
+        }
+        if(loops % gpsEvery == 0) {
+            flight->read_GPS(gps);
+        }
+        flight->calculateState();
+        flight->pushSample();
+        while(ring->pop(record)) {
+            flight->writeSD(record, *sink);
+            if(blackBoxPath) {
+                blackBox.log(record);
+            }
+        }
+        if(radioEvery && batchSamples) {
+            // the batch decimates, every loop's sample goes in
+            uint8_t frame[RADIO_FRAME_SIZE];
+            auto sendStart = std::chrono::steady_clock::now();
+            if(size_t length = batch.add(record, frame)) {
+                link.send(frame, length);
+                batchFrames++;
+                batchBytes += length;
+                radioSend_ns.record(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - sendStart).count()));
+            }
+            link.service();
+        } else if(radioEvery) {
+            if(loops % radioEvery == 0) {
+                uint8_t frame[TELEMETRY_FRAME_MAX];
+                auto sendStart = std::chrono::steady_clock::now();
+                radioFrameSize = telemetryEncode(record, radioSequence++, frame);
+                link.send(frame, radioFrameSize);
+                radioSend_ns.record(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - sendStart).count()));
+            }
+            link.service();
+        }
+        if(framed && framer->nextSequence() != savedSequence) {
+            // the host's card keeps every block it was handed, the framer's partial block is what a reset loses
+            savedSequence = framer->nextSequence();
+            LogResume position = {};
+            position.durable = log.bytesWritten();
+            position.frameStream = framer->streamId();
+            position.frameSequence = savedSequence;
+            resumeSaveLog(position);
+        }
+
+        auto loopEnd = std::chrono::steady_clock::now();
+        loopCost_ns.record(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(loopEnd - loopStart).count()));
+        loops++;
+        if(realtime) {
+            auto deadline = begin + std::chrono::microseconds(loops * period_us);
+            if(loopEnd > deadline) {
+                lateLoops++;
+            }
+            std::this_thread::sleep_until(deadline);
+        }
+
+        // fused estimate against the simulated truth, once alt_offset has seen a BMP sample
+        if(flight->getFusion().getStats().baroUpdates > 1 && !trajectory.hasLanded()) {
+            TelemetryData fused = flight->getSnapshot();
+            float velocityError = fabsf(fused.ekf_vel - trajectory.velocity());
+            float altitudeError = fabsf(fused.ekf_alt - trajectory.altitude());
+            velocitySquares += velocityError * velocityError;
+            altitudeSquares += altitudeError * altitudeError;
+            velocityMax = velocityError > velocityMax ? velocityError : velocityMax;
+            altitudeMax = altitudeError > altitudeMax ? altitudeError : altitudeMax;
+            fusedLoops++;
+        }
+        if(flight->getState() != state) {
+            printf("%10.3f s  %s -> %s (sim altitude %.1f m)\n", time_us / 1e6, STATE_NAMES[state],
+                   STATE_NAMES[flight->getState()], trajectory.altitude());
+            state = flight->getState();
+        }
+        if(trajectory.hasLanded() && !landed_us) {
+            landed_us = time_us;
+        }
+        if(seconds <= 0 && landed_us && time_us >= landed_us + 5000000) {
+            break;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    if(framed) {
+        framer->sync();
+    }
+    if(useWriter) {
+        writer.sync();
+        while(!writer.drained()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        writerRunning = false;
+        writerThread.join();
+    }
+    if(csv) {
+        fclose(csv);
+    }
+    if(blackBoxPath) {
+        blackBox.end();
+        FILE* image = fopen(blackBoxPath, "wb");
+        if(!image || fwrite(flashImage, 1, sizeof(flashImage), image) != sizeof(flashImage)) {
+            perror(blackBoxPath);
+        }
+        if(image) {
+            fclose(image);
+        }
+    }
+
+    printf("sim apogee %.1f m at %.3f s, landed at %.3f s\n", trajectory.apogeeAltitude(),
+           trajectory.apogeeTime_us() / 1e6, landed_us / 1e6);
+    APOGEE& apogee = flight->getApogee();
+    if(apogee.detected()) {
+        printf("apogee detected at %.3f s, %.0f ms after the true apogee (%swindow %u samples)\n",
+               apogee.detectedTime_us() / 1e6,
+               (int64_t(apogee.detectedTime_us()) - int64_t(trajectory.apogeeTime_us())) / 1e3,
+               useFusion ? "fused velocity, " : "", apogee.window());
+    } else {
+        printf("apogee not detected\n");
+    }
+    if(fusedLoops) {
+        printf("fusion error until landing: velocity rms %.2f max %.2f m/s, altitude rms %.2f max %.2f m\n",
+               sqrt(velocitySquares / fusedLoops), velocityMax, sqrt(altitudeSquares / fusedLoops), altitudeMax);
+    }
+    printf("%llu loops of %.1f simulated s in %.3f s wall: %.0f loops/s\n", (unsigned long long)loops,
+           loops * period_us / 1e6, elapsed, loops / elapsed);
+    printf("loop cost ns: mean %.0f, p50 <= %u, p99 <= %u, max %u\n", loopCost_ns.mean(),
+           loopCost_ns.percentile(50), loopCost_ns.percentile(99), loopCost_ns.max());
+    if(realtime) {
+        printf("loops past their deadline: %llu\n", (unsigned long long)lateLoops);
+    }
+    static const char* FORMAT_NAMES[] = {"csv", "binary", "raw"};
+    printf("log (%s): %zu bytes (%.1f per loop), %u flushes, %u injected stalls\n",
+           FORMAT_NAMES[logFormat], log.bytesWritten(), double(log.bytesWritten()) / loops,
+           log.flushCount(), log.stalls);
+    if(keyframes && logFormat != LOG_FORMAT_CSV) {
+        Serial.setEcho(true);
+        flight->getLogDelta().printStats(Serial);
+        const HISTOGRAM& encode = flight->getProfiler().getStage(STAGE_LOG_DELTA);
+        printf("log delta encode: mean %.0f, p99 <= %u cycles per sample (%.1f ns)\n", encode.mean(),
+               encode.percentile(99), encode.mean() * 1000.0 / cyclesPerMicro());
+    }
+    if(framed) {
+        Serial.setEcho(true);
+        framer->printStats(Serial);
+        FrameStats frames = framer->getStats();
+        printf("log framing: %.1f%% overhead, CRC32 %.0f ns per block\n",
+               frames.payloadBytes ? 100.0 * ((frames.blocks + frames.dropped) * double(LOG_FRAME_SIZE) / frames.payloadBytes - 1) : 0.0,
+               frames.blocks ? frames.crcCycles * 1000.0 / cyclesPerMicro() / frames.blocks : 0.0);
+    }
+    if(useWriter) {
+        Serial.setEcho(true);
+        writer.printStats(Serial);
+    }
+    if(radioEvery) {
+        Serial.setEcho(true);
+        link.printStats(Serial);
+        if(batchSamples) {
+            size_t average = batchFrames ? batchBytes / batchFrames : 0;
+            printf("radio: SF%u/%u kHz batch frames average %zu B, %.1f ms on air; add() + send() per frame mean %.0f ns, max %u ns\n",
+                   radioSf, radioBandwidth_khz, average, radio.airtime_us(average) / 1e3,
+                   radioSend_ns.mean(), radioSend_ns.max());
+        } else {
+            printf("radio: SF%u/%u kHz frame of %zu B is %.1f ms on air, at most %.2f packets/s; encode + send() mean %.0f ns, max %u ns\n",
+                   radioSf, radioBandwidth_khz, radioFrameSize, radio.airtime_us(radioFrameSize) / 1e3,
+                   1e6 / radio.airtime_us(radioFrameSize), radioSend_ns.mean(), radioSend_ns.max());
+        }
+        double flightSeconds = loops * period_us / 1e6;
+        printf("ground: %u samples in %u frames (%.1f per frame, %u bad), %.2f samples/s\n",
+               ground.samples, ground.frames, ground.frames ? double(ground.samples) / ground.frames : 0.0,
+               ground.bad, ground.samples / flightSeconds);
+    }
+    if(blackBoxPath) {
+        // cost per second of flight: host CPU in log(), and what the flash chip was asked to do
+        double flightSeconds = loops * period_us / 1e6;
+        BlackBoxStats stats = blackBox.getStats();
+        double pages = flash.programCount() + flash.bytesProgrammed() / 256.0;
+        double flashBusy_ms = pages * FLASH_PAGE_PROGRAM_MS + flash.eraseCount() * FLASH_BLOCK_ERASE_MS;
+        uint32_t leastErased = UINT32_MAX, mostErased = 0;
+        for(uint32_t erases : blockErases) {
+            leastErased = erases < leastErased ? erases : leastErased;
+            mostErased = erases > mostErased ? erases : mostErased;
+        }
+        Serial.setEcho(true);
+        blackBox.printStats(Serial);
+        printf("black box pad work: %llu erases, %.3f s host\n", (unsigned long long)preFlightErases, beginSeconds);
+        printf("black box per flight second: %.1f us CPU in log(), %.0f B logged, %.0f B programmed in %.1f programs, "
+               "%.2f erases, ~%.1f ms flash busy\n",
+               stats.logCycles / double(cyclesPerMicro()) / flightSeconds, stats.bytesLogged / flightSeconds,
+               flash.bytesProgrammed() / flightSeconds, flash.programCount() / flightSeconds,
+               flash.eraseCount() / flightSeconds, flashBusy_ms / flightSeconds);
+        printf("black box wear: %u to %u erases per block, %u programs over unerased bits\n",
+               leastErased, mostErased, flash.badPrograms());
+    }
+
+    if(!quiet) {
+        Serial.setEcho(true);
+        flight->printProfile(Serial);
+    }
+    return 0;
+}
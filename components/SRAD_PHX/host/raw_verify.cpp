@@ -0,0 +1,198 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Proves LOG_FORMAT_RAW loses nothing. The real Adafruit drivers and the
+// flight adapters (SRAD_PHX_HAL_Adafruit.cpp) run against register files
+// on the host Wire bus (stubs/Wire.h). Every possible count goes into the
+// data registers, and for each one this checks, bit for bit:
+//   - the adapter's float equals what the driver's own getEvent()/getQuat()
+//     computes, i.e. what the adapters returned before they converted counts
+//   - the adapter hands over that exact count
+//   - rawConvert(), which log_decode applies to the count, gives that float
+// Equal floats print equal text, so a raw log decodes to the same CSV.
+//
+//   raw_verify           exit status 1 on any mismatch
+
+#include <stdio.h>
+#include <string.h>
+
+#include <Wire.h>
+#include "SRAD_PHX_HAL_Adafruit.h"
+#include "SRAD_PHX_Raw.h"
+
+static_assert(RAW_DPS_TO_RADS == SENSORS_DPS_TO_RADS, "SRAD_PHX_Raw.h out of step with Adafruit_Sensor.h");
+static_assert(RAW_GRAVITY == SENSORS_GRAVITY_STANDARD, "SRAD_PHX_Raw.h out of step with Adafruit_Sensor.h");
+
+class CHANNEL {
+    public:
+        CHANNEL(const char* n) : name(n) {}
+
+        // `expected` is the driver's float, `actual` the adapter's, `count` what it logged
+        void check(float expected, float actual, int32_t count, int32_t expectedCount, uint8_t conversion) {
+            checkDecoded(expected, actual, count, expectedCount, rawConvert(conversion, count, RAW_SCALES_ADAFRUIT));
+        }
+
+        void checkDecoded(float expected, float actual, int32_t count, int32_t expectedCount, float decoded) {
+            checked++;
+            if(!memcmp(&expected, &actual, sizeof(float)) && !memcmp(&expected, &decoded, sizeof(float))
+               && count == expectedCount) {
+                return;
+            }
+            if(mismatches++ < 5) {
+                printf("  %s count %ld: driver %.9g, adapter %.9g (count %ld), decoded %.9g\n", name,
+                       (long)expectedCount, expected, actual, (long)count, decoded);
+            }
+        }
+
+        uint32_t report() const {
+            printf("%-12s %6u counts, %u mismatches\n", name, checked, mismatches);
+            return mismatches;
+        }
+
+    private:
+        const char* name;
+        uint32_t checked = 0;
+        uint32_t mismatches = 0;
+};
+
+static void putCounts(HOST_I2C_DEVICE& device, uint8_t reg, const int16_t* counts, uint8_t count) {
+    for(uint8_t ind = 0; ind < count; ind++) {
+        device.registers[reg + 2 * ind] = uint8_t(counts[ind]);
+        device.registers[reg + 2 * ind + 1] = uint8_t(uint16_t(counts[ind]) >> 8);
+    }
+}
+
+// each axis gets a different count, so swapped axes show up
+static void axisCounts(int32_t value, int16_t* counts) {
+    counts[0] = int16_t(value);
+    counts[1] = int16_t(~value);
+    counts[2] = int16_t(value ^ 0x1234);
+    counts[3] = int16_t(value ^ 0x4321);
+}
+
+static uint32_t verifyLsm() {
+    HOST_I2C_DEVICE device;
+    device.registers[LSM6DS_WHOAMI] = LSM6DSO32_CHIP_ID;
+    device.selfClearing[LSM6DS_CTRL3_C] = 0x81;        // SW_RESET, BOOT
+    Wire.hostAttach(LSM6DS_I2CADDR_DEFAULT, &device);
+    Adafruit_LSM6DSO32 driver;
+    if(!driver.begin_I2C(LSM6DS_I2CADDR_DEFAULT, &Wire)) {
+        printf("LSM6DSO32 driver did not start\n");
+        return 1;
+    }
+    LSM_IMU adapter(driver);
+
+    CHANNEL temp("lsm_temp");
+    for(int32_t value = -32768; value <= 32767; value++) {
+        int16_t counts[4];
+        axisCounts(value, counts);
+        putCounts(device, LSM6DS_OUT_TEMP_L, counts, 1);
+
+        sensors_event_t accel, gyro, event;
+        driver.getEvent(&accel, &gyro, &event);
+        ImuReading reading;
+        adapter.read(reading);
+        temp.check(event.temperature, reading.temp, reading.raw_temp, counts[0], RAW_LSM_TEMP);
+    }
+    Wire.hostAttach(LSM6DS_I2CADDR_DEFAULT, nullptr);
+    return temp.report();
+}
+
+static uint32_t verifyAdxl() {
+    HOST_I2C_DEVICE device;
+    device.registers[ADXL3XX_REG_DEVID] = 0xE5;
+    Wire.hostAttach(ADXL375_ADDRESS, &device);
+    Adafruit_ADXL375 driver(375, &Wire);
+    if(!driver.begin()) {
+        printf("ADXL375 driver did not start\n");
+        return 1;
+    }
+    ADXL_ACCEL adapter(driver);
+
+    CHANNEL acc("adxl_acc");
+    for(int32_t value = -32768; value <= 32767; value++) {
+        int16_t counts[4];
+        axisCounts(value, counts);
+        putCounts(device, ADXL3XX_REG_DATAX0, counts, 3);
+
+        sensors_event_t event;
+        driver.getEvent(&event);
+        AccelReading reading;
+        adapter.read(reading);
+        acc.check(event.acceleration.x, reading.acc_x, reading.raw_acc[0], counts[0], RAW_ADXL_ACC);
+        acc.check(event.acceleration.y, reading.acc_y, reading.raw_acc[1], counts[1], RAW_ADXL_ACC);
+        acc.check(event.acceleration.z, reading.acc_z, reading.raw_acc[2], counts[2], RAW_ADXL_ACC);
+    }
+    Wire.hostAttach(ADXL375_ADDRESS, nullptr);
+    return acc.report();
+}
+
+static uint32_t verifyBno() {
+    HOST_I2C_DEVICE device;
+    device.registers[Adafruit_BNO055::BNO055_CHIP_ID_ADDR] = BNO055_ID;
+    Wire.hostAttach(BNO055_ADDRESS_A, &device);
+    Adafruit_BNO055 driver(55, BNO055_ADDRESS_A, &Wire);
+    if(!driver.begin()) {
+        printf("BNO055 driver did not start\n");
+        return 1;
+    }
+    BNO_AHRS adapter(driver, BNO055_ADDRESS_A, &Wire);
+
+    CHANNEL ori("bno_ori"), gyro("bno_gyro"), acc("bno_acc"), mag("bno_mag"), temp("bno_temp");
+    for(int32_t value = -32768; value <= 32767; value++) {
+        int16_t counts[4];
+        axisCounts(value, counts);
+        putCounts(device, Adafruit_BNO055::BNO055_ACCEL_DATA_X_LSB_ADDR, counts, 3);
+        putCounts(device, Adafruit_BNO055::BNO055_MAG_DATA_X_LSB_ADDR, counts, 3);
+        putCounts(device, Adafruit_BNO055::BNO055_GYRO_DATA_X_LSB_ADDR, counts, 3);
+        putCounts(device, Adafruit_BNO055::BNO055_QUATERNION_DATA_W_LSB_ADDR, counts, 4);
+        device.registers[Adafruit_BNO055::BNO055_TEMP_ADDR] = uint8_t(value);
+
+        // what BNO_AHRS::read used to do
+        sensors_event_t gyroEvent, magEvent, accEvent;
+        driver.getEvent(&gyroEvent, Adafruit_BNO055::VECTOR_GYROSCOPE);
+        driver.getEvent(&magEvent, Adafruit_BNO055::VECTOR_MAGNETOMETER);
+        driver.getEvent(&accEvent, Adafruit_BNO055::VECTOR_ACCELEROMETER);
+        imu::Quaternion quat = driver.getQuat();
+        float expectedTemp = float(driver.getTemp());
+
+        AhrsReading reading;
+        adapter.read(reading);
+        ori.check(quat.w(), reading.ori_w, reading.raw_ori[0], counts[0], RAW_BNO_QUAT);
+        ori.check(quat.x(), reading.ori_x, reading.raw_ori[1], counts[1], RAW_BNO_QUAT);
+        ori.check(quat.y(), reading.ori_y, reading.raw_ori[2], counts[2], RAW_BNO_QUAT);
+        ori.check(quat.z(), reading.ori_z, reading.raw_ori[3], counts[3], RAW_BNO_QUAT);
+        gyro.check(gyroEvent.gyro.x, reading.gyro_x, reading.raw_gyro[0], counts[0], RAW_BNO_GYRO);
+        gyro.check(gyroEvent.gyro.y, reading.gyro_y, reading.raw_gyro[1], counts[1], RAW_BNO_GYRO);
+        gyro.check(gyroEvent.gyro.z, reading.gyro_z, reading.raw_gyro[2], counts[2], RAW_BNO_GYRO);
+        acc.check(accEvent.acceleration.x, reading.acc_x, reading.raw_acc[0], counts[0], RAW_BNO_ACC);
+        acc.check(accEvent.acceleration.y, reading.acc_y, reading.raw_acc[1], counts[1], RAW_BNO_ACC);
+        acc.check(accEvent.acceleration.z, reading.acc_z, reading.raw_acc[2], counts[2], RAW_BNO_ACC);
+        if(value >= -128 && value <= 127) {
+            temp.check(expectedTemp, reading.temp, reading.raw_temp, value, RAW_BNO_TEMP);
+        }
+
+        // not logged raw, but the adapter converts it too
+        float magnetic[3] = {magEvent.magnetic.x, magEvent.magnetic.y, magEvent.magnetic.z};
+        float adapterMag[3] = {reading.mag_x, reading.mag_y, reading.mag_z};
+        for(uint8_t axis = 0; axis < 3; axis++) {
+            mag.checkDecoded(magnetic[axis], adapterMag[axis], counts[axis], counts[axis],
+                      rawBnoMag(counts[axis], RAW_SCALES_ADAFRUIT.bno_mag));
+        }
+    }
+    Wire.hostAttach(BNO055_ADDRESS_A, nullptr);
+    return ori.report() + gyro.report() + acc.report() + mag.report() + temp.report();
+}
+
+int main() {
+    uint32_t mismatches = verifyLsm() + verifyAdxl() + verifyBno();
+    printf(mismatches ? "FAILED\n" : "all counts convert bit-exact\n");
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Hammers SEQLOCK with one writer thread per sensor group and several
+// readers, the same shape as the read_* tasks vs. state/log/LoRa tasks.
+// Every writer fills its whole group with one counter value, so a reader
+// seeing two different values inside a group caught a torn read.
+//
+//   seqlock_stress [--seconds N] [--writers N] [--readers N] [--unsafe]
+//
+// --unsafe copies without the seqlock to show the check does catch tearing.
+// Exits nonzero if the seqlock ever returned a torn record.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "SRAD_PHX_Seqlock.h"
+
+static const int MAX_GROUPS = 5;            // one per sensor, like sensor_status
+static const int GROUP_WORDS = 8;           // ~160 bytes total, about sizeof(TelemetryData)
+
+struct StressRecord {
+    uint32_t group[MAX_GROUPS][GROUP_WORDS];
+};
+
+static SEQLOCK<StressRecord> shared;
+static StressRecord unsafeShared;
+static std::atomic<bool> running{true};
+
+static bool isTorn(const StressRecord& record, int groups) {
+    for(int group = 0; group < groups; group++) {
+        for(int word = 1; word < GROUP_WORDS; word++) {
+            if(record.group[group][word] != record.group[group][0]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+struct ReaderResult {
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    uint64_t retries = 0;
+};
+
+int main(int argc, char** argv) {
+    double seconds = 2.0;
+    int writers = MAX_GROUPS;
+    int readers = 4;
+    bool unsafe = false;
+
+    for(int arg = 1; arg < argc; arg++) {
+        if(!strcmp(argv[arg], "--seconds") && arg + 1 < argc) {
+            seconds = atof(argv[++arg]);
+        } else if(!strcmp(argv[arg], "--writers") && arg + 1 < argc) {
+            writers = atoi(argv[++arg]);
+        } else if(!strcmp(argv[arg], "--readers") && arg + 1 < argc) {
+            readers = atoi(argv[++arg]);
+        } else if(!strcmp(argv[arg], "--unsafe")) {
+            unsafe = true;
+        } else {
+            fprintf(stderr, "usage: %s [--seconds N] [--writers 1-%d] [--readers N] [--unsafe]\n", argv[0], MAX_GROUPS);
+            return 2;
+        }
+    }
+    if(writers < 1 || writers > MAX_GROUPS || readers < 1) {
+        fprintf(stderr, "writers must be 1-%d and readers at least 1\n", MAX_GROUPS);
+        return 2;
+    }
+
+    std::vector<uint64_t> writeCounts(writers, 0);
+    std::vector<ReaderResult> results(readers);
+    std::vector<std::thread> threads;
+
+    for(int writer = 0; writer < writers; writer++) {
+        threads.emplace_back([&, writer] {
+            uint32_t value = 0;
+            while(running.load(std::memory_order_relaxed)) {
+                value++;
+                if(unsafe) {
+                    volatile uint32_t* words = unsafeShared.group[writer];
+                    for(int word = 0; word < GROUP_WORDS; word++) {
+                        words[word] = value;
+                    }
+                } else {
+                    StressRecord& out = shared.beginWrite();
+                    for(int word = 0; word < GROUP_WORDS; word++) {
+                        out.group[writer][word] = value;
+                    }
+                    shared.endWrite();
+                }
+                writeCounts[writer]++;
+            }
+        });
+    }
+
+    for(int reader = 0; reader < readers; reader++) {
+        threads.emplace_back([&, reader] {
+            ReaderResult& result = results[reader];
+            StressRecord copy;
+            while(running.load(std::memory_order_relaxed)) {
+                if(unsafe) {
+                    const volatile uint32_t* words = &unsafeShared.group[0][0];
+                    uint32_t* dest = &copy.group[0][0];
+                    for(int word = 0; word < MAX_GROUPS * GROUP_WORDS; word++) {
+                        dest[word] = words[word];
+                    }
+                } else {
+                    result.retries += shared.read(copy);
+                }
+                result.torn += isTorn(copy, writers);
+                result.reads++;
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running = false;
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t writes = 0;
+    for(uint64_t count : writeCounts) {
+        writes += count;
+    }
+    ReaderResult total;
+    for(const ReaderResult& result : results) {
+        total.reads += result.reads;
+        total.torn += result.torn;
+        total.retries += result.retries;
+    }
+
+    printf("mode:         %s\n", unsafe ? "unsafe (no seqlock)" : "seqlock");
+    printf("threads:      %d writers, %d readers, %u hardware threads\n",
+           writers, readers, std::thread::hardware_concurrency());
+    printf("record size:  %zu bytes\n", sizeof(StressRecord));
+    printf("writes:       %llu (%.0f/s)\n", (unsigned long long)writes, writes / elapsed);
+    printf("reads:        %llu (%.0f/s)\n", (unsigned long long)total.reads, total.reads / elapsed);
+    printf("retries/read: %.4f\n", total.reads ? double(total.retries) / total.reads : 0.0);
+    printf("torn reads:   %llu (%.3g%%)\n", (unsigned long long)total.torn,
+           total.reads ? 100.0 * total.torn / total.reads : 0.0);
+
+    if(!unsafe && total.torn != 0) {
+        printf("FAIL: seqlock returned torn records\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Host stand-in for the Arduino core, just enough for SRAD_PHX to build on
+// Linux. Print mirrors components/arduino/cores/esp32/Print.cpp so text
+// output is byte-identical to the board.
+#ifndef SRAD_PHX_HOST_ARDUINO_H
+#define SRAD_PHX_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include <string>
+
+#define DEC 10
+#define HEX 16
+
+class String {
+    public:
+        String(const char* text = "") : value(text) {}
+        String(const std::string& text) : value(text) {}
+        const char* c_str() const { return value.c_str(); }
+        size_t length() const { return value.size(); }
+
+    private:
+        std::string value;
+};
+
+class Print {
+    public:
+        virtual ~Print() {}
+
+        virtual size_t write(uint8_t) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size);
+        size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+        size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+        size_t print(const String&);
+        size_t print(const char[]);
+        size_t print(char);
+        size_t print(unsigned char, int = DEC);
+        size_t print(int, int = DEC);
+        size_t print(unsigned int, int = DEC);
+        size_t print(long, int = DEC);
+        size_t print(unsigned long, int = DEC);
+        size_t print(long long, int = DEC);
+        size_t print(unsigned long long, int = DEC);
+        size_t print(double, int = 2);
+
+        size_t println(const String&);
+        size_t println(const char[]);
+        size_t println(char);
+        size_t println(unsigned char, int = DEC);
+        size_t println(int, int = DEC);
+        size_t println(unsigned int, int = DEC);
+        size_t println(long, int = DEC);
+        size_t println(unsigned long, int = DEC);
+        size_t println(long long, int = DEC);
+        size_t println(unsigned long long, int = DEC);
+        size_t println(double, int = 2);
+        size_t println(void);
+
+        virtual void flush() {}
+
+    private:
+        size_t printNumber(unsigned long, uint8_t);
+        size_t printNumber(unsigned long long, uint8_t);
+        size_t printFloat(double, uint8_t);
+};
+
+class Stream : public Print {
+    public:
+        virtual int available() { return 0; }
+        virtual int read() { return -1; }
+        virtual int peek() { return -1; }
+        void setTimeout(unsigned long) {}
+};
+
+// writes to stdout when enabled, otherwise discards (the default, so
+// debug prints in flight code don't dominate host benchmarks)
+class HardwareSerial : public Stream {
+    public:
+        void begin(unsigned long) {}
+        void setEcho(bool enabled) { echo = enabled; }
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+
+    private:
+        bool echo = false;
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+// the rest of the core the Adafruit drivers touch, for host/raw_verify;
+// there are no pins, so pin I/O does nothing
+typedef bool boolean;
+typedef uint8_t byte;
+#define F(text) (text)
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+using std::min;
+using std::max;
+inline bool isDigit(int c) { return isdigit(c); }
+inline bool isAlpha(int c) { return isalpha(c); }
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define RISING 0x01
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? ((value) |= (1UL << (bit))) : ((value) &= ~(1UL << (bit))))
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void delayMicroseconds(uint32_t) {}
+inline void yield() {}
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int, void (*)(void), int) {}
+inline void detachInterrupt(int) {}
+
+#endif
@@ -0,0 +1,2 @@
+// Host stand-in for the Arduino core Print.h, see Arduino.h
+#include "Arduino.h"
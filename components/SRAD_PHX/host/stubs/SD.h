@@ -0,0 +1,27 @@
+// Host stand-in for the Arduino SD library: a File is a stdio stream.
+#ifndef SRAD_PHX_HOST_SD_H
+#define SRAD_PHX_HOST_SD_H
+
+#include "Arduino.h"
+
+class File : public Stream {
+    public:
+        File(FILE* stream = nullptr) : handle(stream) {}
+
+        size_t write(uint8_t c) override { return handle && fputc(c, handle) != EOF; }
+        size_t write(const uint8_t* buffer, size_t size) override {
+            return handle ? fwrite(buffer, 1, size, handle) : 0;
+        }
+        using Print::write;
+
+        int available() override { return 0; }
+        int read() override { return handle ? fgetc(handle) : -1; }
+        void flush() override { if(handle) fflush(handle); }
+        void close() { if(handle) fclose(handle); handle = nullptr; }
+        operator bool() const { return handle != nullptr; }
+
+    private:
+        FILE* handle;
+};
+
+#endif
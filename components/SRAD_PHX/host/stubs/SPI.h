@@ -0,0 +1,32 @@
+// Host stand-in for the Arduino SPI library, enough for Adafruit_BusIO to
+// build. Nothing answers on it: host tools talk to drivers over Wire.h.
+#ifndef SRAD_PHX_HOST_SPI_H
+#define SRAD_PHX_HOST_SPI_H
+
+#include "Arduino.h"
+
+enum BitOrder { LSBFIRST = 0, MSBFIRST = 1 };
+
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+class SPISettings {
+    public:
+        SPISettings(uint32_t = 1000000, uint8_t = MSBFIRST, uint8_t = SPI_MODE0) {}
+};
+
+class SPIClass {
+    public:
+        void begin() {}
+        void end() {}
+        void beginTransaction(SPISettings) {}
+        void endTransaction() {}
+        uint8_t transfer(uint8_t) { return 0xFF; }
+        void transfer(void* buffer, size_t size) { memset(buffer, 0xFF, size); }
+};
+
+inline SPIClass SPI;
+
+#endif
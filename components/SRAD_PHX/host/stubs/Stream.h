@@ -0,0 +1,2 @@
+// Host stand-in for the Arduino core Stream.h, see Arduino.h
+#include "Arduino.h"
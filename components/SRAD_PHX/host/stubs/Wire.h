@@ -0,0 +1,71 @@
+// Host stand-in for the Arduino Wire library. Nothing is wired up until a
+// tool attaches a HOST_I2C_DEVICE: a 256 byte register file behind an
+// auto-incrementing register pointer, which is how the LSM6DSO32, ADXL375
+// and BNO055 all answer. Lets host/raw_verify run the real drivers.
+#ifndef SRAD_PHX_HOST_WIRE_H
+#define SRAD_PHX_HOST_WIRE_H
+
+#include "Arduino.h"
+
+struct HOST_I2C_DEVICE {
+    uint8_t registers[256] = {};
+    uint8_t selfClearing[256] = {};     // bits a write sets that read back 0, e.g. reset bits
+    uint8_t pointer = 0;
+};
+
+class TwoWire : public Stream {
+    public:
+        // `device` answers at `address` from now on, nullptr detaches it
+        void hostAttach(uint8_t address, HOST_I2C_DEVICE* device) { devices[address & 0x7F] = device; }
+
+        bool begin() { return true; }
+        void end() {}
+        void setClock(uint32_t) {}
+
+        void beginTransmission(uint8_t address) {
+            target = devices[address & 0x7F];
+            sent = 0;
+        }
+        size_t write(uint8_t c) override {
+            if(target && sent++ == 0) {
+                target->pointer = c;
+            } else if(target) {
+                target->registers[target->pointer] = c & ~target->selfClearing[target->pointer];
+                target->pointer++;
+            }
+            return 1;
+        }
+        size_t write(const uint8_t* buffer, size_t size) override {
+            for(size_t ind = 0; ind < size; ind++) {
+                write(buffer[ind]);
+            }
+            return size;
+        }
+        using Print::write;
+        uint8_t endTransmission(bool = true) { return target ? 0 : 2; }     // 2: address NACK
+
+        size_t requestFrom(uint8_t address, size_t size, bool = true) {
+            HOST_I2C_DEVICE* device = devices[address & 0x7F];
+            received = readIndex = 0;
+            if(!device) {
+                return 0;
+            }
+            while(received < size && received < sizeof(rxBuffer)) {
+                rxBuffer[received++] = device->registers[device->pointer++];
+            }
+            return received;
+        }
+        int available() override { return int(received - readIndex); }
+        int read() override { return readIndex < received ? rxBuffer[readIndex++] : -1; }
+
+    private:
+        HOST_I2C_DEVICE* devices[128] = {};
+        HOST_I2C_DEVICE* target = nullptr;
+        size_t sent = 0;
+        uint8_t rxBuffer[256];
+        size_t received = 0, readIndex = 0;
+};
+
+inline TwoWire Wire;
+
+#endif
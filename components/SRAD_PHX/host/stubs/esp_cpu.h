@@ -0,0 +1,15 @@
+// Host stand-in for CCOUNT: nanoseconds, paired with 1000 ticks per us.
+// Plain C as well, esp-dsp includes it from its C sources.
+#ifndef SRAD_PHX_HOST_ESP_CPU_H
+#define SRAD_PHX_HOST_ESP_CPU_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint32_t esp_cpu_get_cycle_count(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+}
+
+#endif
@@ -0,0 +1,13 @@
+// Host stand-in for the esp_err_t codes esp-dsp returns.
+#ifndef SRAD_PHX_HOST_ESP_ERR_H
+#define SRAD_PHX_HOST_ESP_ERR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#endif
@@ -0,0 +1,8 @@
+// Host stand-in, matches the IDF the firmware builds with.
+#ifndef SRAD_PHX_HOST_ESP_IDF_VERSION_H
+#define SRAD_PHX_HOST_ESP_IDF_VERSION_H
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(5, 5, 0)
+
+#endif
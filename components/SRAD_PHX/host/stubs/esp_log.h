@@ -0,0 +1,10 @@
+// Host stand-in for IDF logging, esp-dsp only logs errors nobody reads here.
+#ifndef SRAD_PHX_HOST_ESP_LOG_H
+#define SRAD_PHX_HOST_ESP_LOG_H
+
+#define ESP_LOGE(tag, ...) ((void)(tag))
+#define ESP_LOGW(tag, ...) ((void)(tag))
+#define ESP_LOGI(tag, ...) ((void)(tag))
+#define ESP_LOGD(tag, ...) ((void)(tag))
+
+#endif
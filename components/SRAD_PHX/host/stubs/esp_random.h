@@ -0,0 +1,13 @@
+// Host stand-in: different on every run, like the hardware RNG.
+#ifndef SRAD_PHX_HOST_ESP_RANDOM_H
+#define SRAD_PHX_HOST_ESP_RANDOM_H
+
+#include <stdint.h>
+#include <random>
+
+inline uint32_t esp_random() {
+    static std::random_device device;
+    return device();
+}
+
+#endif
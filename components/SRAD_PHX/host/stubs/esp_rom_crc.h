@@ -0,0 +1,38 @@
+// Host stand-in for the ROM CRCs: the same reflected CRC-32 (zlib's) and
+// CRC-16 (CCITT polynomial, X.25's), which invert on the way in and out, so
+// calls chain like the ROM's do.
+#ifndef SRAD_PHX_HOST_ESP_ROM_CRC_H
+#define SRAD_PHX_HOST_ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    static uint32_t table[256];
+    if(!table[1]) {
+        for(uint32_t ind = 0; ind < 256; ind++) {
+            uint32_t value = ind;
+            for(int bit = 0; bit < 8; bit++) {
+                value = value & 1 ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+            }
+            table[ind] = value;
+        }
+    }
+    crc = ~crc;
+    while(len--) {
+        crc = table[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+inline uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while(len--) {
+        crc ^= *buf++;
+        for(int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+#endif
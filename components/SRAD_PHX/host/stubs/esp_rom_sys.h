@@ -0,0 +1,11 @@
+// Host stand-in, see esp_cpu.h: one "cycle" per nanosecond.
+#ifndef SRAD_PHX_HOST_ESP_ROM_SYS_H
+#define SRAD_PHX_HOST_ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+inline uint32_t esp_rom_get_cpu_ticks_per_us() {
+    return 1000;
+}
+
+#endif
@@ -0,0 +1,31 @@
+// Host stand-in for esp_timer: CLOCK_MONOTONIC in microseconds, or a
+// simulated clock once a tool sets one with hostSetTime().
+#ifndef SRAD_PHX_HOST_ESP_TIMER_H
+#define SRAD_PHX_HOST_ESP_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+
+// atomic because host tools read the clock from more than one thread
+inline std::atomic<int64_t>& hostSimulatedTime() {
+    static std::atomic<int64_t> simulated_us{-1};
+    return simulated_us;
+}
+
+// drives nowMicros() from simulated time, -1 goes back to the real clock
+inline void hostSetTime(int64_t time_us) {
+    hostSimulatedTime() = time_us;
+}
+
+inline int64_t esp_timer_get_time() {
+    int64_t simulated_us = hostSimulatedTime().load(std::memory_order_relaxed);
+    if(simulated_us >= 0) {
+        return simulated_us;
+    }
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return int64_t(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+#endif
@@ -0,0 +1,5 @@
+// Host stand-in: no target options, esp-dsp falls back to its ANSI C kernels.
+#ifndef SRAD_PHX_HOST_SDKCONFIG_H
+#define SRAD_PHX_HOST_SDKCONFIG_H
+
+#endif
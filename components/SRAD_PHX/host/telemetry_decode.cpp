@@ -0,0 +1,151 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Ground side of the telemetry codec: turns a capture of received packets,
+// each behind a one byte length (what SIM_RADIO and pipeline_bench --ground
+// write), back into CSV with one row per sample: one for a telemetryEncode()
+// frame, one per sample in a TELEMETRY_BATCH frame. Packets that are not
+// telemetry frames, have the wrong length or fail the CRC are counted and
+// skipped; gaps in the sequence numbers count the frames lost on the way.
+// A capture holds one kind of frame, each kind numbers its own.
+//
+//   telemetry_decode ground.bin [out.csv]   CSV to out.csv, or stdout
+//     --airtime                             frame sizes and packets/s at SF7 to SF12 instead
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_Telemetry.h"
+
+// as many decimals as the field's resolution has
+static int decimals(float resolution) {
+    int places = 0;
+    while(places < 6 && fabsf(resolution - roundf(resolution)) > resolution * 1e-3f) {
+        resolution *= 10;
+        places++;
+    }
+    return places;
+}
+
+static void printHeader(FILE* out) {
+    fputs("sequence", out);
+    for(const PacketField& field : PACKET_FIELDS) {
+        fprintf(out, ",%s", field.name);
+    }
+    fputs(",bno_ori_w,bno_ori_x,bno_ori_y,bno_ori_z,gps_lat,gps_lon,gps_alt\n", out);
+}
+
+static void printRow(FILE* out, const SampleRecord& sample, uint16_t sequence) {
+    fprintf(out, "%u", sequence);
+    for(const PacketField& field : PACKET_FIELDS) {
+        const uint8_t* value = (const uint8_t*)&sample + field.offset;
+        if(field.type == FIELD_U64) {
+            uint64_t number;
+            memcpy(&number, value, sizeof(number));
+            fprintf(out, ",%llu", (unsigned long long)number);
+        } else if(field.type == FIELD_U8) {
+            fprintf(out, ",%u", *value);
+        } else {
+            float number;
+            memcpy(&number, value, sizeof(number));
+            fprintf(out, ",%.*f", decimals(field.resolution), number);
+        }
+    }
+    const TelemetryData& data = sample.data;
+    fprintf(out, ",%.5f,%.5f,%.5f,%.5f", data.bno_ori_w, data.bno_ori_x, data.bno_ori_y, data.bno_ori_z);
+    if(data.gps_fix) {
+        fprintf(out, ",%.7f,%.7f,%.0f\n", data.gps_lat, data.gps_lon, data.gps_alt);
+    } else {
+        fputs(",,,\n", out);
+    }
+}
+
+// what a frame costs on a 125 kHz, 4/5 link with the usual 8 symbol preamble and CRC
+static void printAirtime() {
+    const size_t sizes[] = {TELEMETRY_FRAME_BYTES, TELEMETRY_FRAME_MAX, LOG_SAMPLE_SIZE};
+    printf("frame: %zu B, %zu B with GPS (%u field bits, %u quaternion, %u GPS); 'S' record %u B\n",
+           TELEMETRY_FRAME_BYTES, TELEMETRY_FRAME_MAX, (unsigned)packetFieldBits(), PACKET_QUAT_BITS,
+           PACKET_GPS_BITS, LOG_SAMPLE_SIZE);
+    printf("SF   %-22s%-22s%-22s\n", "telemetry", "telemetry + GPS", "'S' record");
+    for(uint8_t sf = 7; sf <= 12; sf++) {
+        LoRaSettings modem = {sf, 125000, 5, 8, true, false};
+        printf("%-5u", sf);
+        for(size_t size : sizes) {
+            uint32_t airtime = loraAirtime_us(modem, size);
+            char cell[32];
+            snprintf(cell, sizeof(cell), "%.1f ms %.2f/s", airtime / 1e3, 1e6 / airtime);
+            printf("%-22s", cell);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc >= 2 && !strcmp(argv[1], "--airtime")) {
+        printAirtime();
+        return 0;
+    }
+    if(argc < 2) {
+        fprintf(stderr, "usage: telemetry_decode ground.bin [out.csv] | --airtime\n");
+        return 2;
+    }
+    FILE* in = fopen(argv[1], "rb");
+    if(!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    FILE* out = argc >= 3 ? fopen(argv[2], "w") : stdout;
+    if(!out) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    printHeader(out);
+    static SampleRecord samples[255];
+    uint32_t frames = 0, rows = 0, bad = 0, lost = 0;
+    uint16_t expected = 0;
+    int length;
+    while((length = fgetc(in)) != EOF) {
+        uint8_t packet[255];
+        if(length == 0) {
+            continue;
+        }
+        if(fread(packet, 1, length, in) != size_t(length)) {
+            fprintf(stderr, "capture ends inside a %d byte packet\n", length);
+            break;
+        }
+        uint16_t sequence;
+        size_t count = telemetryDecodeBatch(packet, length, samples, 255, sequence);
+        if(!count && telemetryDecode(packet, length, samples[0], sequence)) {
+            count = 1;
+        }
+        if(!count) {
+            bad++;
+            continue;
+        }
+        if(frames) {
+            lost += uint16_t(sequence - expected);
+        }
+        expected = sequence + 1;
+        frames++;
+        rows += count;
+        for(size_t sample = 0; sample < count; sample++) {
+            printRow(out, samples[sample], sequence);
+        }
+    }
+    fclose(in);
+    if(out != stdout) {
+        fclose(out);
+    }
+    fprintf(stderr, "%u samples in %u frames, %u bad, %u lost to sequence gaps\n", rows, frames, bad, lost);
+    return bad ? 1 : 0;
+}
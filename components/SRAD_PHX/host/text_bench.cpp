@@ -0,0 +1,273 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// The text writers' TEXT_ROW path against the Print path they replaced.
+//
+// First every precision from 0 to 6 decimals formats random floats, both
+// arbitrary bit patterns (nan, inf, ovf, denormals included) and values
+// in the sensors' ranges, through textFloat() and through Print::print,
+// which on the host is the Arduino core's printFloat. Then writeSD CSV
+// rows of made-up samples go through FLIGHT::writeSD and through the old
+// row of Print calls, into the same in-memory Print; every row is compared
+// and both are timed. Last, every format of the field table is timed on
+// its own: the three text serializers into a TEXT_ROW that is never sent,
+// and the 'S' and 'R' packers.
+//
+//   text_bench [options]       exit status 1 on any byte that differs
+//     --count N                random floats per precision (default 2000000)
+//     --rows N                 rows per timed pass (default 20000)
+//     --repeat N               timed passes, the fastest counts (default 10)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "SRAD_PHX.h"
+#include "SRAD_PHX_Fields.h"
+#include "SRAD_PHX_HAL_Sim.h"
+#include "SRAD_PHX_Text.h"
+
+// collects what it's given, like a File with nothing behind it
+class STRING_PRINT : public Print {
+    public:
+        size_t write(uint8_t c) override { text.push_back(char(c)); return 1; }
+        size_t write(const uint8_t* buffer, size_t size) override {
+            text.append((const char*)buffer, size);
+            return size;
+        }
+        using Print::write;
+
+        std::string text;
+};
+
+static uint64_t state = 0x9E3779B97F4A7C15ull;
+static uint32_t nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return uint32_t(state >> 32);
+}
+
+static float uniform(float low, float high) {
+    return low + (high - low) * (nextRandom() / 4294967296.0f);
+}
+
+// writeCSV as it was, one Print call per field and separator
+static void printRow(const SampleRecord& sample, bool gpsColumns, Print& outputFile) {
+    outputFile.print(sample.time_us); outputFile.print(", ");
+    if(gpsColumns) {
+        if(sample.data.gps_fix) {
+            outputFile.print(sample.data.gps_lat, 6); outputFile.print(", ");
+            outputFile.print(sample.data.gps_lon, 6); outputFile.print(",");
+            outputFile.print((int32_t)sample.data.gps_sats); outputFile.print(",");
+            outputFile.print(sample.data.gps_speed, 3); outputFile.print(",");
+            outputFile.print(sample.data.gps_angle, 3); outputFile.print(",");
+            outputFile.print(sample.data.gps_alt, 3); outputFile.print(",");
+        } else {
+            outputFile.print("-1,No fix,-1,No fix,0,-1,-1,-1,");
+        }
+    }
+    outputFile.print(sample.data.bno_ori_w, 5); outputFile.print(",");
+    outputFile.print(sample.data.bno_ori_x, 5); outputFile.print(",");
+    outputFile.print(sample.data.bno_ori_y, 5); outputFile.print(",");
+    outputFile.print(sample.data.bno_ori_z, 5); outputFile.print(",");
+    outputFile.print(sample.data.bno_gyro_x, 5); outputFile.print(",");
+    outputFile.print(sample.data.bno_gyro_y, 5); outputFile.print(",");
+    outputFile.print(sample.data.bno_gyro_z, 5); outputFile.print(",");
+    outputFile.print(sample.data.bno_acc_x, 4); outputFile.print(",");
+    outputFile.print(sample.data.bno_acc_y, 4); outputFile.print(",");
+    outputFile.print(sample.data.bno_acc_z, 4); outputFile.print(",");
+    outputFile.print(sample.data.adxl_acc_x, 2); outputFile.print(",");
+    outputFile.print(sample.data.adxl_acc_y, 2); outputFile.print(",");
+    outputFile.print(sample.data.adxl_acc_z, 2); outputFile.print(",");
+    outputFile.print(sample.data.bmp_press, 6); outputFile.print(",");
+    outputFile.print(sample.data.bmp_alt, 4); outputFile.print(",");
+    outputFile.print(sample.data.lsm_temp, 2); outputFile.print(",");
+    outputFile.print(sample.data.adxl_temp, 2); outputFile.print(",");
+    outputFile.print(sample.data.bno_temp, 2); outputFile.print(",");
+    outputFile.print(sample.data.bmp_temp, 2); outputFile.print(",");
+    outputFile.print(sample.data.sensor_status[0]); outputFile.print(",");
+    outputFile.print(sample.data.sensor_status[1]); outputFile.print(",");
+    outputFile.print(sample.data.sensor_status[2]); outputFile.print(",");
+    outputFile.print(sample.data.sensor_status[3]); outputFile.print(",");
+    outputFile.print(sample.data.sensor_status[4]); outputFile.println();
+}
+
+static SampleRecord makeSample(uint32_t index) {
+    SampleRecord sample = {};
+    TelemetryData& data = sample.data;
+    sample.time_us = 1000ull * index + nextRandom() % 50;
+    data.gps_fix = index % 4 != 0;
+    data.gps_lat = uniform(29.0f, 30.0f); data.gps_lon = uniform(-96.0f, -95.0f);
+    data.gps_sats = nextRandom() % 16;
+    data.gps_speed = uniform(0, 300); data.gps_angle = uniform(0, 360); data.gps_alt = uniform(-10, 3500);
+    data.bno_ori_w = uniform(-1, 1); data.bno_ori_x = uniform(-1, 1);
+    data.bno_ori_y = uniform(-1, 1); data.bno_ori_z = uniform(-1, 1);
+    data.bno_gyro_x = uniform(-10, 10); data.bno_gyro_y = uniform(-10, 10); data.bno_gyro_z = uniform(-10, 10);
+    data.bno_acc_x = uniform(-40, 40); data.bno_acc_y = uniform(-40, 40); data.bno_acc_z = uniform(-40, 160);
+    data.adxl_acc_x = uniform(-200, 200); data.adxl_acc_y = uniform(-200, 200); data.adxl_acc_z = uniform(-200, 200);
+    data.bmp_press = uniform(60000, 101325); data.bmp_alt = uniform(-20, 3500);
+    data.lsm_temp = uniform(15, 45); data.adxl_temp = uniform(15, 45);
+    data.bno_temp = uniform(15, 45); data.bmp_temp = uniform(15, 45);
+    for(uint8_t sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        data.sensor_status[sensor] = nextRandom() % 8 != 0;
+    }
+    return sample;
+}
+
+static uint32_t checkFloats(uint32_t count) {
+    static const float RANGES[][2] = {{-1, 1}, {-200, 200}, {-101325, 101325}, {-1e-4f, 1e-4f}};
+    uint32_t mismatches = 0;
+    STRING_PRINT expected;
+    char text[32];
+    for(uint8_t decimals = 0; decimals <= TEXT_MAX_DECIMALS; decimals++) {
+        uint32_t differ = 0;
+        for(uint32_t ind = 0; ind < count; ind++) {
+            float value;
+            if(ind % 2) {
+                uint32_t bits = nextRandom();
+                memcpy(&value, &bits, sizeof(value));
+            } else {
+                const float* range = RANGES[(ind / 2) % 4];
+                value = uniform(range[0], range[1]);
+            }
+            expected.text.clear();
+            expected.print(value, decimals);
+            size_t length = textFloat(value, decimals, text);
+            if(expected.text.size() != length || memcmp(expected.text.data(), text, length)) {
+                if(differ++ < 3) {
+                    printf("  %.9g at %u decimals: print \"%s\", textFloat \"%.*s\"\n", value, decimals,
+                           expected.text.c_str(), int(length), text);
+                }
+            }
+        }
+        printf("%u decimals: %u floats, %u differ\n", decimals, count, differ);
+        mismatches += differ;
+    }
+    return mismatches;
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = 2000000, rows = 20000, repeat = 10;
+    for(int arg = 1; arg + 1 < argc; arg += 2) {
+        if(!strcmp(argv[arg], "--count")) {
+            count = strtoul(argv[arg + 1], nullptr, 10);
+        } else if(!strcmp(argv[arg], "--rows")) {
+            rows = strtoul(argv[arg + 1], nullptr, 10);
+        } else if(!strcmp(argv[arg], "--repeat")) {
+            repeat = strtoul(argv[arg + 1], nullptr, 10);
+        } else {
+            fprintf(stderr, "unknown option %s, see the top of text_bench.cpp\n", argv[arg]);
+            return 2;
+        }
+    }
+
+    uint32_t mismatches = checkFloats(count);
+
+    SIM_TRAJECTORY trajectory;
+    SIM_GPS gps(trajectory);
+    TelemetryData initial = {};
+    static FLIGHT flight(20, 100, 5000, 10, String("time_us"), gps, initial);
+    flight.setLogFormat(LOG_FORMAT_CSV);
+
+    std::vector<SampleRecord> samples;
+    uint64_t fields = 0;
+    for(uint32_t ind = 0; ind < rows; ind++) {
+        samples.push_back(makeSample(ind));
+        fields += samples.back().data.gps_fix ? 31 : 25;     // numbers printed, GPS columns included
+    }
+
+    // every row, both ways
+    STRING_PRINT printPath, rowPath;
+    uint32_t rowsDiffer = 0;
+    for(const SampleRecord& sample : samples) {
+        printPath.text.clear();
+        rowPath.text.clear();
+        printRow(sample, true, printPath);
+        flight.writeSD(sample, rowPath);
+        if(printPath.text != rowPath.text && rowsDiffer++ < 3) {
+            printf("  row differs:\n    %s    %s", printPath.text.c_str(), rowPath.text.c_str());
+        }
+    }
+    printf("%u rows, %u differ\n", rows, rowsDiffer);
+    mismatches += rowsDiffer;
+
+    // fastest of `repeat` passes, into a sink that keeps only the last row
+    double best[2] = {1e30, 1e30};
+    for(uint32_t pass = 0; pass < repeat; pass++) {
+        for(int path = 0; path < 2; path++) {
+            STRING_PRINT& sink = path ? rowPath : printPath;
+            auto start = std::chrono::steady_clock::now();
+            for(const SampleRecord& sample : samples) {
+                sink.text.clear();
+                if(path) {
+                    flight.writeSD(sample, sink);
+                } else {
+                    printRow(sample, true, sink);
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best[path] = seconds < best[path] ? seconds : best[path];
+        }
+    }
+    static const char* NAMES[] = {"Print calls", "TEXT_ROW"};
+    for(int path = 0; path < 2; path++) {
+        printf("%-12s %9.0f rows/s, %6.1f ns/field\n", NAMES[path], rows / best[path], best[path] * 1e9 / fields);
+    }
+    printf("speedup %.2fx\n", best[0] / best[1]);
+
+    // serialization alone, per format; a debug record outgrows the row, its tail goes to the sink
+    static const char* FORMATS[] = {"CSV", "serial", "debug", "binary 'S'", "raw 'R'"};
+    const uint8_t formatCount = sizeof(FORMATS) / sizeof(FORMATS[0]);
+    double formatBest[formatCount];
+    size_t formatBytes[formatCount] = {};
+    for(uint8_t format = 0; format < formatCount; format++) {
+        formatBest[format] = 1e30;
+        for(uint32_t pass = 0; pass < repeat; pass++) {
+            STRING_PRINT sink;
+            uint8_t packed[LOG_SAMPLE_SIZE];
+            size_t bytes = 0;
+            auto start = std::chrono::steady_clock::now();
+            for(const SampleRecord& sample : samples) {
+                TEXT_ROW row(sink);
+                if(format == 0) {
+                    fieldsText<FIELD_SD>(sample, true, row);
+                } else if(format == 1) {
+                    fieldsText<FIELD_SERIAL>(sample, true, row);
+                } else if(format == 2) {
+                    fieldsText<FIELD_DEBUG>(sample, true, row);
+                } else if(format == 3) {
+                    logPackSample(sample, true, packed);
+                    bytes += LOG_SAMPLE_SIZE;
+                } else {
+                    logPackRaw(sample, true, packed);
+                    bytes += LOG_RAW_SIZE;
+                }
+                sink.text.clear();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            formatBest[format] = seconds < formatBest[format] ? seconds : formatBest[format];
+            formatBytes[format] = bytes;
+        }
+    }
+    for(uint8_t format = 0; format < formatCount; format++) {
+        printf("format %-10s %7.1f ns/record", FORMATS[format], formatBest[format] * 1e9 / rows);
+        if(formatBytes[format]) {
+            printf(", %zu bytes/record", formatBytes[format] / rows);
+        }
+        printf("\n");
+    }
+    printf(mismatches ? "FAILED\n" : "byte-identical\n");
+    return mismatches ? 1 : 0;
+}